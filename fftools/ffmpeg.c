@@ -166,6 +166,7 @@ static int restore_tty;
 
 #if HAVE_THREADS
 static void free_input_threads(void);
+static void free_encoder_threads(void);
 #endif
 
 /* sub2video hack:
@@ -489,6 +490,10 @@ static void ffmpeg_cleanup(int ret)
         av_log(NULL, AV_LOG_INFO, "bench: maxrss=%ikB\n", maxrss);
     }
 
+#if HAVE_THREADS
+    free_encoder_threads();
+#endif
+
     for (i = 0; i < nb_filtergraphs; i++) {
         FilterGraph *fg = filtergraphs[i];
         avfilter_graph_free(&fg->graph);
@@ -600,6 +605,7 @@ static void ffmpeg_cleanup(int ret)
         av_freep(&ist->filters);
         av_freep(&ist->hwaccel_device);
         av_freep(&ist->dts_buffer);
+        free_frame_converters(ist);
 
         avcodec_free_context(&ist->dec_ctx);
 
@@ -613,6 +619,7 @@ static void ffmpeg_cleanup(int ret)
                    av_err2str(AVERROR(errno)));
     }
     av_freep(&vstats_filename);
+    av_freep(&filter_thread_type);
 
     av_freep(&input_streams);
     av_freep(&input_files);
@@ -907,6 +914,290 @@ static int check_recording_time(OutputStream *ost)
     return 1;
 }
 
+#if HAVE_THREADS
+/*
+ * Encoder pipeline (-encode_pipeline): every audio/video encoder runs in its
+ * own thread. Frames are handed to it through enc_frame_queue and the
+ * encoded packets come back through enc_pkt_queue, followed by an end marker
+ * for each submitted frame. The main thread records the order in which
+ * frames were submitted in mux_order and muxes the returned packets in that
+ * same order as the serial encode loop would have written them.
+ *
+ * Decoders have no such stage yet: process_input_packet() derives the dts of
+ * the next packet from the number of frames the decoder returned and from
+ * decoder context fields, so decoding cannot run ahead of the main thread
+ * without changing the output timestamps.
+ */
+typedef struct EncoderPacketMsg {
+    AVPacket pkt;
+    int end;    /* last message for a submitted frame, pkt is blank */
+    int eof;    /* the packet comes from flushing the encoder */
+    BenchmarkTimeStamps bench;  /* time spent encoding the frame, set with end */
+} EncoderPacketMsg;
+
+static AVFifoBuffer *mux_order;
+
+static void free_frame_msg(void *msg)
+{
+    av_frame_free(msg);
+}
+
+static void free_packet_msg(void *msg)
+{
+    EncoderPacketMsg *m = msg;
+    av_packet_unref(&m->pkt);
+}
+
+static void *encoder_thread(void *arg)
+{
+    OutputStream *ost = arg;
+    AVCodecContext *enc = ost->enc_ctx;
+    int ret;
+
+    while (1) {
+        EncoderPacketMsg msg = { { 0 } };
+        BenchmarkTimeStamps t0 = { 0 };
+        AVFrame *frame;
+        int64_t frame_pts;
+        int eof;
+
+        ret = av_thread_message_queue_recv(ost->enc_frame_queue, &frame, 0);
+        if (ret < 0)
+            break;
+
+        if (do_benchmark_all)
+            t0 = get_benchmark_time_stamps();
+
+        eof       = !frame;
+        frame_pts = frame ? frame->pts : AV_NOPTS_VALUE;
+
+        ret = avcodec_send_frame(enc, frame);
+        av_frame_free(&frame);
+        if (ret < 0)
+            goto fail;
+
+        while (1) {
+            av_init_packet(&msg.pkt);
+            msg.pkt.data = NULL;
+            msg.pkt.size = 0;
+
+            ret = avcodec_receive_packet(enc, &msg.pkt);
+            if (ret == AVERROR_EOF && ost->logfile && enc->stats_out)
+                fprintf(ost->logfile, "%s", enc->stats_out);
+            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+                break;
+            if (ret < 0)
+                goto fail;
+
+            if (debug_ts) {
+                av_log(NULL, AV_LOG_INFO, "encoder -> type:%s "
+                       "pkt_pts:%s pkt_pts_time:%s pkt_dts:%s pkt_dts_time:%s\n",
+                       av_get_media_type_string(enc->codec_type),
+                       av_ts2str(msg.pkt.pts), av_ts2timestr(msg.pkt.pts, &enc->time_base),
+                       av_ts2str(msg.pkt.dts), av_ts2timestr(msg.pkt.dts, &enc->time_base));
+            }
+
+            if (enc->codec_type == AVMEDIA_TYPE_VIDEO && !eof &&
+                msg.pkt.pts == AV_NOPTS_VALUE && !(enc->codec->capabilities & AV_CODEC_CAP_DELAY))
+                msg.pkt.pts = frame_pts;
+
+            av_packet_rescale_ts(&msg.pkt, enc->time_base, ost->mux_timebase);
+
+            /* if two pass, output log */
+            if (ost->logfile && enc->stats_out)
+                fprintf(ost->logfile, "%s", enc->stats_out);
+
+            msg.eof = eof;
+            ret = av_thread_message_queue_send(ost->enc_pkt_queue, &msg, 0);
+            if (ret < 0) {
+                av_packet_unref(&msg.pkt);
+                goto fail;
+            }
+        }
+
+        msg.end = 1;
+        msg.eof = eof;
+        if (do_benchmark_all) {
+            BenchmarkTimeStamps t = get_benchmark_time_stamps();
+            msg.bench.real_usec = t.real_usec - t0.real_usec;
+            msg.bench.user_usec = t.user_usec - t0.user_usec;
+            msg.bench.sys_usec  = t.sys_usec  - t0.sys_usec;
+        }
+        ret = av_thread_message_queue_send(ost->enc_pkt_queue, &msg, 0);
+        if (ret < 0)
+            goto fail;
+    }
+
+fail:
+    av_thread_message_queue_set_err_recv(ost->enc_pkt_queue, ret);
+    return NULL;
+}
+
+static int init_encoder_thread(OutputStream *ost)
+{
+    int ret;
+
+    if (!mux_order && !(mux_order = av_fifo_alloc(16 * sizeof(OutputStream*))))
+        return AVERROR(ENOMEM);
+
+    ret = av_thread_message_queue_alloc(&ost->enc_frame_queue,
+                                        FFMAX(encode_queue_size, 1), sizeof(AVFrame*));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(ost->enc_frame_queue, free_frame_msg);
+
+    ret = av_thread_message_queue_alloc(&ost->enc_pkt_queue,
+                                        FFMAX(encode_queue_size, 1), sizeof(EncoderPacketMsg));
+    if (ret < 0)
+        goto fail;
+    av_thread_message_queue_set_free_func(ost->enc_pkt_queue, free_packet_msg);
+
+    if ((ret = pthread_create(&ost->enc_thread, NULL, encoder_thread, ost))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        ret = AVERROR(ret);
+        goto fail;
+    }
+
+    return 0;
+fail:
+    av_thread_message_queue_free(&ost->enc_frame_queue);
+    av_thread_message_queue_free(&ost->enc_pkt_queue);
+    return ret;
+}
+
+static void free_encoder_threads(void)
+{
+    int i;
+
+    for (i = 0; i < nb_output_streams; i++) {
+        OutputStream *ost = output_streams[i];
+
+        if (!ost || !ost->enc_frame_queue)
+            continue;
+
+        av_thread_message_queue_set_err_recv(ost->enc_frame_queue, AVERROR_EOF);
+        av_thread_message_flush(ost->enc_frame_queue);
+        av_thread_message_queue_set_err_send(ost->enc_pkt_queue, AVERROR_EOF);
+        av_thread_message_flush(ost->enc_pkt_queue);
+
+        pthread_join(ost->enc_thread, NULL);
+        av_thread_message_queue_free(&ost->enc_frame_queue);
+        av_thread_message_queue_free(&ost->enc_pkt_queue);
+    }
+    av_fifo_freep(&mux_order);
+}
+
+/**
+ * Mux one message returned by the encoder thread of the oldest frame
+ * submitted to the pipeline.
+ *
+ * @return 1 if a message was processed, 0 if nothing is pending or, when
+ *         not blocking, the encoder has not produced the next message yet
+ */
+static int mux_encoder_packet(int block)
+{
+    OutputStream *ost;
+    OutputFile *of;
+    EncoderPacketMsg msg;
+    int ret;
+
+    if (!mux_order || !av_fifo_size(mux_order))
+        return 0;
+
+    av_fifo_generic_peek(mux_order, &ost, sizeof(ost), NULL);
+    of = output_files[ost->file_index];
+
+    ret = av_thread_message_queue_recv(ost->enc_pkt_queue, &msg,
+                                       block ? 0 : AV_THREAD_MESSAGE_NONBLOCK);
+    if (ret == AVERROR(EAGAIN))
+        return 0;
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_FATAL, "%s encoding failed: %s\n",
+               av_get_media_type_string(ost->enc_ctx->codec_type),
+               av_err2str(ret));
+        exit_program(1);
+    }
+
+    if (msg.end) {
+        av_fifo_drain(mux_order, sizeof(ost));
+        if (do_benchmark_all)
+            av_log(NULL, AV_LOG_INFO,
+                   "bench: %8" PRIu64 " user %8" PRIu64 " sys %8" PRIu64 " real %s_%s %d.%d \n",
+                   msg.bench.user_usec, msg.bench.sys_usec, msg.bench.real_usec,
+                   msg.eof ? "flush" : "encode",
+                   av_get_media_type_string(ost->enc_ctx->codec_type),
+                   ost->file_index, ost->index);
+        if (msg.eof)
+            output_packet(of, &msg.pkt, ost, 1);
+        else if (ost->enc_ctx->codec_type == AVMEDIA_TYPE_VIDEO &&
+                 vstats_filename && ost->enc_last_pkt_size)
+            do_video_stats(ost, ost->enc_last_pkt_size);
+        ost->enc_last_pkt_size = 0;
+        return 1;
+    }
+
+    if (msg.eof && (ost->finished & MUXER_FINISHED)) {
+        av_packet_unref(&msg.pkt);
+        return 1;
+    }
+
+    ost->enc_last_pkt_size = msg.pkt.size;
+    output_packet(of, &msg.pkt, ost, 0);
+    if (msg.eof && ost->enc_ctx->codec_type == AVMEDIA_TYPE_VIDEO && vstats_filename)
+        do_video_stats(ost, ost->enc_last_pkt_size);
+
+    return 1;
+}
+
+/*
+ * Hand a frame (or NULL to flush) to the encoder thread of ost. While the
+ * queue is full, the pending encoder output is muxed to make room.
+ */
+static void encoder_thread_send(OutputStream *ost, AVFrame *frame)
+{
+    AVFrame *msg = NULL;
+    int ret;
+
+    if (frame && !(msg = av_frame_clone(frame))) {
+        av_log(NULL, AV_LOG_FATAL, "Could not allocate frame for the encoder thread\n");
+        exit_program(1);
+    }
+
+    while ((ret = av_thread_message_queue_send(ost->enc_frame_queue, &msg,
+                                               AV_THREAD_MESSAGE_NONBLOCK)) == AVERROR(EAGAIN)) {
+        if (!mux_encoder_packet(1)) {
+            ret = av_thread_message_queue_send(ost->enc_frame_queue, &msg, 0);
+            break;
+        }
+    }
+    if (ret < 0) {
+        av_frame_free(&msg);
+        av_log(NULL, AV_LOG_FATAL, "Unable to send frame to the encoder thread: %s\n",
+               av_err2str(ret));
+        exit_program(1);
+    }
+
+    if (av_fifo_space(mux_order) < sizeof(ost) &&
+        av_fifo_grow(mux_order, av_fifo_size(mux_order)) < 0) {
+        av_log(NULL, AV_LOG_FATAL, "Could not grow the muxing order queue\n");
+        exit_program(1);
+    }
+    av_fifo_generic_write(mux_order, &ost, sizeof(ost), NULL);
+}
+#endif
+
+/*
+ * Mux everything the encoder threads still have in flight. Must be called
+ * before any packet bypassing the encoders is written, to keep the order.
+ */
+static void flush_encoder_pipeline(void)
+{
+#if HAVE_THREADS
+    while (mux_encoder_packet(1))
+        ;
+#endif
+}
+
 static void do_audio_out(OutputFile *of, OutputStream *ost,
                          AVFrame *frame)
 {
@@ -936,6 +1227,13 @@ static void do_audio_out(OutputFile *of, OutputStream *ost,
                enc->time_base.num, enc->time_base.den);
     }
 
+#if HAVE_THREADS
+    if (ost->enc_frame_queue) {
+        encoder_thread_send(ost, frame);
+        return;
+    }
+#endif
+
     ret = avcodec_send_frame(enc, frame);
     if (ret < 0)
         goto error;
@@ -994,6 +1292,8 @@ static void do_subtitle_out(OutputFile *of,
         }
     }
 
+    flush_encoder_pipeline();
+
     /* Note: DVB subtitle need one packet to draw them and one other
        packet to clear them */
     /* XXX: signal it in the codec context ? */
@@ -1050,13 +1350,69 @@ static void do_subtitle_out(OutputFile *of,
     }
 }
 
+static void encode_video_frame(OutputFile *of, OutputStream *ost,
+                               AVFrame *in_picture, int *frame_size)
+{
+    AVCodecContext *enc = ost->enc_ctx;
+    AVPacket pkt;
+    int ret;
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    ret = avcodec_send_frame(enc, in_picture);
+    if (ret < 0)
+        goto error;
+
+    while (1) {
+        ret = avcodec_receive_packet(enc, &pkt);
+        update_benchmark("encode_video %d.%d", ost->file_index, ost->index);
+        if (ret == AVERROR(EAGAIN))
+            break;
+        if (ret < 0)
+            goto error;
+
+        if (debug_ts) {
+            av_log(NULL, AV_LOG_INFO, "encoder -> type:video "
+                   "pkt_pts:%s pkt_pts_time:%s pkt_dts:%s pkt_dts_time:%s\n",
+                   av_ts2str(pkt.pts), av_ts2timestr(pkt.pts, &enc->time_base),
+                   av_ts2str(pkt.dts), av_ts2timestr(pkt.dts, &enc->time_base));
+        }
+
+        if (pkt.pts == AV_NOPTS_VALUE && !(enc->codec->capabilities & AV_CODEC_CAP_DELAY))
+            pkt.pts = ost->sync_opts;
+
+        av_packet_rescale_ts(&pkt, enc->time_base, ost->mux_timebase);
+
+        if (debug_ts) {
+            av_log(NULL, AV_LOG_INFO, "encoder -> type:video "
+                "pkt_pts:%s pkt_pts_time:%s pkt_dts:%s pkt_dts_time:%s\n",
+                av_ts2str(pkt.pts), av_ts2timestr(pkt.pts, &ost->mux_timebase),
+                av_ts2str(pkt.dts), av_ts2timestr(pkt.dts, &ost->mux_timebase));
+        }
+
+        *frame_size = pkt.size;
+        output_packet(of, &pkt, ost, 0);
+
+        /* if two pass, output log */
+        if (ost->logfile && enc->stats_out) {
+            fprintf(ost->logfile, "%s", enc->stats_out);
+        }
+    }
+
+    return;
+error:
+    av_log(NULL, AV_LOG_FATAL, "Video encoding failed\n");
+    exit_program(1);
+}
+
 static void do_video_out(OutputFile *of,
                          OutputStream *ost,
                          AVFrame *next_picture,
                          double sync_ipts)
 {
-    int ret, format_video_sync;
-    AVPacket pkt;
+    int format_video_sync;
     AVCodecContext *enc = ost->enc_ctx;
     AVCodecParameters *mux_par = ost->st->codecpar;
     AVRational frame_rate;
@@ -1198,9 +1554,6 @@ static void do_video_out(OutputFile *of,
         AVFrame *in_picture;
         int forced_keyframe = 0;
         double pts_time;
-        av_init_packet(&pkt);
-        pkt.data = NULL;
-        pkt.size = 0;
 
         if (i < nb0_frames && ost->last_frame) {
             in_picture = ost->last_frame;
@@ -1283,47 +1636,15 @@ static void do_video_out(OutputFile *of,
 
         ost->frames_encoded++;
 
-        ret = avcodec_send_frame(enc, in_picture);
-        if (ret < 0)
-            goto error;
+#if HAVE_THREADS
+        if (ost->enc_frame_queue)
+            encoder_thread_send(ost, in_picture);
+        else
+#endif
+            encode_video_frame(of, ost, in_picture, &frame_size);
         // Make sure Closed Captions will not be duplicated
         av_frame_remove_side_data(in_picture, AV_FRAME_DATA_A53_CC);
 
-        while (1) {
-            ret = avcodec_receive_packet(enc, &pkt);
-            update_benchmark("encode_video %d.%d", ost->file_index, ost->index);
-            if (ret == AVERROR(EAGAIN))
-                break;
-            if (ret < 0)
-                goto error;
-
-            if (debug_ts) {
-                av_log(NULL, AV_LOG_INFO, "encoder -> type:video "
-                       "pkt_pts:%s pkt_pts_time:%s pkt_dts:%s pkt_dts_time:%s\n",
-                       av_ts2str(pkt.pts), av_ts2timestr(pkt.pts, &enc->time_base),
-                       av_ts2str(pkt.dts), av_ts2timestr(pkt.dts, &enc->time_base));
-            }
-
-            if (pkt.pts == AV_NOPTS_VALUE && !(enc->codec->capabilities & AV_CODEC_CAP_DELAY))
-                pkt.pts = ost->sync_opts;
-
-            av_packet_rescale_ts(&pkt, enc->time_base, ost->mux_timebase);
-
-            if (debug_ts) {
-                av_log(NULL, AV_LOG_INFO, "encoder -> type:video "
-                    "pkt_pts:%s pkt_pts_time:%s pkt_dts:%s pkt_dts_time:%s\n",
-                    av_ts2str(pkt.pts), av_ts2timestr(pkt.pts, &ost->mux_timebase),
-                    av_ts2str(pkt.dts), av_ts2timestr(pkt.dts, &ost->mux_timebase));
-            }
-
-            frame_size = pkt.size;
-            output_packet(of, &pkt, ost, 0);
-
-            /* if two pass, output log */
-            if (ost->logfile && enc->stats_out) {
-                fprintf(ost->logfile, "%s", enc->stats_out);
-            }
-        }
         ost->sync_opts++;
         /*
          * For video, number of frames in == number of packets out.
@@ -1343,11 +1664,6 @@ static void do_video_out(OutputFile *of,
         av_frame_ref(ost->last_frame, next_picture);
     else
         av_frame_free(&ost->last_frame);
-
-    return;
-error:
-    av_log(NULL, AV_LOG_FATAL, "Video encoding failed\n");
-    exit_program(1);
 }
 
 static double psnr(double d)
@@ -1908,6 +2224,13 @@ static void flush_encoders(void)
         if (enc->codec_type != AVMEDIA_TYPE_VIDEO && enc->codec_type != AVMEDIA_TYPE_AUDIO)
             continue;
 
+#if HAVE_THREADS
+        if (ost->enc_frame_queue) {
+            encoder_thread_send(ost, NULL);
+            continue;
+        }
+#endif
+
         for (;;) {
             const char *desc = NULL;
             AVPacket pkt;
@@ -1966,6 +2289,8 @@ static void flush_encoders(void)
             }
         }
     }
+
+    flush_encoder_pipeline();
 }
 
 /*
@@ -1998,6 +2323,8 @@ static void do_streamcopy(InputStream *ist, OutputStream *ost, const AVPacket *p
 
     av_init_packet(&opkt);
 
+    flush_encoder_pipeline();
+
     // EOF: flush output bitstream filters.
     if (!pkt) {
         output_packet(of, &opkt, ost, 1);
@@ -2125,11 +2452,15 @@ static int ifilter_has_all_input_formats(FilterGraph *fg)
     return 1;
 }
 
-static int ifilter_send_frame(InputFilter *ifilter, AVFrame *frame)
+static int ifilter_send_frame(InputFilter *ifilter, AVFrame *frame, int64_t generation)
 {
     FilterGraph *fg = ifilter->graph;
     int need_reinit, ret, i;
 
+    ret = ifilter_convert_frame(ifilter, frame, generation, &frame);
+    if (ret < 0)
+        return ret;
+
     /* determine if the parameters for this input changed */
     need_reinit = ifilter->format != frame->format;
 
@@ -2190,6 +2521,11 @@ static int ifilter_send_frame(InputFilter *ifilter, AVFrame *frame)
             av_log(NULL, AV_LOG_ERROR, "Error reinitializing filters!\n");
             return ret;
         }
+
+        /* the graph may have been set up for a shared conversion */
+        ret = ifilter_convert_frame(ifilter, frame, generation, &frame);
+        if (ret < 0)
+            return ret;
     }
 
     ret = av_buffersrc_add_frame_flags(ifilter->filter, frame, AV_BUFFERSRC_FLAG_PUSH);
@@ -2258,6 +2594,7 @@ static int send_frame_to_filters(InputStream *ist, AVFrame *decoded_frame)
     AVFrame *f;
 
     av_assert1(ist->nb_filters > 0); /* ensure ret is initialized */
+    ist->frame_generation++;
     for (i = 0; i < ist->nb_filters; i++) {
         if (i < ist->nb_filters - 1) {
             f = ist->filter_frame;
@@ -2266,7 +2603,7 @@ static int send_frame_to_filters(InputStream *ist, AVFrame *decoded_frame)
                 break;
         } else
             f = decoded_frame;
-        ret = ifilter_send_frame(ist->filters[i], f);
+        ret = ifilter_send_frame(ist->filters[i], f, ist->frame_generation);
         if (ret == AVERROR_EOF)
             ret = 0; /* ignore */
         if (ret < 0) {
@@ -3588,6 +3925,19 @@ static int init_output_stream(OutputStream *ost, char *error, int error_len)
             ost->st->duration = av_rescale_q(ist->st->duration, ist->st->time_base, ost->st->time_base);
 
         ost->st->codec->codec= ost->enc_ctx->codec;
+
+#if HAVE_THREADS
+        if (encode_pipeline &&
+            (ost->enc_ctx->codec_type == AVMEDIA_TYPE_VIDEO ||
+             ost->enc_ctx->codec_type == AVMEDIA_TYPE_AUDIO)) {
+            ret = init_encoder_thread(ost);
+            if (ret < 0) {
+                snprintf(error, error_len, "Could not start the encoder thread "
+                         "for output stream #%d:%d", ost->file_index, ost->index);
+                return ret;
+            }
+        }
+#endif
     } else if (ost->stream_copy) {
         ret = init_output_stream_streamcopy(ost);
         if (ret < 0)
@@ -4035,6 +4385,23 @@ static void *input_thread(void *arg)
             av_thread_message_queue_set_err_recv(f->in_thread_queue, ret);
             break;
         }
+        if (f->thread_queue_bytes) {
+            pthread_mutex_lock(&f->queued_bytes_lock);
+            if (flags && f->queued_bytes &&
+                f->queued_bytes + pkt.size > f->thread_queue_bytes) {
+                flags = 0;
+                av_log(f->ctx, AV_LOG_WARNING,
+                       "Thread message queue blocking; consider raising the "
+                       "thread_queue_bytes option (current value: %"PRId64")\n",
+                       f->thread_queue_bytes);
+            }
+            /* always let a packet through when the queue is empty */
+            while (f->queued_bytes &&
+                   f->queued_bytes + pkt.size > f->thread_queue_bytes)
+                pthread_cond_wait(&f->queued_bytes_cond, &f->queued_bytes_lock);
+            f->queued_bytes += pkt.size;
+            pthread_mutex_unlock(&f->queued_bytes_lock);
+        }
         ret = av_thread_message_queue_send(f->in_thread_queue, &pkt, flags);
         if (flags && ret == AVERROR(EAGAIN)) {
             flags = 0;
@@ -4058,6 +4425,16 @@ static void *input_thread(void *arg)
     return NULL;
 }
 
+static void input_thread_dequeued(InputFile *f, const AVPacket *pkt)
+{
+    if (!f->thread_queue_bytes)
+        return;
+    pthread_mutex_lock(&f->queued_bytes_lock);
+    f->queued_bytes -= pkt->size;
+    pthread_cond_signal(&f->queued_bytes_cond);
+    pthread_mutex_unlock(&f->queued_bytes_lock);
+}
+
 static void free_input_thread(int i)
 {
     InputFile *f = input_files[i];
@@ -4066,12 +4443,18 @@ static void free_input_thread(int i)
     if (!f || !f->in_thread_queue)
         return;
     av_thread_message_queue_set_err_send(f->in_thread_queue, AVERROR_EOF);
-    while (av_thread_message_queue_recv(f->in_thread_queue, &pkt, 0) >= 0)
+    while (av_thread_message_queue_recv(f->in_thread_queue, &pkt, 0) >= 0) {
+        input_thread_dequeued(f, &pkt);
         av_packet_unref(&pkt);
+    }
 
     pthread_join(f->thread, NULL);
     f->joined = 1;
     av_thread_message_queue_free(&f->in_thread_queue);
+    if (f->thread_queue_bytes) {
+        pthread_mutex_destroy(&f->queued_bytes_lock);
+        pthread_cond_destroy(&f->queued_bytes_cond);
+    }
 }
 
 static void free_input_threads(void)
@@ -4087,9 +4470,6 @@ static int init_input_thread(int i)
     int ret;
     InputFile *f = input_files[i];
 
-    if (nb_input_files == 1)
-        return 0;
-
     if (f->ctx->pb ? !f->ctx->pb->seekable :
         strcmp(f->ctx->iformat->name, "lavfi"))
         f->non_blocking = 1;
@@ -4098,9 +4478,19 @@ static int init_input_thread(int i)
     if (ret < 0)
         return ret;
 
+    if (f->thread_queue_bytes) {
+        f->queued_bytes = 0;
+        pthread_mutex_init(&f->queued_bytes_lock, NULL);
+        pthread_cond_init(&f->queued_bytes_cond, NULL);
+    }
+
     if ((ret = pthread_create(&f->thread, NULL, input_thread, f))) {
         av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
         av_thread_message_queue_free(&f->in_thread_queue);
+        if (f->thread_queue_bytes) {
+            pthread_mutex_destroy(&f->queued_bytes_lock);
+            pthread_cond_destroy(&f->queued_bytes_cond);
+        }
         return AVERROR(ret);
     }
 
@@ -4121,9 +4511,13 @@ static int init_input_threads(void)
 
 static int get_input_packet_mt(InputFile *f, AVPacket *pkt)
 {
-    return av_thread_message_queue_recv(f->in_thread_queue, pkt,
-                                        f->non_blocking ?
-                                        AV_THREAD_MESSAGE_NONBLOCK : 0);
+    /* with a single input there is nothing else to do while waiting */
+    int ret = av_thread_message_queue_recv(f->in_thread_queue, pkt,
+                                           f->non_blocking && nb_input_files > 1 ?
+                                           AV_THREAD_MESSAGE_NONBLOCK : 0);
+    if (ret >= 0)
+        input_thread_dequeued(f, pkt);
+    return ret;
 }
 #endif
 
@@ -4141,7 +4535,7 @@ static int get_input_packet(InputFile *f, AVPacket *pkt)
     }
 
 #if HAVE_THREADS
-    if (nb_input_files > 1)
+    if (f->in_thread_queue)
         return get_input_packet_mt(f, pkt);
 #endif
     return av_read_frame(f->ctx, pkt);
@@ -4675,6 +5069,12 @@ static int transcode(void)
     while (!received_sigterm) {
         int64_t cur_time= av_gettime_relative();
 
+#if HAVE_THREADS
+        /* mux whatever the encoder threads have finished so far */
+        while (mux_encoder_packet(0))
+            ;
+#endif
+
         /* if 'q' pressed, exits */
         if (stdin_interaction)
             if (check_keyboard_interaction(cur_time) < 0)
@@ -4763,6 +5163,7 @@ static int transcode(void)
  fail:
 #if HAVE_THREADS
     free_input_threads();
+    free_encoder_threads();
 #endif
 
     if (output_streams) {
@@ -120,6 +120,7 @@ typedef struct OptionsContext {
     int rate_emu;
     int accurate_seek;
     int thread_queue_size;
+    int64_t thread_queue_bytes;
 
     SpecifierOpt *ts_scale;
     int        nb_ts_scale;
@@ -253,6 +254,10 @@ typedef struct InputFilter {
 
     AVBufferRef *hw_frames_ctx;
 
+    /* shared conversion applied to the decoded frames before they are sent
+     * to this input, see ifilter_convert_frame() */
+    struct FrameConverter *conv;
+
     int eof;
 } InputFilter;
 
@@ -292,6 +297,21 @@ typedef struct FilterGraph {
     int         nb_outputs;
 } FilterGraph;
 
+/* pixel format conversion shared by all the filtergraphs fed by a stream */
+typedef struct FrameConverter {
+    AVFilterGraph   *graph;
+    AVFilterContext *src, *sink;
+    enum AVPixelFormat format;  /* output format */
+    char            *sws_opts;  /* options of the scale filter */
+
+    /* parameters the graph is configured for */
+    int in_format, in_width, in_height;
+
+    int64_t generation;         /* decoded frame out was converted from, 0 if none */
+    AVFrame *out;               /* converted frame */
+    AVFrame *tmp;               /* reference to out handed to a filtergraph */
+} FrameConverter;
+
 typedef struct InputStream {
     int file_index;
     AVStream *st;
@@ -358,6 +378,12 @@ typedef struct InputStream {
     InputFilter **filters;
     int        nb_filters;
 
+    FrameConverter **converters;
+    int           nb_converters;
+    /* counts the decoded frames sent to the filters, so that the converters
+     * can tell them apart */
+    int64_t frame_generation;
+
     int reinit_filters;
 
     /* hwaccel options */
@@ -418,6 +444,10 @@ typedef struct InputFile {
     int non_blocking;           /* reading packets from the thread should not block */
     int joined;                 /* the thread has been joined */
     int thread_queue_size;      /* maximum number of queued packets */
+    int64_t thread_queue_bytes; /* maximum size of the queued packets, 0 for no limit */
+    int64_t queued_bytes;       /* size of the packets currently queued */
+    pthread_mutex_t queued_bytes_lock;
+    pthread_cond_t  queued_bytes_cond;
 #endif
 } InputFile;
 
@@ -549,6 +579,14 @@ typedef struct OutputStream {
 
     /* frame encode sum of squared error values */
     int64_t error[4];
+
+#if HAVE_THREADS
+    /* encoder thread, only used with -encode_pipeline */
+    AVThreadMessageQueue *enc_frame_queue;  /* frames to encode */
+    AVThreadMessageQueue *enc_pkt_queue;    /* encoded packets waiting to be muxed */
+    pthread_t enc_thread;
+    int enc_last_pkt_size;                  /* size of the last packet muxed for the current frame */
+#endif
 } OutputStream;
 
 typedef struct OutputFile {
@@ -609,6 +647,9 @@ extern char *videotoolbox_pixfmt;
 
 extern int filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern char *filter_thread_type;
+extern int encode_pipeline;
+extern int encode_queue_size;
 extern int vstats_version;
 
 extern const AVIOInterruptCB int_cb;
@@ -649,6 +690,9 @@ int init_complex_filtergraph(FilterGraph *fg);
 void sub2video_update(InputStream *ist, AVSubtitle *sub);
 
 int ifilter_parameters_from_frame(InputFilter *ifilter, const AVFrame *frame);
+int ifilter_convert_frame(InputFilter *ifilter, AVFrame *frame, int64_t generation,
+                          AVFrame **out);
+void free_frame_converters(InputStream *ist);
 
 int ffmpeg_parse_options(int argc, char **argv);
 
@@ -1001,6 +1001,200 @@ static void cleanup_filtergraph(FilterGraph *fg)
     avfilter_graph_free(&fg->graph);
 }
 
+static int configure_frame_converter(FrameConverter *conv, const AVFrame *frame)
+{
+    const enum AVPixelFormat pix_fmts[] = { conv->format, AV_PIX_FMT_NONE };
+    AVFilterContext *scale;
+    AVRational sar = frame->sample_aspect_ratio;
+    char args[256];
+    int ret;
+
+    avfilter_graph_free(&conv->graph);
+    if (!(conv->graph = avfilter_graph_alloc()))
+        return AVERROR(ENOMEM);
+
+    if (!sar.den)
+        sar = (AVRational){0,1};
+    snprintf(args, sizeof(args),
+             "video_size=%dx%d:pix_fmt=%d:time_base=1/%d:pixel_aspect=%d/%d",
+             frame->width, frame->height, frame->format, AV_TIME_BASE,
+             sar.num, sar.den);
+
+    if ((ret = avfilter_graph_create_filter(&conv->src, avfilter_get_by_name("buffer"),
+                                            "in", args, NULL, conv->graph)) < 0 ||
+        (ret = avfilter_graph_create_filter(&scale, avfilter_get_by_name("scale"),
+                                            "scale", conv->sws_opts, NULL, conv->graph)) < 0 ||
+        (ret = avfilter_graph_create_filter(&conv->sink, avfilter_get_by_name("buffersink"),
+                                            "out", NULL, NULL, conv->graph)) < 0)
+        return ret;
+    if ((ret = av_opt_set_int_list(conv->sink, "pix_fmts", pix_fmts,
+                                   AV_PIX_FMT_NONE, AV_OPT_SEARCH_CHILDREN)) < 0)
+        return ret;
+
+    if ((ret = avfilter_link(conv->src, 0, scale, 0)) < 0 ||
+        (ret = avfilter_link(scale, 0, conv->sink, 0)) < 0 ||
+        (ret = avfilter_graph_config(conv->graph, NULL)) < 0)
+        return ret;
+
+    conv->in_format = frame->format;
+    conv->in_width  = frame->width;
+    conv->in_height = frame->height;
+
+    return 0;
+}
+
+static FrameConverter *get_frame_converter(InputStream *ist, enum AVPixelFormat format,
+                                           const char *sws_opts)
+{
+    FrameConverter *conv;
+    int i;
+
+    if (!sws_opts)
+        sws_opts = "";
+
+    for (i = 0; i < ist->nb_converters; i++) {
+        conv = ist->converters[i];
+        if (conv->format == format && !strcmp(conv->sws_opts, sws_opts))
+            return conv;
+    }
+
+    conv = av_mallocz(sizeof(*conv));
+    if (!conv)
+        return NULL;
+    conv->format   = format;
+    conv->sws_opts = av_strdup(sws_opts);
+    conv->out      = av_frame_alloc();
+    conv->tmp      = av_frame_alloc();
+    if (!conv->sws_opts || !conv->out || !conv->tmp) {
+        av_freep(&conv->sws_opts);
+        av_frame_free(&conv->out);
+        av_frame_free(&conv->tmp);
+        av_freep(&conv);
+        return NULL;
+    }
+
+    GROW_ARRAY(ist->converters, ist->nb_converters);
+    ist->converters[ist->nb_converters - 1] = conv;
+
+    return conv;
+}
+
+void free_frame_converters(InputStream *ist)
+{
+    int i;
+
+    for (i = 0; i < ist->nb_converters; i++) {
+        FrameConverter *conv = ist->converters[i];
+        avfilter_graph_free(&conv->graph);
+        av_frame_free(&conv->out);
+        av_frame_free(&conv->tmp);
+        av_freep(&conv->sws_opts);
+        av_freep(&ist->converters[i]);
+    }
+    av_freep(&ist->converters);
+    ist->nb_converters = 0;
+}
+
+/*
+ * When a decoded stream feeds several filtergraphs, each of them would
+ * convert the frames with its own auto-inserted scaler if it cannot take the
+ * decoded format. Detect that case and configure the graph input for the
+ * format picked by the scaler instead; the frames are then converted once per
+ * target format by ifilter_convert_frame() and shared by reference.
+ *
+ * @return 1 if the graph must be configured again, 0 if not, <0 on error
+ */
+static int setup_shared_conversions(FilterGraph *fg)
+{
+    int i, reconfigure = 0;
+
+    for (i = 0; i < fg->nb_inputs; i++) {
+        InputFilter *ifilter = fg->inputs[i];
+        AVFilterContext *next;
+
+        if (ifilter->type != AVMEDIA_TYPE_VIDEO || ifilter->conv ||
+            ifilter->hw_frames_ctx || ifilter->ist->nb_filters < 2)
+            continue;
+
+        next = ifilter->filter->outputs[0]->dst;
+        if (strcmp(next->filter->name, "scale") ||
+            !av_strstart(next->name, "auto_scaler_", NULL))
+            continue;
+
+        ifilter->conv = get_frame_converter(ifilter->ist, next->outputs[0]->format,
+                                            fg->graph->scale_sws_opts);
+        if (!ifilter->conv)
+            return AVERROR(ENOMEM);
+
+        av_log(NULL, AV_LOG_VERBOSE, "Sharing the conversion of stream #%d:%d "
+               "from %s to %s with the other filtergraphs\n",
+               ifilter->ist->file_index, ifilter->ist->st->index,
+               av_get_pix_fmt_name(ifilter->format),
+               av_get_pix_fmt_name(ifilter->conv->format));
+        ifilter->format = ifilter->conv->format;
+        reconfigure = 1;
+    }
+
+    return reconfigure;
+}
+
+/**
+ * Apply the shared conversion of ifilter to frame, if it has one.
+ *
+ * @param generation identifies frame among the frames decoded by its stream,
+ *                   the conversion is reused for the other filtergraphs fed
+ *                   the same generation; 0 if it must not be reused
+ * @param out        set to frame if no conversion is needed, to a reference to
+ *                   the converted frame otherwise, in which case frame is
+ *                   unreferenced
+ */
+int ifilter_convert_frame(InputFilter *ifilter, AVFrame *frame, int64_t generation,
+                          AVFrame **out)
+{
+    FrameConverter *conv = ifilter->conv;
+    int ret;
+
+    *out = frame;
+
+    if (!conv || frame->format == conv->format)
+        return 0;
+
+    /* hardware frames cannot be converted here, let the graph be
+     * reconfigured for them */
+    if (frame->hw_frames_ctx) {
+        ifilter->conv = NULL;
+        return 0;
+    }
+
+    if (!generation || generation != conv->generation) {
+        av_frame_unref(conv->out);
+        conv->generation = 0;
+
+        if (!conv->graph || frame->format != conv->in_format ||
+            frame->width != conv->in_width || frame->height != conv->in_height) {
+            ret = configure_frame_converter(conv, frame);
+            if (ret < 0)
+                return ret;
+        }
+
+        ret = av_buffersrc_add_frame_flags(conv->src, frame, AV_BUFFERSRC_FLAG_KEEP_REF);
+        if (ret < 0)
+            return ret;
+        ret = av_buffersink_get_frame(conv->sink, conv->out);
+        if (ret < 0)
+            return ret;
+        conv->generation = generation;
+    }
+
+    av_frame_unref(conv->tmp);
+    ret = av_frame_ref(conv->tmp, conv->out);
+    if (ret < 0)
+        return ret;
+    av_frame_unref(frame);
+    *out = conv->tmp;
+    return 0;
+}
+
 int configure_filtergraph(FilterGraph *fg)
 {
     AVFilterInOut *inputs, *outputs, *cur;
@@ -1052,6 +1246,13 @@ int configure_filtergraph(FilterGraph *fg)
         fg->graph->nb_threads = filter_complex_nbthreads;
     }
 
+    if (filter_thread_type &&
+        (ret = av_opt_set(fg->graph, "thread_type", filter_thread_type, 0)) < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Invalid filter thread type '%s'\n",
+               filter_thread_type);
+        goto fail;
+    }
+
     if ((ret = avfilter_graph_parse2(fg->graph, graph_desc, &inputs, &outputs)) < 0)
         goto fail;
 
@@ -1108,6 +1309,11 @@ int configure_filtergraph(FilterGraph *fg)
     if ((ret = avfilter_graph_config(fg->graph, NULL)) < 0)
         goto fail;
 
+    if ((ret = setup_shared_conversions(fg)) < 0)
+        goto fail;
+    if (ret)
+        return configure_filtergraph(fg);
+
     /* limit the lists of allowed formats to the ones selected, to
      * make sure they stay the same if the filtergraph is reconfigured later */
     for (i = 0; i < fg->nb_outputs; i++) {
@@ -1143,9 +1349,11 @@ int configure_filtergraph(FilterGraph *fg)
 
     for (i = 0; i < fg->nb_inputs; i++) {
         while (av_fifo_size(fg->inputs[i]->frame_queue)) {
-            AVFrame *tmp;
+            AVFrame *tmp, *frame;
             av_fifo_generic_read(fg->inputs[i]->frame_queue, &tmp, sizeof(tmp), NULL);
-            ret = av_buffersrc_add_frame(fg->inputs[i]->filter, tmp);
+            ret = ifilter_convert_frame(fg->inputs[i], tmp, 0, &frame);
+            if (ret >= 0)
+                ret = av_buffersrc_add_frame(fg->inputs[i]->filter, frame);
             av_frame_free(&tmp);
             if (ret < 0)
                 goto fail;
@@ -109,6 +109,9 @@ int frame_bits_per_raw_sample = 0;
 float max_error_rate  = 2.0/3;
 int filter_nbthreads = 0;
 int filter_complex_nbthreads = 0;
+char *filter_thread_type;
+int encode_pipeline   = 0;
+int encode_queue_size = 8;
 int vstats_version = 2;
 
 
@@ -1212,6 +1215,7 @@ static int open_input_file(OptionsContext *o, const char *filename)
     f->time_base = (AVRational){ 1, 1 };
 #if HAVE_THREADS
     f->thread_queue_size = o->thread_queue_size > 0 ? o->thread_queue_size : 8;
+    f->thread_queue_bytes = FFMAX(o->thread_queue_bytes, 0);
 #endif
 
     /* check if all codec options have been used */
@@ -3511,6 +3515,12 @@ const OptionDef options[] = {
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_threads", HAS_ARG | OPT_INT,                   { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "filter_thread_type", HAS_ARG | OPT_STRING | OPT_EXPERT,      { &filter_thread_type },
+        "allowed threading types for all filtergraphs (slice, graph, pipeline)", "flags" },
+    { "encode_pipeline", OPT_BOOL | OPT_EXPERT,                      { &encode_pipeline },
+        "run every audio/video encoder in its own thread, decoding and filtering stay on the main thread" },
+    { "encode_queue_size", HAS_ARG | OPT_INT | OPT_EXPERT,           { &encode_queue_size },
+        "maximum number of frames queued for each encoder thread", "size" },
     { "lavfi",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_script", HAS_ARG | OPT_EXPERT,                 { .func_arg = opt_filter_complex_script },
@@ -3538,6 +3548,9 @@ const OptionDef options[] = {
     { "thread_queue_size", HAS_ARG | OPT_INT | OPT_OFFSET | OPT_EXPERT | OPT_INPUT,
                                                                      { .off = OFFSET(thread_queue_size) },
         "set the maximum number of queued packets from the demuxer" },
+    { "thread_queue_bytes", HAS_ARG | OPT_INT64 | OPT_OFFSET | OPT_EXPERT | OPT_INPUT,
+                                                                     { .off = OFFSET(thread_queue_bytes) },
+        "set the maximum size in bytes of the queued packets from the demuxer" },
     { "find_stream_info", OPT_BOOL | OPT_PERFILE | OPT_INPUT | OPT_EXPERT, { &find_stream_info },
         "read and decode the streams to fill missing information with heuristics" },
 
@@ -3357,6 +3357,35 @@ typedef struct AVCodecContext {
      * - encoding: unused
      */
     int discard_damaged_percentage;
+
+    /**
+     * Maximum number of frames of delay frame threading may add.
+     * -1 means no limit, 0 disables frame threading. When the thread
+     * count exceeds this delay plus one, decoders supporting both kinds
+     * of threading spend the remaining threads on slice threading inside
+     * each frame thread.
+     * - encoding: unused
+     * - decoding: Set by user.
+     */
+    int max_thread_delay;
+
+    /**
+     * Average time in microseconds between submitting a packet and
+     * receiving the frame decoded from it, including the delay added by
+     * frame threading. For decoders implementing the receive_frame() API
+     * it also includes the reordering delay inside the decoder.
+     * - encoding: unused
+     * - decoding: Set by libavcodec.
+     */
+    int64_t decode_latency;
+
+    /**
+     * Number of frames decoded per second of wall clock time since the
+     * first packet was submitted.
+     * - encoding: unused
+     * - decoding: Set by libavcodec.
+     */
+    double decode_throughput;
 } AVCodecContext;
 
 #if FF_API_CODEC_GET_SET
@@ -37,6 +37,7 @@
 #include "libavutil/internal.h"
 #include "libavutil/intmath.h"
 #include "libavutil/opt.h"
+#include "libavutil/time.h"
 
 #include "avcodec.h"
 #include "bytestream.h"
@@ -348,9 +349,24 @@ int ff_decode_get_packet(AVCodecContext *avctx, AVPacket *pkt)
     if (ret < 0)
         goto finish;
 
-    if (avctx->codec->receive_frame)
+    if (avctx->codec->receive_frame) {
         avci->compat_decode_consumed += pkt->size;
 
+        /* the oldest packets most likely did not give any frame */
+        if (avci->nb_submits == FF_ARRAY_ELEMS(avci->submit_times)) {
+            avci->nb_submits--;
+            memmove(avci->submit_dts,   avci->submit_dts   + 1,
+                    avci->nb_submits * sizeof(*avci->submit_dts));
+            memmove(avci->submit_times, avci->submit_times + 1,
+                    avci->nb_submits * sizeof(*avci->submit_times));
+        }
+        avci->submit_dts[avci->nb_submits]   = pkt->dts;
+        avci->submit_times[avci->nb_submits] = av_gettime_relative();
+        if (!avci->decode_start_time)
+            avci->decode_start_time = avci->submit_times[avci->nb_submits];
+        avci->nb_submits++;
+    }
+
     return 0;
 finish:
     av_packet_unref(pkt);
@@ -393,6 +409,19 @@ static int64_t guess_correct_pts(AVCodecContext *ctx,
     return pts;
 }
 
+static void update_decode_stats(AVCodecContext *avctx, int64_t submit_time)
+{
+    AVCodecInternal *avci = avctx->internal;
+    int64_t now = av_gettime_relative();
+
+    avci->nb_decoded_frames++;
+    avci->decode_latency_sum += now - submit_time;
+    avctx->decode_latency = avci->decode_latency_sum / avci->nb_decoded_frames;
+    if (now > avci->decode_start_time)
+        avctx->decode_throughput = avci->nb_decoded_frames * 1000000.0 /
+                                   (now - avci->decode_start_time);
+}
+
 /*
  * The core of the receive_frame_wrapper for the decoders implementing
  * the simple API. Certain decoders might consume partial packets without
@@ -427,6 +456,10 @@ static int decode_simple_internal(AVCodecContext *avctx, AVFrame *frame)
 
     got_frame = 0;
 
+    avci->submit_time = av_gettime_relative();
+    if (!avci->decode_start_time)
+        avci->decode_start_time = avci->submit_time;
+
     if (HAVE_THREADS && avctx->active_thread_type & FF_THREAD_FRAME) {
         ret = ff_thread_decode_frame(avctx, frame, &got_frame, pkt);
     } else {
@@ -450,6 +483,9 @@ static int decode_simple_internal(AVCodecContext *avctx, AVFrame *frame)
     emms_c();
     actual_got_frame = got_frame;
 
+    if (actual_got_frame)
+        update_decode_stats(avctx, avci->submit_time);
+
     if (avctx->codec->type == AVMEDIA_TYPE_VIDEO) {
         if (frame->flags & AV_FRAME_FLAG_DISCARD)
             got_frame = 0;
@@ -634,6 +670,30 @@ static int decode_simple_receive_frame(AVCodecContext *avctx, AVFrame *frame)
     return 0;
 }
 
+/**
+ * Remove the submit time of the packet a receive_frame() decoder output a
+ * frame for: the packet with the frame dts, or else the oldest one.
+ */
+static int64_t pop_submit_time(AVCodecInternal *avci, int64_t dts)
+{
+    int64_t submit_time;
+    int i;
+
+    for (i = 0; i < avci->nb_submits; i++)
+        if (avci->submit_dts[i] == dts)
+            break;
+    if (i == avci->nb_submits)
+        i = 0;
+
+    submit_time = avci->submit_times[i];
+    avci->nb_submits--;
+    memmove(avci->submit_dts   + i, avci->submit_dts   + i + 1,
+            (avci->nb_submits - i) * sizeof(*avci->submit_dts));
+    memmove(avci->submit_times + i, avci->submit_times + i + 1,
+            (avci->nb_submits - i) * sizeof(*avci->submit_times));
+    return submit_time;
+}
+
 static int decode_receive_frame_internal(AVCodecContext *avctx, AVFrame *frame)
 {
     AVCodecInternal *avci = avctx->internal;
@@ -641,9 +701,11 @@ static int decode_receive_frame_internal(AVCodecContext *avctx, AVFrame *frame)
 
     av_assert0(!frame->buf[0]);
 
-    if (avctx->codec->receive_frame)
+    if (avctx->codec->receive_frame) {
         ret = avctx->codec->receive_frame(avctx, frame);
-    else
+        if (!ret && avci->nb_submits)
+            update_decode_stats(avctx, pop_submit_time(avci, frame->pkt_dts));
+    } else
         ret = decode_simple_receive_frame(avctx, frame);
 
     if (ret == AVERROR_EOF)
@@ -1988,6 +2050,7 @@ void avcodec_flush_buffers(AVCodecContext *avctx)
     av_frame_unref(avctx->internal->compat_decode_frame);
     av_packet_unref(avctx->internal->buffer_pkt);
     avctx->internal->buffer_pkt_valid = 0;
+    avctx->internal->nb_submits = 0;
 
     av_packet_unref(avctx->internal->ds.in_pkt);
 
@@ -57,6 +57,8 @@ av_cold int ff_ffv1_common_init(AVCodecContext *avctx)
     s->width  = avctx->width;
     s->height = avctx->height;
 
+    ff_ffv1dsp_init(&s->dsp);
+
     // defaults
     s->num_h_slices = 1;
     s->num_v_slices = 1;
@@ -142,13 +144,21 @@ av_cold int ff_ffv1_init_slice_contexts(FFV1Context *f)
         fs->slice_x      = sxs;
         fs->slice_y      = sys;
 
-        fs->sample_buffer = av_malloc_array((fs->width + 6), 3 * MAX_PLANES *
+        /* the line functions may read and write past the end of a line */
+        fs->sample_buffer = av_malloc_array((fs->width + 6) * 3 * MAX_PLANES + 16,
                                       sizeof(*fs->sample_buffer));
-        fs->sample_buffer32 = av_malloc_array((fs->width + 6), 3 * MAX_PLANES *
+        fs->sample_buffer32 = av_malloc_array((fs->width + 6) * 3 * MAX_PLANES + 16,
                                         sizeof(*fs->sample_buffer32));
-        if (!fs->sample_buffer || !fs->sample_buffer32) {
+        fs->context_buffer = av_malloc_array(fs->width + 16, sizeof(*fs->context_buffer));
+        fs->diff_buffer    = av_malloc_array(fs->width + 16, sizeof(*fs->diff_buffer));
+        fs->diff_buffer32  = av_malloc_array(fs->width + 16, sizeof(*fs->diff_buffer32));
+        if (!fs->sample_buffer || !fs->sample_buffer32 || !fs->context_buffer ||
+            !fs->diff_buffer || !fs->diff_buffer32) {
             av_freep(&fs->sample_buffer);
             av_freep(&fs->sample_buffer32);
+            av_freep(&fs->context_buffer);
+            av_freep(&fs->diff_buffer);
+            av_freep(&fs->diff_buffer32);
             av_freep(&f->slice_context[i]);
             goto memfail;
         }
@@ -159,6 +169,9 @@ memfail:
     while(--i >= 0) {
         av_freep(&f->slice_context[i]->sample_buffer);
         av_freep(&f->slice_context[i]->sample_buffer32);
+        av_freep(&f->slice_context[i]->context_buffer);
+        av_freep(&f->slice_context[i]->diff_buffer);
+        av_freep(&f->slice_context[i]->diff_buffer32);
         av_freep(&f->slice_context[i]);
     }
     return AVERROR(ENOMEM);
@@ -230,6 +243,9 @@ av_cold int ff_ffv1_close(AVCodecContext *avctx)
         }
         av_freep(&fs->sample_buffer);
         av_freep(&fs->sample_buffer32);
+        av_freep(&fs->context_buffer);
+        av_freep(&fs->diff_buffer);
+        av_freep(&fs->diff_buffer32);
     }
 
     av_freep(&avctx->stats_out);
@@ -35,6 +35,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/timer.h"
 #include "avcodec.h"
+#include "ffv1dsp.h"
 #include "get_bits.h"
 #include "internal.h"
 #include "mathops.h"
@@ -110,6 +111,10 @@ typedef struct FFV1Context {
     int colorspace;
     int16_t *sample_buffer;
     int32_t *sample_buffer32;
+    int16_t *context_buffer;
+    int16_t *diff_buffer;
+    int32_t *diff_buffer32;
+    FFV1DSPContext dsp;
 
     int use32bit;
 
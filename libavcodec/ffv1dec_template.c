@@ -30,6 +30,7 @@ static av_always_inline int RENAME(decode_line)(FFV1Context *s, int w,
     int run_count = 0;
     int run_mode  = 0;
     int run_index = s->run_index;
+    const int large = !!p->quant_table[3][127];
 
     if (is_input_end(s))
         return AVERROR_INVALIDDATA;
@@ -47,15 +48,21 @@ static av_always_inline int RENAME(decode_line)(FFV1Context *s, int w,
         return 0;
     }
 
+    s->dsp.RENAME(decode_top_context)(s->context_buffer, sample[0], sample[1],
+                                      p->quant_table[0], large, w);
+
     for (x = 0; x < w; x++) {
         int diff, context, sign;
+        const int L = sample[1][x - 1];
 
         if (!(x & 1023)) {
             if (is_input_end(s))
                 return AVERROR_INVALIDDATA;
         }
 
-        context = RENAME(get_context)(p, sample[1] + x, sample[0] + x, sample[1] + x);
+        context = s->context_buffer[x] + p->quant_table[0][(L - sample[0][x - 1]) & 0xFF];
+        if (large)
+            context += p->quant_table[3][(sample[1][x - 2] - L) & 0xFF];
         if (context < 0) {
             context = -context;
             sign    = 1;
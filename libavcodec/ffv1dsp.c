@@ -0,0 +1,43 @@
+/*
+ * FFV1 DSP functions
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "mathops.h"
+#include "ffv1dsp.h"
+
+#define TYPE int16_t
+#define RENAME(name) name ## _c
+#include "ffv1dsp_template.c"
+#undef TYPE
+#undef RENAME
+
+#define TYPE int32_t
+#define RENAME(name) name ## 32_c
+#include "ffv1dsp_template.c"
+
+av_cold void ff_ffv1dsp_init(FFV1DSPContext *c)
+{
+    c->encode_context       = encode_context_c;
+    c->encode_context32     = encode_context32_c;
+    c->decode_top_context   = decode_top_context_c;
+    c->decode_top_context32 = decode_top_context32_c;
+}
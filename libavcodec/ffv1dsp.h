@@ -0,0 +1,60 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_FFV1DSP_H
+#define AVCODEC_FFV1DSP_H
+
+#include <stdint.h>
+
+/**
+ * Per line context and prediction stage of FFV1, run ahead of the entropy
+ * coder. quant_table points to the 5 consecutive 256 entry quantization
+ * tables of a plane, of which one entry past the end must be readable, large
+ * is set when the 5 input context model is in use. Functions may read up to
+ * 16 samples past the end of the source rows and write up to 16 entries past
+ * the end of the output arrays.
+ */
+typedef struct FFV1DSPContext {
+    /**
+     * Compute the absolute context and the folded, sign corrected
+     * residual of each sample of a line for the encoder.
+     */
+    void (*encode_context)(int16_t *context, int16_t *diff,
+                           const int16_t *src, const int16_t *last,
+                           const int16_t *last2, const int16_t *quant_table,
+                           int large, int bits, int w);
+    void (*encode_context32)(int16_t *context, int32_t *diff,
+                             const int32_t *src, const int32_t *last,
+                             const int32_t *last2, const int16_t *quant_table,
+                             int large, int bits, int w);
+
+    /**
+     * Compute the signed part of the context of each sample of a line that
+     * depends only on the previous lines for the decoder.
+     */
+    void (*decode_top_context)(int16_t *context, const int16_t *last,
+                               const int16_t *last2, const int16_t *quant_table,
+                               int large, int w);
+    void (*decode_top_context32)(int16_t *context, const int32_t *last,
+                                 const int32_t *last2, const int16_t *quant_table,
+                                 int large, int w);
+} FFV1DSPContext;
+
+void ff_ffv1dsp_init(FFV1DSPContext *c);
+
+#endif /* AVCODEC_FFV1DSP_H */
@@ -0,0 +1,68 @@
+/*
+ * FFV1 context and prediction stage
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+static void RENAME(encode_context)(int16_t *context, TYPE *diff,
+                                   const TYPE *src, const TYPE *last,
+                                   const TYPE *last2, const int16_t *quant_table,
+                                   int large, int bits, int w)
+{
+    const int16_t *q = quant_table;
+    int x;
+
+    for (x = 0; x < w; x++) {
+        const int LT = last[x - 1];
+        const int T  = last[x];
+        const int RT = last[x + 1];
+        const int L  = src[x - 1];
+        int c = q[      ((L  - LT) & 0xFF)] +
+                q[256 + ((LT - T)  & 0xFF)] +
+                q[512 + ((T  - RT) & 0xFF)];
+        int d = src[x] - mid_pred(L, L + T - LT, T);
+
+        if (large)
+            c += q[768  + ((src[x - 2] - L) & 0xFF)] +
+                 q[1024 + ((last2[x]   - T) & 0xFF)];
+
+        if (c < 0) {
+            c = -c;
+            d = -d;
+        }
+        context[x] = c;
+        diff[x]    = sign_extend(d, bits);
+    }
+}
+
+static void RENAME(decode_top_context)(int16_t *context, const TYPE *last,
+                                       const TYPE *last2, const int16_t *quant_table,
+                                       int large, int w)
+{
+    const int16_t *q = quant_table;
+    int x;
+
+    for (x = 0; x < w; x++) {
+        const int T = last[x];
+        int c = q[256 + ((last[x - 1] - T) & 0xFF)] +
+                q[512 + ((T - last[x + 1]) & 0xFF)];
+
+        if (large)
+            c += q[1024 + ((last2[x] - T) & 0xFF)];
+        context[x] = c;
+    }
+}
@@ -868,6 +868,12 @@ FF_ENABLE_DEPRECATION_WARNINGS
         int max_h_slices = AV_CEIL_RSHIFT(avctx->width , s->chroma_h_shift);
         int max_v_slices = AV_CEIL_RSHIFT(avctx->height, s->chroma_v_shift);
         s->num_v_slices = (avctx->width > 352 || avctx->height > 288 || !avctx->slices) ? 2 : 1;
+        /* by default keep slices at about half a megapixel, so large
+         * frames get enough independent slices to keep all threads busy */
+        if (!avctx->slices)
+            while (s->num_v_slices < 8 &&
+                   (int64_t)avctx->width * avctx->height > (int64_t)s->num_v_slices * s->num_v_slices << 19)
+                s->num_v_slices++;
 
         s->num_v_slices = FFMIN(s->num_v_slices, max_v_slices);
 
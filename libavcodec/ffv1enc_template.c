@@ -55,18 +55,14 @@ static av_always_inline int RENAME(encode_line)(FFV1Context *s, int w,
         return 0;
     }
 
-    for (x = 0; x < w; x++) {
-        int diff, context;
-
-        context = RENAME(get_context)(p, sample[0] + x, sample[1] + x, sample[2] + x);
-        diff    = sample[0][x] - RENAME(predict)(sample[0] + x, sample[1] + x);
+    s->dsp.RENAME(encode_context)(s->context_buffer, RENAME(s->diff_buffer),
+                                  sample[0], sample[1], sample[2],
+                                  p->quant_table[0], !!p->quant_table[3][127],
+                                  bits, w);
 
-        if (context < 0) {
-            context = -context;
-            diff    = -diff;
-        }
-
-        diff = fold(diff, bits);
+    for (x = 0; x < w; x++) {
+        int context = s->context_buffer[x];
+        int diff    = RENAME(s->diff_buffer)[x];
 
         if (s->ac != AC_GOLOMB_RICE) {
             if (s->flags & AV_CODEC_FLAG_PASS1) {
@@ -2554,10 +2554,37 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
     if (h->droppable || sl->h264->slice_ctx[0].er.error_occurred)
         return;
 
+    /* slices decoded in parallel finish their rows out of order */
+    if (h->nb_slice_ctx_queued > 1)
+        return;
+
     ff_thread_report_progress(&h->cur_pic_ptr->tf, top + height - 1,
                               h->picture_structure == PICT_BOTTOM_FIELD);
 }
 
+/**
+ * Report progress after a batch of slices was decoded in parallel,
+ * up to the first row the last slice did not finish.
+ */
+static void decode_finish_slices(const H264Context *h)
+{
+    int pic_height = 16 * h->mb_height >> FIELD_PICTURE(h);
+    int end        = 16 * (h->mb_y     >> FIELD_PICTURE(h));
+
+    if (h->droppable || h->slice_ctx[0].er.error_occurred)
+        return;
+
+    /* deblocking the unfinished row may still modify the lines above it */
+    if (end < pic_height)
+        end -= (16 + 4) << FRAME_MBAFF(h);
+    else
+        end  = pic_height;
+
+    if (end > 0)
+        ff_thread_report_progress(&h->cur_pic_ptr->tf, end - 1,
+                                  h->picture_structure == PICT_BOTTOM_FIELD);
+}
+
 static void er_add_slice(H264SliceContext *sl,
                          int startx, int starty,
                          int endx, int endy, int status)
@@ -2862,6 +2889,9 @@ int ff_h264_execute_decode_slices(H264Context *h)
                 }
             }
         }
+
+        if (avctx->active_thread_type & FF_THREAD_FRAME)
+            decode_finish_slices(h);
     }
 
 finish:
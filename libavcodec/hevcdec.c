@@ -810,6 +810,7 @@ static int hls_slice_header(HEVCContext *s)
     }
 
     sh->num_entry_point_offsets = 0;
+    s->enable_parallel_tiles    = 0;
     if (s->ps.pps->tiles_enabled_flag || s->ps.pps->entropy_coding_sync_enabled_flag) {
         unsigned num_entry_point_offsets = get_ue_golomb_long(gb);
         // It would be possible to bound this tighter but this here is simpler
@@ -844,8 +845,15 @@ static int hls_slice_header(HEVCContext *s)
                 sh->entry_point_offset[i] = val + 1; // +1; // +1 to get the size
             }
             if (s->threads_number > 1 && (s->ps.pps->num_tile_rows > 1 || s->ps.pps->num_tile_columns > 1)) {
-                s->enable_parallel_tiles = 0; // TODO: you can enable tiles in parallel here
-                s->threads_number = 1;
+                // tiles are decoded in parallel when one slice segment holds all of them
+                if (HAVE_THREADS && !s->ps.pps->entropy_coding_sync_enabled_flag &&
+                    sh->first_slice_in_pic_flag &&
+                    sh->num_entry_point_offsets + 1 == s->ps.pps->num_tile_columns * s->ps.pps->num_tile_rows) {
+                    s->enable_parallel_tiles = 1;
+                } else {
+                    s->enable_parallel_tiles = 0;
+                    s->threads_number = 1;
+                }
             } else
                 s->enable_parallel_tiles = 0;
         } else
@@ -2530,42 +2538,17 @@ error:
     return ret;
 }
 
-static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
+/**
+ * Compute the position and size of each substream of the slice segment
+ * data, skipping the emulation prevention bytes.
+ */
+static int hls_entry_points(HEVCContext *s, const H2645NAL *nal)
 {
-    const uint8_t *data = nal->data;
-    int length          = nal->size;
+    int length           = nal->size;
     HEVCLocalContext *lc = s->HEVClc;
-    int *ret = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
-    int *arg = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
     int64_t offset;
     int64_t startheader, cmpt = 0;
-    int i, j, res = 0;
-
-    if (!ret || !arg) {
-        av_free(ret);
-        av_free(arg);
-        return AVERROR(ENOMEM);
-    }
-
-    if (s->sh.slice_ctb_addr_rs + s->sh.num_entry_point_offsets * s->ps.sps->ctb_width >= s->ps.sps->ctb_width * s->ps.sps->ctb_height) {
-        av_log(s->avctx, AV_LOG_ERROR, "WPP ctb addresses are wrong (%d %d %d %d)\n",
-            s->sh.slice_ctb_addr_rs, s->sh.num_entry_point_offsets,
-            s->ps.sps->ctb_width, s->ps.sps->ctb_height
-        );
-        res = AVERROR_INVALIDDATA;
-        goto error;
-    }
-
-    ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
-
-    if (!s->sList[1]) {
-        for (i = 1; i < s->threads_number; i++) {
-            s->sList[i] = av_malloc(sizeof(HEVCContext));
-            memcpy(s->sList[i], s, sizeof(HEVCContext));
-            s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
-            s->sList[i]->HEVClc = s->HEVClcList[i];
-        }
-    }
+    int i, j;
 
     offset = (lc->gb.index >> 3);
 
@@ -2593,13 +2576,51 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
         offset += s->sh.entry_point_offset[s->sh.num_entry_point_offsets - 1] - cmpt;
         if (length < offset) {
             av_log(s->avctx, AV_LOG_ERROR, "entry_point_offset table is corrupted\n");
-            res = AVERROR_INVALIDDATA;
-            goto error;
+            return AVERROR_INVALIDDATA;
         }
         s->sh.size[s->sh.num_entry_point_offsets - 1] = length - offset;
         s->sh.offset[s->sh.num_entry_point_offsets - 1] = offset;
 
     }
+    return 0;
+}
+
+static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
+{
+    const uint8_t *data = nal->data;
+    int *ret = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
+    int *arg = av_malloc_array(s->sh.num_entry_point_offsets + 1, sizeof(int));
+    int i, res = 0;
+
+    if (!ret || !arg) {
+        av_free(ret);
+        av_free(arg);
+        return AVERROR(ENOMEM);
+    }
+
+    if (s->sh.slice_ctb_addr_rs + s->sh.num_entry_point_offsets * s->ps.sps->ctb_width >= s->ps.sps->ctb_width * s->ps.sps->ctb_height) {
+        av_log(s->avctx, AV_LOG_ERROR, "WPP ctb addresses are wrong (%d %d %d %d)\n",
+            s->sh.slice_ctb_addr_rs, s->sh.num_entry_point_offsets,
+            s->ps.sps->ctb_width, s->ps.sps->ctb_height
+        );
+        res = AVERROR_INVALIDDATA;
+        goto error;
+    }
+
+    ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
+
+    if (!s->sList[1]) {
+        for (i = 1; i < s->threads_number; i++) {
+            s->sList[i] = av_malloc(sizeof(HEVCContext));
+            memcpy(s->sList[i], s, sizeof(HEVCContext));
+            s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
+            s->sList[i]->HEVClc = s->HEVClcList[i];
+        }
+    }
+
+    res = hls_entry_points(s, nal);
+    if (res < 0)
+        goto error;
     s->data = data;
 
     for (i = 1; i < s->threads_number; i++) {
@@ -2628,6 +2649,232 @@ error:
     return res;
 }
 
+#if HAVE_THREADS
+static void hevc_free_tile_progress(HEVCContext *s)
+{
+    if (s->tile_progress) {
+        pthread_mutex_destroy(&s->tile_progress_mutex);
+        pthread_cond_destroy(&s->tile_progress_cond);
+        av_freep(&s->tile_progress);
+    }
+    s->nb_tile_progress = 0;
+}
+
+static int hevc_alloc_tile_progress(HEVCContext *s, int n)
+{
+    int i;
+
+    if (s->nb_tile_progress < n) {
+        hevc_free_tile_progress(s);
+
+        s->tile_progress = av_malloc_array(n, sizeof(*s->tile_progress));
+        if (!s->tile_progress)
+            return AVERROR(ENOMEM);
+
+        pthread_mutex_init(&s->tile_progress_mutex, NULL);
+        pthread_cond_init(&s->tile_progress_cond, NULL);
+        s->nb_tile_progress = n;
+    }
+
+    for (i = 0; i < n; i++)
+        atomic_init(&s->tile_progress[i], 0);
+    return 0;
+}
+
+static void hevc_report_tile_progress(HEVCContext *s, int ctb_row)
+{
+    pthread_mutex_lock(&s->tile_progress_mutex);
+    atomic_fetch_add_explicit(&s->tile_progress[ctb_row], 1, memory_order_release);
+    pthread_cond_signal(&s->tile_progress_cond);
+    pthread_mutex_unlock(&s->tile_progress_mutex);
+}
+
+static void hevc_await_tile_progress(HEVCContext *s, int ctb_row, int n)
+{
+    if (atomic_load_explicit(&s->tile_progress[ctb_row], memory_order_acquire) >= n)
+        return;
+
+    pthread_mutex_lock(&s->tile_progress_mutex);
+    while (atomic_load_explicit(&s->tile_progress[ctb_row], memory_order_relaxed) < n)
+        pthread_cond_wait(&s->tile_progress_cond, &s->tile_progress_mutex);
+    pthread_mutex_unlock(&s->tile_progress_mutex);
+}
+
+static int hls_decode_entry_tile(AVCodecContext *avctxt, void *arg, int tile, int self_id)
+{
+    HEVCContext *s1      = avctxt->priv_data, *s;
+    const HEVCSPS *sps   = s1->ps.sps;
+    const HEVCPPS *pps   = s1->ps.pps;
+    HEVCLocalContext *lc;
+    int ctb_size         = 1 << sps->log2_ctb_size;
+    int tile_x           = tile % pps->num_tile_columns;
+    int tile_y           = tile / pps->num_tile_columns;
+    int x_end            = FFMIN(pps->col_bd[tile_x + 1] << sps->log2_ctb_size, sps->width);
+    int ctb_row          = pps->row_bd[tile_y];
+    int ctb_addr_rs      = ctb_row * sps->ctb_width + pps->col_bd[tile_x];
+    int ctb_addr_ts      = pps->ctb_addr_rs_to_ts[ctb_addr_rs];
+    int ctb_addr_ts_end  = ctb_addr_ts + pps->column_width[tile_x] * pps->row_height[tile_y];
+    int more_data        = 1;
+    int ret;
+
+    s  = s1->sList[self_id];
+    lc = s->HEVClc;
+
+    if (tile) {
+        ret = init_get_bits8(&lc->gb, s->data + s->sh.offset[tile - 1], s->sh.size[tile - 1]);
+        if (ret < 0)
+            goto error;
+        ff_init_cabac_decoder(&lc->cc, s->data + s->sh.offset[tile - 1], s->sh.size[tile - 1]);
+    }
+
+    while (more_data && ctb_addr_ts < ctb_addr_ts_end) {
+        int x_ctb, y_ctb;
+
+        ctb_addr_rs = pps->ctb_addr_ts_to_rs[ctb_addr_ts];
+        x_ctb = (ctb_addr_rs % sps->ctb_width) << sps->log2_ctb_size;
+        y_ctb = (ctb_addr_rs / sps->ctb_width) << sps->log2_ctb_size;
+        hls_decode_neighbour(s, x_ctb, y_ctb, ctb_addr_ts);
+
+        ret = ff_hevc_cabac_init(s, ctb_addr_ts);
+        if (ret < 0)
+            goto error;
+
+        hls_sao_param(s, x_ctb >> sps->log2_ctb_size, y_ctb >> sps->log2_ctb_size);
+
+        s->deblock[ctb_addr_rs].beta_offset = s->sh.beta_offset;
+        s->deblock[ctb_addr_rs].tc_offset   = s->sh.tc_offset;
+        s->filter_slice_edges[ctb_addr_rs]  = s->sh.slice_loop_filter_across_slices_enabled_flag;
+
+        more_data = hls_coding_quadtree(s, x_ctb, y_ctb, sps->log2_ctb_size, 0);
+        if (more_data < 0) {
+            ret = more_data;
+            goto error;
+        }
+
+        ctb_addr_ts++;
+        if (x_ctb + ctb_size >= x_end)
+            hevc_report_tile_progress(s1, ctb_row++);
+    }
+
+    if (ctb_addr_ts < ctb_addr_ts_end) {
+        av_log(s->avctx, AV_LOG_ERROR, "Slice data ends within tile %d.\n", tile);
+        ret = AVERROR_INVALIDDATA;
+        goto fail;
+    }
+
+    return 0;
+error:
+    s->tab_slice_address[ctb_addr_rs] = -1;
+fail:
+    // unblock the loop filter pass
+    while (ctb_row < pps->row_bd[tile_y + 1])
+        hevc_report_tile_progress(s1, ctb_row++);
+    return ret;
+}
+
+/**
+ * Deblocking and SAO pass of tile-parallel decoding, run by the main thread
+ * in raster order once all the tiles crossing a CTB row have decoded it.
+ */
+static int hls_filter_tiles(AVCodecContext *avctxt)
+{
+    HEVCContext *s1    = avctxt->priv_data;
+    HEVCContext *s     = s1->tile_filter_ctx;
+    const HEVCSPS *sps = s->ps.sps;
+    int ctb_size       = 1 << sps->log2_ctb_size;
+    int x, y;
+
+    for (y = 0; y < sps->ctb_height; y++) {
+        hevc_await_tile_progress(s1, y, s->ps.pps->num_tile_columns);
+
+        if (!s->sh.disable_deblocking_filter_flag &&
+            s->ps.pps->loop_filter_across_tiles_enabled_flag)
+            for (x = 0; x < sps->ctb_width; x++)
+                ff_hevc_tile_boundary_strengths(s, x << sps->log2_ctb_size,
+                                                y << sps->log2_ctb_size);
+
+        for (x = 0; x < sps->ctb_width; x++)
+            ff_hevc_hls_filters(s, x << sps->log2_ctb_size,
+                                y << sps->log2_ctb_size, ctb_size);
+    }
+    ff_hevc_hls_filter(s, (sps->ctb_width  - 1) << sps->log2_ctb_size,
+                          (sps->ctb_height - 1) << sps->log2_ctb_size, ctb_size);
+
+    return 0;
+}
+
+static int hls_slice_data_tiles(HEVCContext *s, const H2645NAL *nal)
+{
+    int nb_tiles = s->sh.num_entry_point_offsets + 1;
+    int *ret     = av_malloc_array(nb_tiles, sizeof(int));
+    int i, res;
+
+    if (!ret)
+        return AVERROR(ENOMEM);
+
+    res = hevc_alloc_tile_progress(s, s->ps.sps->ctb_height);
+    if (res < 0)
+        goto error;
+
+    if (!s->tile_filter_ctx) {
+        s->tile_filter_ctx = av_malloc(sizeof(HEVCContext));
+        s->tile_filter_lc  = av_mallocz(sizeof(HEVCLocalContext));
+        if (!s->tile_filter_ctx || !s->tile_filter_lc) {
+            res = AVERROR(ENOMEM);
+            goto error;
+        }
+    }
+
+    for (i = 1; i < s->threads_number; i++) {
+        if (!s->sList[i]) {
+            s->sList[i]      = av_malloc(sizeof(HEVCContext));
+            s->HEVClcList[i] = av_mallocz(sizeof(HEVCLocalContext));
+            if (!s->sList[i] || !s->HEVClcList[i]) {
+                res = AVERROR(ENOMEM);
+                goto error;
+            }
+        }
+    }
+
+    res = hls_entry_points(s, nal);
+    if (res < 0)
+        goto error;
+    s->data = nal->data;
+
+    /* all the CTBs of the picture belong to this slice segment, mark them
+     * upfront so the neighbour availability does not depend on the order
+     * the tiles get decoded */
+    for (i = 0; i < s->ps.sps->ctb_size; i++)
+        s->tab_slice_address[i] = s->sh.slice_addr;
+
+    for (i = 1; i < s->threads_number; i++) {
+        s->HEVClcList[i]->first_qp_group = 1;
+        s->HEVClcList[i]->qp_y = s->HEVClc->qp_y;
+        memcpy(s->sList[i], s, sizeof(HEVCContext));
+        s->sList[i]->HEVClc = s->HEVClcList[i];
+    }
+    memcpy(s->tile_filter_ctx, s, sizeof(HEVCContext));
+    s->tile_filter_ctx->HEVClc = s->tile_filter_lc;
+
+    for (i = 0; i < nb_tiles; i++)
+        ret[i] = 0;
+
+    ff_slice_thread_execute_with_mainfunc(s->avctx, hls_decode_entry_tile,
+                                          hls_filter_tiles, NULL, ret, nb_tiles);
+
+    res = s->ps.sps->ctb_size;
+    for (i = 0; i < nb_tiles; i++) {
+        if (ret[i] < 0) {
+            res = ret[i];
+            break;
+        }
+    }
+error:
+    av_free(ret);
+    return res;
+}
+#endif
+
 static int set_side_data(HEVCContext *s)
 {
     AVFrame *out = s->ref->frame;
@@ -2979,6 +3226,11 @@ static int decode_nal_unit(HEVCContext *s, const H2645NAL *nal)
             if (ret < 0)
                 goto fail;
         } else {
+#if HAVE_THREADS
+            if (s->enable_parallel_tiles)
+                ctb_addr_ts = hls_slice_data_tiles(s, nal);
+            else
+#endif
             if (s->threads_number > 1 && s->sh.num_entry_point_offsets > 0)
                 ctb_addr_ts = hls_slice_data_wpp(s, nal);
             else
@@ -3305,6 +3557,11 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
             av_freep(&s->sList[i]);
         }
     }
+    av_freep(&s->tile_filter_ctx);
+    av_freep(&s->tile_filter_lc);
+#if HAVE_THREADS
+    hevc_free_tile_progress(s);
+#endif
     if (s->HEVClc == s->HEVClcList[0])
         s->HEVClc = NULL;
     av_freep(&s->HEVClcList[0]);
@@ -3541,7 +3798,9 @@ AVCodec ff_hevc_decoder = {
     .init_thread_copy      = ONLY_IF_THREADS_ENABLED(hevc_init_thread_copy),
     .capabilities          = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
                              AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS,
-    .caps_internal         = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_EXPORTS_CROPPING,
+    .caps_internal         = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_EXPORTS_CROPPING |
+                             FF_CODEC_CAP_SLICE_THREAD_HAS_MF |
+                             FF_CODEC_CAP_NESTED_SLICE_THREADS,
     .profiles              = NULL_IF_CONFIG_SMALL(ff_hevc_profiles),
     .hw_configs            = (const AVCodecHWConfigInternal*[]) {
 #if CONFIG_HEVC_DXVA2_HWACCEL
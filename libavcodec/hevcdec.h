@@ -27,6 +27,7 @@
 
 #include "libavutil/buffer.h"
 #include "libavutil/md5.h"
+#include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "bswapdsp.h"
@@ -471,6 +472,20 @@ typedef struct HEVCContext {
     int enable_parallel_tiles;
     atomic_int wpp_err;
 
+#if HAVE_THREADS
+    /**
+     * Tile-parallel decoding: number of tile columns decoded in each CTB
+     * row, consumed by the deblocking and SAO pass.
+     */
+    pthread_mutex_t tile_progress_mutex;
+    pthread_cond_t  tile_progress_cond;
+    atomic_int     *tile_progress;
+    int             nb_tile_progress;
+#endif
+    /** context of the deblocking and SAO pass of tile-parallel decoding */
+    struct HEVCContext *tile_filter_ctx;
+    HEVCLocalContext   *tile_filter_lc;
+
     const uint8_t *data;
 
     H2645Packet pkt;
@@ -590,6 +605,7 @@ void ff_hevc_set_qPy(HEVCContext *s, int xBase, int yBase,
                      int log2_cb_size);
 void ff_hevc_deblocking_boundary_strengths(HEVCContext *s, int x0, int y0,
                                            int log2_trafo_size);
+void ff_hevc_tile_boundary_strengths(HEVCContext *s, int x0, int y0);
 int ff_hevc_cu_qp_delta_sign_flag(HEVCContext *s);
 int ff_hevc_cu_qp_delta_abs(HEVCContext *s);
 int ff_hevc_cu_chroma_qp_offset_flag(HEVCContext *s);
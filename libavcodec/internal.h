@@ -68,6 +68,12 @@
  * Codec initializes slice-based threading with a main function
  */
 #define FF_CODEC_CAP_SLICE_THREAD_HAS_MF    (1 << 5)
+/**
+ * Frame threaded decoder that also supports slice threading inside each
+ * frame thread. It must only report frame progress for completely decoded
+ * rows while slices are decoded in parallel.
+ */
+#define FF_CODEC_CAP_NESTED_SLICE_THREADS   (1 << 6)
 
 #ifdef TRACE
 #   define ff_tlog(ctx, ...) av_log(ctx, AV_LOG_TRACE, __VA_ARGS__)
@@ -161,6 +167,11 @@ typedef struct AVCodecInternal {
     FramePool *pool;
 
     void *thread_ctx;
+    /**
+     * Slice threading context. Kept apart from thread_ctx so that the
+     * contexts of frame threads can run slice threads of their own.
+     */
+    void *slice_thread_ctx;
 
     DecodeSimpleContext ds;
     DecodeFilterContext filter;
@@ -218,6 +229,17 @@ typedef struct AVCodecInternal {
 
     /* to prevent infinite loop on errors when draining */
     int nb_draining_errors;
+
+    /* decoding statistics exported in decode_latency and decode_throughput */
+    int64_t decode_start_time;
+    int64_t submit_time;
+    int64_t decode_latency_sum;
+    int64_t nb_decoded_frames;
+    /* dts and submit time of the last packets taken by a receive_frame()
+     * decoder, matched against the pkt_dts of its frames */
+    int64_t submit_dts[16];
+    int64_t submit_times[16];
+    int nb_submits;
 } AVCodecInternal;
 
 struct AVCodecDefault {
@@ -126,6 +126,7 @@ typedef struct {
     Jpeg2000QuantStyle  qntsty;
 
     Jpeg2000Tile *tile;
+    int *tile_ret;              ///< per-tile tier-1 return codes
 
     int format;
     int pred;
@@ -413,6 +414,9 @@ static int init_tiles(Jpeg2000EncoderContext *s)
     s->tile = av_malloc_array(s->numXtiles, s->numYtiles * sizeof(Jpeg2000Tile));
     if (!s->tile)
         return AVERROR(ENOMEM);
+    s->tile_ret = av_malloc_array(s->numXtiles, s->numYtiles * sizeof(*s->tile_ret));
+    if (!s->tile_ret)
+        return AVERROR(ENOMEM);
     for (tileno = 0, tiley = 0; tiley < s->numYtiles; tiley++)
         for (tilex = 0; tilex < s->numXtiles; tilex++, tileno++){
             Jpeg2000Tile *tile = s->tile + tileno;
@@ -880,8 +884,15 @@ static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+/**
+ * DWT and tier-1 coding of all components of one tile.
+ * Tiles are coded independently of each other, so this runs as a slice
+ * threading job; tier-2 coding is done afterwards in tile order.
+ */
+static int encode_tile_t1(AVCodecContext *avctx, void *arg, int tileno, int threadnr)
 {
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    Jpeg2000Tile *tile = s->tile + tileno;
     int compno, reslevelno, bandno, ret;
     Jpeg2000T1Context t1;
     Jpeg2000CodingStyle *codsty = &s->codsty;
@@ -958,6 +969,12 @@ static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno
         }
         av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
     }
+    return 0;
+}
+
+static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+{
+    int ret;
 
     av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
     truncpasses(s, tile);
@@ -980,6 +997,7 @@ static void cleanup(Jpeg2000EncoderContext *s)
         av_freep(&s->tile[tileno].comp);
     }
     av_freep(&s->tile);
+    av_freep(&s->tile_ret);
 }
 
 static void reinit(Jpeg2000EncoderContext *s)
@@ -1106,6 +1124,11 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     if ((ret = put_com(s, 0)) < 0)
         return ret;
 
+    avctx->execute2(avctx, encode_tile_t1, NULL, s->tile_ret, s->numXtiles * s->numYtiles);
+    for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++)
+        if (s->tile_ret[tileno] < 0)
+            return s->tile_ret[tileno];
+
     for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++){
         uint8_t *psotptr;
         if (!(psotptr = put_sot(s, tileno)))
@@ -1250,6 +1273,8 @@ AVCodec ff_jpeg2000_encoder = {
     .init           = j2kenc_init,
     .encode2        = encode_frame,
     .close          = j2kenc_destroy,
+    .capabilities   = AV_CODEC_CAP_SLICE_THREADS | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_INTRA_ONLY,
     .pix_fmts       = (const enum AVPixelFormat[]) {
         AV_PIX_FMT_RGB24, AV_PIX_FMT_YUV444P, AV_PIX_FMT_GRAY8,
         AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P,
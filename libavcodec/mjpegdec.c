@@ -30,6 +30,8 @@
  * MJPEG decoder.
  */
 
+#include <stdatomic.h>
+
 #include "libavutil/imgutils.h"
 #include "libavutil/avassert.h"
 #include "libavutil/opt.h"
@@ -192,6 +194,14 @@ av_cold int ff_mjpeg_decode_init(AVCodecContext *avctx)
     if (avctx->codec->id == AV_CODEC_ID_AMV)
         s->flipped = 1;
 
+#if HAVE_THREADS
+    if (avctx->active_thread_type & FF_THREAD_SLICE && !s->slice_ctx) {
+        s->slice_ctx = av_mallocz_array(avctx->thread_count, sizeof(*s->slice_ctx));
+        if (!s->slice_ctx)
+            return AVERROR(ENOMEM);
+    }
+#endif
+
     return 0;
 }
 
@@ -1354,28 +1364,17 @@ static void shift_output(MJpegDecodeContext *s, uint8_t *ptr, int linesize)
     }
 }
 
-static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
-                             int Al, const uint8_t *mb_bitmask,
-                             int mb_bitmask_size,
-                             const AVFrame *reference)
+/* Decode the MCUs [mcu_start, mcu_end) of a scan in raster order. */
+static int decode_mcu_range(MJpegDecodeContext *s, int nb_components, int Ah,
+                            int Al, GetBitContext *mb_bitmask_gb,
+                            const AVFrame *reference, int mcu_start, int mcu_end)
 {
-    int i, mb_x, mb_y, chroma_h_shift, chroma_v_shift, chroma_width, chroma_height;
+    int i, mcu, mb_x, mb_y, chroma_h_shift, chroma_v_shift, chroma_width, chroma_height;
     uint8_t *data[MAX_COMPONENTS];
     const uint8_t *reference_data[MAX_COMPONENTS];
     int linesize[MAX_COMPONENTS];
-    GetBitContext mb_bitmask_gb = {0}; // initialize to silence gcc warning
     int bytes_per_pixel = 1 + (s->bits > 8);
 
-    if (mb_bitmask) {
-        if (mb_bitmask_size != (s->mb_width * s->mb_height + 7)>>3) {
-            av_log(s->avctx, AV_LOG_ERROR, "mb_bitmask_size mismatches\n");
-            return AVERROR_INVALIDDATA;
-        }
-        init_get_bits(&mb_bitmask_gb, mb_bitmask, s->mb_width * s->mb_height);
-    }
-
-    s->restart_count = 0;
-
     av_pix_fmt_get_chroma_sub_sample(s->avctx->pix_fmt, &chroma_h_shift,
                                      &chroma_v_shift);
     chroma_width  = AV_CEIL_RSHIFT(s->width,  chroma_h_shift);
@@ -1386,95 +1385,215 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
         data[c] = s->picture_ptr->data[c];
         reference_data[c] = reference ? reference->data[c] : NULL;
         linesize[c] = s->linesize[c];
-        s->coefs_finished[c] |= 1;
     }
 
-    for (mb_y = 0; mb_y < s->mb_height; mb_y++) {
-        for (mb_x = 0; mb_x < s->mb_width; mb_x++) {
-            const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
+    mb_x = mcu_start % s->mb_width;
+    mb_y = mcu_start / s->mb_width;
+    for (mcu = mcu_start; mcu < mcu_end; mcu++) {
+        const int copy_mb = mb_bitmask_gb && !get_bits1(mb_bitmask_gb);
 
-            if (s->restart_interval && !s->restart_count)
-                s->restart_count = s->restart_interval;
+        if (s->restart_interval && !s->restart_count)
+            s->restart_count = s->restart_interval;
 
-            if (get_bits_left(&s->gb) < 0) {
-                av_log(s->avctx, AV_LOG_ERROR, "overread %d\n",
-                       -get_bits_left(&s->gb));
-                return AVERROR_INVALIDDATA;
-            }
-            for (i = 0; i < nb_components; i++) {
-                uint8_t *ptr;
-                int n, h, v, x, y, c, j;
-                int block_offset;
-                n = s->nb_blocks[i];
-                c = s->comp_index[i];
-                h = s->h_scount[i];
-                v = s->v_scount[i];
-                x = 0;
-                y = 0;
-                for (j = 0; j < n; j++) {
-                    block_offset = (((linesize[c] * (v * mb_y + y) * 8) +
-                                     (h * mb_x + x) * 8 * bytes_per_pixel) >> s->avctx->lowres);
-
-                    if (s->interlaced && s->bottom_field)
-                        block_offset += linesize[c] >> 1;
-                    if (   8*(h * mb_x + x) < ((c == 1) || (c == 2) ? chroma_width  : s->width)
-                        && 8*(v * mb_y + y) < ((c == 1) || (c == 2) ? chroma_height : s->height)) {
-                        ptr = data[c] + block_offset;
-                    } else
-                        ptr = NULL;
-                    if (!s->progressive) {
-                        if (copy_mb) {
-                            if (ptr)
-                                mjpeg_copy_block(s, ptr, reference_data[c] + block_offset,
-                                                linesize[c], s->avctx->lowres);
+        if (get_bits_left(&s->gb) < 0) {
+            av_log(s->avctx, AV_LOG_ERROR, "overread %d\n",
+                   -get_bits_left(&s->gb));
+            return AVERROR_INVALIDDATA;
+        }
+        for (i = 0; i < nb_components; i++) {
+            uint8_t *ptr;
+            int n, h, v, x, y, c, j;
+            int block_offset;
+            n = s->nb_blocks[i];
+            c = s->comp_index[i];
+            h = s->h_scount[i];
+            v = s->v_scount[i];
+            x = 0;
+            y = 0;
+            for (j = 0; j < n; j++) {
+                block_offset = (((linesize[c] * (v * mb_y + y) * 8) +
+                                 (h * mb_x + x) * 8 * bytes_per_pixel) >> s->avctx->lowres);
+
+                if (s->interlaced && s->bottom_field)
+                    block_offset += linesize[c] >> 1;
+                if (   8*(h * mb_x + x) < ((c == 1) || (c == 2) ? chroma_width  : s->width)
+                    && 8*(v * mb_y + y) < ((c == 1) || (c == 2) ? chroma_height : s->height)) {
+                    ptr = data[c] + block_offset;
+                } else
+                    ptr = NULL;
+                if (!s->progressive) {
+                    if (copy_mb) {
+                        if (ptr)
+                            mjpeg_copy_block(s, ptr, reference_data[c] + block_offset,
+                                            linesize[c], s->avctx->lowres);
 
-                        } else {
-                            s->bdsp.clear_block(s->block);
-                            if (decode_block(s, s->block, i,
-                                             s->dc_index[i], s->ac_index[i],
-                                             s->quant_matrixes[s->quant_sindex[i]]) < 0) {
-                                av_log(s->avctx, AV_LOG_ERROR,
-                                       "error y=%d x=%d\n", mb_y, mb_x);
-                                return AVERROR_INVALIDDATA;
-                            }
-                            if (ptr) {
-                                s->idsp.idct_put(ptr, linesize[c], s->block);
-                                if (s->bits & 7)
-                                    shift_output(s, ptr, linesize[c]);
-                            }
-                        }
                     } else {
-                        int block_idx  = s->block_stride[c] * (v * mb_y + y) +
-                                         (h * mb_x + x);
-                        int16_t *block = s->blocks[c][block_idx];
-                        if (Ah)
-                            block[0] += get_bits1(&s->gb) *
-                                        s->quant_matrixes[s->quant_sindex[i]][0] << Al;
-                        else if (decode_dc_progressive(s, block, i, s->dc_index[i],
-                                                       s->quant_matrixes[s->quant_sindex[i]],
-                                                       Al) < 0) {
+                        s->bdsp.clear_block(s->block);
+                        if (decode_block(s, s->block, i,
+                                         s->dc_index[i], s->ac_index[i],
+                                         s->quant_matrixes[s->quant_sindex[i]]) < 0) {
                             av_log(s->avctx, AV_LOG_ERROR,
                                    "error y=%d x=%d\n", mb_y, mb_x);
                             return AVERROR_INVALIDDATA;
                         }
+                        if (ptr) {
+                            s->idsp.idct_put(ptr, linesize[c], s->block);
+                            if (s->bits & 7)
+                                shift_output(s, ptr, linesize[c]);
+                        }
                     }
-                    ff_dlog(s->avctx, "mb: %d %d processed\n", mb_y, mb_x);
-                    ff_dlog(s->avctx, "%d %d %d %d %d %d %d %d \n",
-                            mb_x, mb_y, x, y, c, s->bottom_field,
-                            (v * mb_y + y) * 8, (h * mb_x + x) * 8);
-                    if (++x == h) {
-                        x = 0;
-                        y++;
+                } else {
+                    int block_idx  = s->block_stride[c] * (v * mb_y + y) +
+                                     (h * mb_x + x);
+                    int16_t *block = s->blocks[c][block_idx];
+                    if (Ah)
+                        block[0] += get_bits1(&s->gb) *
+                                    s->quant_matrixes[s->quant_sindex[i]][0] << Al;
+                    else if (decode_dc_progressive(s, block, i, s->dc_index[i],
+                                                   s->quant_matrixes[s->quant_sindex[i]],
+                                                   Al) < 0) {
+                        av_log(s->avctx, AV_LOG_ERROR,
+                               "error y=%d x=%d\n", mb_y, mb_x);
+                        return AVERROR_INVALIDDATA;
                     }
                 }
+                ff_dlog(s->avctx, "mb: %d %d processed\n", mb_y, mb_x);
+                ff_dlog(s->avctx, "%d %d %d %d %d %d %d %d \n",
+                        mb_x, mb_y, x, y, c, s->bottom_field,
+                        (v * mb_y + y) * 8, (h * mb_x + x) * 8);
+                if (++x == h) {
+                    x = 0;
+                    y++;
+                }
             }
+        }
+
+        handle_rstn(s, nb_components);
 
-            handle_rstn(s, nb_components);
+        if (++mb_x == s->mb_width) {
+            mb_x = 0;
+            mb_y++;
         }
     }
     return 0;
 }
 
+#if HAVE_THREADS
+typedef struct RestartScanContext {
+    int nb_components;
+    int Ah, Al;
+    int scan_start;         ///< byte offset of the entropy coded data in s->gb
+    int first_marker;       ///< index of the first restart marker of the scan
+    int end_bits;           ///< bit position in s->gb after the last segment
+    atomic_int error;
+} RestartScanContext;
+
+/* Decode one restart interval into a private copy of the context: every
+ * interval starts byte aligned with reset DC predictors, so the intervals
+ * of a scan are independent of each other. */
+static int decode_restart_interval(AVCodecContext *avctx, void *arg,
+                                   int jobnr, int threadnr)
+{
+    MJpegDecodeContext *s  = avctx->priv_data;
+    MJpegDecodeContext *sc = &s->slice_ctx[threadnr];
+    RestartScanContext *rc = arg;
+    int nb_mcus = s->mb_width * s->mb_height;
+    int start   = jobnr * s->restart_interval;
+    int end     = FFMIN(start + s->restart_interval, nb_mcus);
+    int offset  = jobnr ? s->restart_offsets[rc->first_marker + jobnr - 1]
+                        : rc->scan_start;
+    int i, ret;
+
+    memcpy(sc, s, sizeof(*sc));
+    ret = init_get_bits8(&sc->gb, s->gb.buffer + offset,
+                         (s->gb.size_in_bits >> 3) - offset);
+    if (ret < 0)
+        goto fail;
+    for (i = 0; i < rc->nb_components; i++)
+        sc->last_dc[i] = (4 << s->bits);
+    sc->restart_count = 0;
+
+    ret = decode_mcu_range(sc, rc->nb_components, rc->Ah, rc->Al, NULL, NULL,
+                           start, end);
+    emms_c();
+    if (ret < 0)
+        goto fail;
+
+    if (end == nb_mcus)
+        rc->end_bits = offset * 8 + get_bits_count(&sc->gb);
+    return 0;
+fail:
+    atomic_store(&rc->error, ret);
+    return ret;
+}
+
+static int decode_scan_threaded(MJpegDecodeContext *s, int nb_components,
+                                int Ah, int Al)
+{
+    RestartScanContext rc = {
+        .nb_components = nb_components,
+        .Ah            = Ah,
+        .Al            = Al,
+        .scan_start    = get_bits_count(&s->gb) >> 3,
+        .end_bits      = -1,
+    };
+    int nb_intervals = (s->mb_width * s->mb_height + s->restart_interval - 1) /
+                       s->restart_interval;
+
+    /* the interval boundaries come from the restart markers found while
+     * unescaping the scan; without all of them, decode serially */
+    if (nb_intervals < 2 || (get_bits_count(&s->gb) & 7))
+        return AVERROR(EAGAIN);
+    while (rc.first_marker < s->nb_restart_offsets &&
+           s->restart_offsets[rc.first_marker] <= rc.scan_start)
+        rc.first_marker++;
+    if (s->nb_restart_offsets - rc.first_marker < nb_intervals - 1)
+        return AVERROR(EAGAIN);
+
+    atomic_init(&rc.error, 0);
+    s->avctx->execute2(s->avctx, decode_restart_interval, &rc, NULL,
+                       nb_intervals);
+
+    if (rc.end_bits >= 0)
+        skip_bits_long(&s->gb, rc.end_bits - get_bits_count(&s->gb));
+    return atomic_load(&rc.error);
+}
+#endif
+
+static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
+                             int Al, const uint8_t *mb_bitmask,
+                             int mb_bitmask_size,
+                             const AVFrame *reference)
+{
+    GetBitContext mb_bitmask_gb = {0}; // initialize to silence gcc warning
+    int i;
+
+    if (mb_bitmask) {
+        if (mb_bitmask_size != (s->mb_width * s->mb_height + 7)>>3) {
+            av_log(s->avctx, AV_LOG_ERROR, "mb_bitmask_size mismatches\n");
+            return AVERROR_INVALIDDATA;
+        }
+        init_get_bits(&mb_bitmask_gb, mb_bitmask, s->mb_width * s->mb_height);
+    }
+
+    s->restart_count = 0;
+
+    for (i = 0; i < nb_components; i++)
+        s->coefs_finished[s->comp_index[i]] |= 1;
+
+#if HAVE_THREADS
+    if (s->slice_ctx && s->restart_interval && !s->progressive && !mb_bitmask) {
+        int ret = decode_scan_threaded(s, nb_components, Ah, Al);
+        if (ret != AVERROR(EAGAIN))
+            return ret;
+    }
+#endif
+
+    return decode_mcu_range(s, nb_components, Ah, Al,
+                            mb_bitmask ? &mb_bitmask_gb : NULL, reference,
+                            0, s->mb_width * s->mb_height);
+}
+
 static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss,
                                             int se, int Ah, int Al)
 {
@@ -2143,6 +2262,11 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
         const uint8_t *src = *buf_ptr;
         const uint8_t *ptr = src;
         uint8_t *dst = s->buffer;
+        /* restart marker positions are only needed to split the scan
+         * between slice threads */
+        int record_rst = !!s->slice_ctx;
+
+        s->nb_restart_offsets = 0;
 
         #define copy_data_segment(skip) do {       \
             ptrdiff_t length = (ptr - src) - (skip);  \
@@ -2181,6 +2305,18 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                         copy_data_segment(1);
                         if (x)
                             break;
+                    } else if (record_rst) {
+                        /* the marker is copied along with the data around it */
+                        int offset = dst - s->buffer + (ptr - src);
+                        int *tmp   = av_fast_realloc(s->restart_offsets,
+                                                     &s->restart_offsets_size,
+                                                     (s->nb_restart_offsets + 1) * sizeof(*tmp));
+                        if (tmp) {
+                            s->restart_offsets = tmp;
+                            s->restart_offsets[s->nb_restart_offsets++] = offset;
+                        } else {
+                            record_rst = 0;
+                        }
                     }
                 }
             }
@@ -2755,6 +2891,8 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
         av_frame_unref(s->picture_ptr);
 
     av_freep(&s->buffer);
+    av_freep(&s->restart_offsets);
+    av_freep(&s->slice_ctx);
     av_freep(&s->stereo3d);
     av_freep(&s->ljpeg_buffer);
     s->ljpeg_buffer_size = 0;
@@ -2808,7 +2946,7 @@ AVCodec ff_mjpeg_decoder = {
     .close          = ff_mjpeg_decode_end,
     .decode         = ff_mjpeg_decode_frame,
     .flush          = decode_flush,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_SLICE_THREADS,
     .max_lowres     = 3,
     .priv_class     = &mjpegdec_class,
     .profiles       = NULL_IF_CONFIG_SMALL(ff_mjpeg_profiles),
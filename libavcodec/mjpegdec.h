@@ -114,6 +114,11 @@ typedef struct MJpegDecodeContext {
     int restart_interval;
     int restart_count;
 
+    int *restart_offsets;             ///< offsets of the data following each RSTn marker of the current scan buffer
+    unsigned int restart_offsets_size;
+    int nb_restart_offsets;
+    struct MJpegDecodeContext *slice_ctx; ///< per-thread context copies for slice threading
+
     int buggy_avid;
     int cs_itu601;
     int interlace_polarity;
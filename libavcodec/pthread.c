@@ -39,7 +39,8 @@
  *
  * Threading requires more than one thread.
  * Frame threading requires entire frames to be passed to the codec,
- * and introduces extra decoding delay, so is incompatible with low_delay.
+ * and introduces extra decoding delay, so is incompatible with low_delay
+ * and a max_thread_delay of 0.
  *
  * @param avctx The context.
  */
@@ -48,7 +49,8 @@ static void validate_thread_parameters(AVCodecContext *avctx)
     int frame_threading_supported = (avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
                                 && !(avctx->flags  & AV_CODEC_FLAG_TRUNCATED)
                                 && !(avctx->flags  & AV_CODEC_FLAG_LOW_DELAY)
-                                && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS);
+                                && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS)
+                                && avctx->max_thread_delay != 0;
     if (avctx->thread_count == 1) {
         avctx->active_thread_type = 0;
     } else if (frame_threading_supported && (avctx->thread_type & FF_THREAD_FRAME)) {
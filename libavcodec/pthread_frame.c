@@ -82,6 +82,7 @@ typedef struct PerThreadContext {
     AVCodecContext *avctx;          ///< Context used to decode packets passed to this thread.
 
     AVPacket       avpkt;           ///< Input packet (for decoding) or output (for encoding).
+    int64_t        submit_time;     ///< Time avpkt was submitted, for the decoding statistics.
 
     AVFrame *frame;                 ///< Output frame (for decoding) or input (for encoding).
     int     got_frame;              ///< The output of got_picture_ptr from the last avcodec_decode_video() call.
@@ -299,7 +300,7 @@ static int update_context_from_thread(AVCodecContext *dst, AVCodecContext *src,
     }
 
     if (for_user) {
-        dst->delay       = src->thread_count - 1;
+        dst->delay       = dst->thread_count - 1;
 #if FF_API_CODED_FRAME
 FF_DISABLE_DEPRECATION_WARNINGS
         dst->coded_frame = src->coded_frame;
@@ -424,6 +425,7 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
         av_log(p->avctx, AV_LOG_ERROR, "av_packet_ref() failed in submit_packet()\n");
         return ret;
     }
+    p->submit_time = user_avctx->internal->submit_time;
 
     atomic_store(&p->state, STATE_SETTING_UP);
     pthread_cond_signal(&p->input_cond);
@@ -526,6 +528,7 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         av_frame_move_ref(picture, p->frame);
         *got_picture_ptr = p->got_frame;
         picture->pkt_dts = p->avpkt.dts;
+        avctx->internal->submit_time = p->submit_time;
         err = p->result;
 
         /*
@@ -678,6 +681,8 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
 
         if (codec->close && p->avctx)
             codec->close(p->avctx);
+        if (p->avctx && p->avctx->internal)
+            ff_slice_thread_free(p->avctx);
 
         release_delayed_buffers(p);
         av_frame_free(&p->frame);
@@ -723,6 +728,7 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
 int ff_frame_thread_init(AVCodecContext *avctx)
 {
     int thread_count = avctx->thread_count;
+    int slice_thread_count = 1;
     const AVCodec *codec = avctx->codec;
     AVCodecContext *src = avctx;
     FrameThreadContext *fctx;
@@ -741,6 +747,15 @@ int ff_frame_thread_init(AVCodecContext *avctx)
             thread_count = avctx->thread_count = 1;
     }
 
+    if (avctx->max_thread_delay > 0 && thread_count > avctx->max_thread_delay + 1) {
+        // spend the threads the delay does not allow on slice threads
+        if (codec->caps_internal & FF_CODEC_CAP_NESTED_SLICE_THREADS &&
+            codec->capabilities & AV_CODEC_CAP_SLICE_THREADS &&
+            avctx->thread_type & FF_THREAD_SLICE)
+            slice_thread_count = thread_count / (avctx->max_thread_delay + 1);
+        thread_count = avctx->thread_count = avctx->max_thread_delay + 1;
+    }
+
     if (thread_count <= 1) {
         avctx->active_thread_type = 0;
         return 0;
@@ -799,8 +814,14 @@ int ff_frame_thread_init(AVCodecContext *avctx)
         }
         *copy->internal = *src->internal;
         copy->internal->thread_ctx = p;
+        copy->internal->slice_thread_ctx = NULL;
         copy->internal->last_pkt_props = &p->avpkt;
 
+        if (slice_thread_count > 1) {
+            copy->thread_count       = slice_thread_count;
+            copy->active_thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+
         if (!i) {
             src = copy;
 
@@ -823,6 +844,15 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
         if (err) goto error;
 
+        if (slice_thread_count > 1) {
+            err = ff_slice_thread_init(copy);
+            if (err >= 0 && !(copy->active_thread_type & FF_THREAD_SLICE))
+                err = AVERROR(ENOMEM);
+            if (err < 0)
+                goto error;
+            copy->active_thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        }
+
         atomic_init(&p->debug_threads, (copy->debug & FF_DEBUG_THREADS) != 0);
 
         err = AVERROR(pthread_create(&p->thread, NULL, frame_worker_thread, p));
@@ -49,6 +49,30 @@
 #include "thread.h"
 #include "get_bits.h"
 
+/**
+ * Decompression state and scratch buffers of one slice thread.
+ */
+typedef struct TiffThreadContext {
+    LZWState *lzw;
+
+    uint8_t *deinvert_buf;
+    int deinvert_buf_size;
+    uint8_t *yuv_line;
+    unsigned int yuv_line_size;
+    uint8_t *fax_buffer;
+    unsigned int fax_buffer_size;
+    uint8_t *tile_buf;
+    unsigned int tile_buf_size;
+} TiffThreadContext;
+
+/**
+ * Location of one strip or tile in the packet.
+ */
+typedef struct TiffStrip {
+    const uint8_t *src;
+    unsigned size;
+} TiffStrip;
+
 typedef struct TiffContext {
     AVClass *class;
     AVCodecContext *avctx;
@@ -79,14 +103,21 @@ typedef struct TiffContext {
     int strips, rps, sstype;
     int sot;
     int stripsizesoff, stripsize, stripoff, strippos;
-    LZWState *lzw;
 
-    uint8_t *deinvert_buf;
-    int deinvert_buf_size;
-    uint8_t *yuv_line;
-    unsigned int yuv_line_size;
-    uint8_t *fax_buffer;
-    unsigned int fax_buffer_size;
+    int is_tiled;
+    int tile_width, tile_length;
+    int tiles_x, tiles_y;
+    int tile_stride;
+
+    AVFrame *frame;
+    TiffStrip *strip_table;
+    unsigned int strip_table_size;
+    int *strip_ret;
+    unsigned int strip_ret_size;
+    int nb_jobs_per_plane;
+
+    TiffThreadContext *thread_ctx;
+    int nb_thread_ctx;
 
     int geotag_count;
     TiffGeoTag *geotags;
@@ -297,15 +328,15 @@ static void av_always_inline horizontal_fill(TiffContext *s,
     }
 }
 
-static int deinvert_buffer(TiffContext *s, const uint8_t *src, int size)
+static int deinvert_buffer(TiffThreadContext *td, const uint8_t *src, int size)
 {
     int i;
 
-    av_fast_padded_malloc(&s->deinvert_buf, &s->deinvert_buf_size, size);
-    if (!s->deinvert_buf)
+    av_fast_padded_malloc(&td->deinvert_buf, &td->deinvert_buf_size, size);
+    if (!td->deinvert_buf)
         return AVERROR(ENOMEM);
     for (i = 0; i < size; i++)
-        s->deinvert_buf[i] = ff_reverse[src[i]];
+        td->deinvert_buf[i] = ff_reverse[src[i]];
 
     return 0;
 }
@@ -373,7 +404,8 @@ static int tiff_uncompress(uint8_t *dst, unsigned long *len, const uint8_t *src,
     return zret == Z_STREAM_END ? Z_OK : zret;
 }
 
-static int tiff_unpack_zlib(TiffContext *s, AVFrame *p, uint8_t *dst, int stride,
+static int tiff_unpack_zlib(TiffContext *s, TiffThreadContext *td, AVFrame *p,
+                            uint8_t *dst, int stride,
                             const uint8_t *src, int size, int width, int lines,
                             int strip_start, int is_yuv)
 {
@@ -385,11 +417,11 @@ static int tiff_unpack_zlib(TiffContext *s, AVFrame *p, uint8_t *dst, int stride
     if (!zbuf)
         return AVERROR(ENOMEM);
     if (s->fill_order) {
-        if ((ret = deinvert_buffer(s, src, size)) < 0) {
+        if ((ret = deinvert_buffer(td, src, size)) < 0) {
             av_free(zbuf);
             return ret;
         }
-        src = s->deinvert_buf;
+        src = td->deinvert_buf;
     }
     ret = tiff_uncompress(zbuf, &outlen, src, size);
     if (ret != Z_OK) {
@@ -440,7 +472,8 @@ static int tiff_uncompress_lzma(uint8_t *dst, uint64_t *len, const uint8_t *src,
     return ret == LZMA_STREAM_END ? LZMA_OK : ret;
 }
 
-static int tiff_unpack_lzma(TiffContext *s, AVFrame *p, uint8_t *dst, int stride,
+static int tiff_unpack_lzma(TiffContext *s, TiffThreadContext *td, AVFrame *p,
+                            uint8_t *dst, int stride,
                             const uint8_t *src, int size, int width, int lines,
                             int strip_start, int is_yuv)
 {
@@ -450,11 +483,11 @@ static int tiff_unpack_lzma(TiffContext *s, AVFrame *p, uint8_t *dst, int stride
     if (!buf)
         return AVERROR(ENOMEM);
     if (s->fill_order) {
-        if ((ret = deinvert_buffer(s, src, size)) < 0) {
+        if ((ret = deinvert_buffer(td, src, size)) < 0) {
             av_free(buf);
             return ret;
         }
-        src = s->deinvert_buf;
+        src = td->deinvert_buf;
     }
     ret = tiff_uncompress_lzma(buf, &outlen, src, size);
     if (ret != LZMA_OK) {
@@ -483,15 +516,16 @@ static int tiff_unpack_lzma(TiffContext *s, AVFrame *p, uint8_t *dst, int stride
 }
 #endif
 
-static int tiff_unpack_fax(TiffContext *s, uint8_t *dst, int stride,
+static int tiff_unpack_fax(TiffContext *s, TiffThreadContext *td,
+                           uint8_t *dst, int stride,
                            const uint8_t *src, int size, int width, int lines)
 {
     int i, ret = 0;
     int line;
     uint8_t *src2;
 
-    av_fast_padded_malloc(&s->fax_buffer, &s->fax_buffer_size, size);
-    src2 = s->fax_buffer;
+    av_fast_padded_malloc(&td->fax_buffer, &td->fax_buffer_size, size);
+    src2 = td->fax_buffer;
 
     if (!src2) {
         av_log(s->avctx, AV_LOG_ERROR,
@@ -516,13 +550,16 @@ static int tiff_unpack_fax(TiffContext *s, uint8_t *dst, int stride,
     return ret;
 }
 
-static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int stride,
-                             const uint8_t *src, int size, int strip_start, int lines)
+static int tiff_unpack_strip(TiffContext *s, TiffThreadContext *td, AVFrame *p,
+                             uint8_t *dst, int stride,
+                             const uint8_t *src, int size, int strip_start,
+                             int lines, int strip_width)
 {
+    GetByteContext gb;
     PutByteContext pb;
     int c, line, pixels, code, ret;
     const uint8_t *ssrc = src;
-    int width = ((s->width * s->bpp) + 7) >> 3;
+    int width = ((strip_width * s->bpp) + 7) >> 3;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(p->format);
     int is_yuv = !(desc->flags & AV_PIX_FMT_FLAG_RGB) &&
                  (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
@@ -537,12 +574,12 @@ static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int strid
     if (is_yuv) {
         int bytes_per_row = (((s->width - 1) / s->subsampling[0] + 1) * s->bpp *
                             s->subsampling[0] * s->subsampling[1] + 7) >> 3;
-        av_fast_padded_malloc(&s->yuv_line, &s->yuv_line_size, bytes_per_row);
-        if (s->yuv_line == NULL) {
+        av_fast_padded_malloc(&td->yuv_line, &td->yuv_line_size, bytes_per_row);
+        if (td->yuv_line == NULL) {
             av_log(s->avctx, AV_LOG_ERROR, "Not enough memory\n");
             return AVERROR(ENOMEM);
         }
-        dst = s->yuv_line;
+        dst = td->yuv_line;
         stride = 0;
 
         width = (s->width - 1) / s->subsampling[0] + 1;
@@ -551,21 +588,21 @@ static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int strid
         av_assert0(s->bpp == 24);
     }
     if (s->is_bayer) {
-        width = (s->bpp * s->width + 7) >> 3;
+        width = (s->bpp * strip_width + 7) >> 3;
     }
     if (p->format == AV_PIX_FMT_GRAY12) {
-        av_fast_padded_malloc(&s->yuv_line, &s->yuv_line_size, width);
-        if (s->yuv_line == NULL) {
+        av_fast_padded_malloc(&td->yuv_line, &td->yuv_line_size, width);
+        if (td->yuv_line == NULL) {
             av_log(s->avctx, AV_LOG_ERROR, "Not enough memory\n");
             return AVERROR(ENOMEM);
         }
-        dst = s->yuv_line;
+        dst = td->yuv_line;
         stride = 0;
     }
 
     if (s->compr == TIFF_DEFLATE || s->compr == TIFF_ADOBE_DEFLATE) {
 #if CONFIG_ZLIB
-        return tiff_unpack_zlib(s, p, dst, stride, src, size, width, lines,
+        return tiff_unpack_zlib(s, td, p, dst, stride, src, size, width, lines,
                                 strip_start, is_yuv);
 #else
         av_log(s->avctx, AV_LOG_ERROR,
@@ -576,7 +613,7 @@ static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int strid
     }
     if (s->compr == TIFF_LZMA) {
 #if CONFIG_LZMA
-        return tiff_unpack_lzma(s, p, dst, stride, src, size, width, lines,
+        return tiff_unpack_lzma(s, td, p, dst, stride, src, size, width, lines,
                                 strip_start, is_yuv);
 #else
         av_log(s->avctx, AV_LOG_ERROR,
@@ -586,19 +623,19 @@ static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int strid
     }
     if (s->compr == TIFF_LZW) {
         if (s->fill_order) {
-            if ((ret = deinvert_buffer(s, src, size)) < 0)
+            if ((ret = deinvert_buffer(td, src, size)) < 0)
                 return ret;
-            ssrc = src = s->deinvert_buf;
+            ssrc = src = td->deinvert_buf;
         }
         if (size > 1 && !src[0] && (src[1]&1)) {
             av_log(s->avctx, AV_LOG_ERROR, "Old style LZW is unsupported\n");
         }
-        if ((ret = ff_lzw_decode_init(s->lzw, 8, src, size, FF_LZW_TIFF)) < 0) {
+        if ((ret = ff_lzw_decode_init(td->lzw, 8, src, size, FF_LZW_TIFF)) < 0) {
             av_log(s->avctx, AV_LOG_ERROR, "Error initializing LZW decoder\n");
             return ret;
         }
         for (line = 0; line < lines; line++) {
-            pixels = ff_lzw_decode(s->lzw, dst, width);
+            pixels = ff_lzw_decode(td->lzw, dst, width);
             if (pixels < width) {
                 av_log(s->avctx, AV_LOG_ERROR, "Decoded only %i bytes of %i\n",
                        pixels, width);
@@ -622,11 +659,11 @@ static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int strid
         if (is_yuv || p->format == AV_PIX_FMT_GRAY12)
             return AVERROR_INVALIDDATA;
 
-        return tiff_unpack_fax(s, dst, stride, src, size, width, lines);
+        return tiff_unpack_fax(s, td, dst, stride, src, size, width, lines);
     }
 
-    bytestream2_init(&s->gb, src, size);
-    bytestream2_init_writer(&pb, dst, is_yuv ? s->yuv_line_size : (stride * lines));
+    bytestream2_init(&gb, src, size);
+    bytestream2_init_writer(&pb, dst, is_yuv ? td->yuv_line_size : (stride * lines));
 
     for (line = 0; line < lines; line++) {
         if (src - ssrc > size) {
@@ -634,7 +671,7 @@ static int tiff_unpack_strip(TiffContext *s, AVFrame *p, uint8_t *dst, int strid
             return AVERROR_INVALIDDATA;
         }
 
-        if (bytestream2_get_bytes_left(&s->gb) == 0 || bytestream2_get_eof(&pb))
+        if (bytestream2_get_bytes_left(&gb) == 0 || bytestream2_get_eof(&pb))
             break;
         bytestream2_seek_p(&pb, stride * line, SEEK_SET);
         switch (s->compr) {
@@ -1029,6 +1066,8 @@ static int tiff_decode_tag(TiffContext *s, AVFrame *frame)
         s->rps = FFMIN(value, s->height);
         break;
     case TIFF_STRIP_OFFS:
+    case TIFF_TILE_OFFSETS:
+        s->is_tiled |= tag == TIFF_TILE_OFFSETS;
         if (count == 1) {
             if (value > INT_MAX) {
                 av_log(s->avctx, AV_LOG_ERROR,
@@ -1045,6 +1084,8 @@ static int tiff_decode_tag(TiffContext *s, AVFrame *frame)
         s->sot = type;
         break;
     case TIFF_STRIP_SIZE:
+    case TIFF_TILE_BYTE_COUNTS:
+        s->is_tiled |= tag == TIFF_TILE_BYTE_COUNTS;
         if (count == 1) {
             if (value > INT_MAX) {
                 av_log(s->avctx, AV_LOG_ERROR,
@@ -1064,12 +1105,19 @@ static int tiff_decode_tag(TiffContext *s, AVFrame *frame)
     case TIFF_YRES:
         set_sar(s, tag, value, value2);
         break;
-    case TIFF_TILE_BYTE_COUNTS:
-    case TIFF_TILE_LENGTH:
-    case TIFF_TILE_OFFSETS:
     case TIFF_TILE_WIDTH:
-        av_log(s->avctx, AV_LOG_ERROR, "Tiled images are not supported\n");
-        return AVERROR_PATCHWELCOME;
+        if (value > INT_MAX) {
+            av_log(s->avctx, AV_LOG_ERROR, "tile width %u too large\n", value);
+            return AVERROR_INVALIDDATA;
+        }
+        s->tile_width = value;
+        break;
+    case TIFF_TILE_LENGTH:
+        if (value > INT_MAX) {
+            av_log(s->avctx, AV_LOG_ERROR, "tile length %u too large\n", value);
+            return AVERROR_INVALIDDATA;
+        }
+        s->tile_length = value;
         break;
     case TIFF_PREDICTOR:
         s->predictor = value;
@@ -1342,6 +1390,161 @@ end:
     return 0;
 }
 
+/**
+ * Return the size in bytes of width decoded pixels of one plane.
+ */
+static int tiff_row_bytes(TiffContext *s, int width)
+{
+    int bytes;
+
+    if (s->bpp < 8 && s->avctx->pix_fmt == AV_PIX_FMT_PAL8)
+        return width;
+    bytes = ((int64_t)width * s->bpp + 7) >> 3;
+    if (s->planar)
+        bytes /= s->bppcount;
+    return bytes;
+}
+
+/**
+ * Undo the predictor and convert the photometric interpretation of
+ * decoded rows; every row is processed independently.
+ */
+static void postprocess_rows(TiffContext *s, uint8_t *dst, int stride,
+                             int width, int lines)
+{
+    int i, j;
+
+    if (s->predictor == 2) {
+        uint8_t *row = dst;
+        int soff  = s->bpp >> 3;
+        int ssize;
+        if (s->planar)
+            soff  = FFMAX(soff / s->bppcount, 1);
+        ssize = width * soff;
+        if (s->avctx->pix_fmt == AV_PIX_FMT_RGB48LE ||
+            s->avctx->pix_fmt == AV_PIX_FMT_RGBA64LE ||
+            s->avctx->pix_fmt == AV_PIX_FMT_GRAY16LE ||
+            s->avctx->pix_fmt == AV_PIX_FMT_YA16LE ||
+            s->avctx->pix_fmt == AV_PIX_FMT_GBRP16LE ||
+            s->avctx->pix_fmt == AV_PIX_FMT_GBRAP16LE) {
+            for (i = 0; i < lines; i++) {
+                for (j = soff; j < ssize; j += 2)
+                    AV_WL16(row + j, AV_RL16(row + j) + AV_RL16(row + j - soff));
+                row += stride;
+            }
+        } else if (s->avctx->pix_fmt == AV_PIX_FMT_RGB48BE ||
+                   s->avctx->pix_fmt == AV_PIX_FMT_RGBA64BE ||
+                   s->avctx->pix_fmt == AV_PIX_FMT_GRAY16BE ||
+                   s->avctx->pix_fmt == AV_PIX_FMT_YA16BE ||
+                   s->avctx->pix_fmt == AV_PIX_FMT_GBRP16BE ||
+                   s->avctx->pix_fmt == AV_PIX_FMT_GBRAP16BE) {
+            for (i = 0; i < lines; i++) {
+                for (j = soff; j < ssize; j += 2)
+                    AV_WB16(row + j, AV_RB16(row + j) + AV_RB16(row + j - soff));
+                row += stride;
+            }
+        } else {
+            for (i = 0; i < lines; i++) {
+                for (j = soff; j < ssize; j++)
+                    row[j] += row[j - soff];
+                row += stride;
+            }
+        }
+    }
+
+    if (s->photometric == TIFF_PHOTOMETRIC_WHITE_IS_ZERO) {
+        uint8_t *row = dst;
+        int c = (s->avctx->pix_fmt == AV_PIX_FMT_PAL8 ? (1<<s->bpp) - 1 : 255);
+        for (i = 0; i < lines; i++) {
+            for (j = 0; j < stride; j++)
+                row[j] = c - row[j];
+            row += stride;
+        }
+    }
+
+    if (s->photometric == TIFF_PHOTOMETRIC_SEPARATED &&
+        s->avctx->pix_fmt == AV_PIX_FMT_RGB0) {
+        uint8_t *row = dst;
+        for (i = 0; i < lines; i++) {
+            for (j = 0; j < width; j++) {
+                int k =  255 - row[4 * j + 3];
+                int r = (255 - row[4 * j    ]) * k;
+                int g = (255 - row[4 * j + 1]) * k;
+                int b = (255 - row[4 * j + 2]) * k;
+                row[4 * j    ] = r * 257 >> 16;
+                row[4 * j + 1] = g * 257 >> 16;
+                row[4 * j + 2] = b * 257 >> 16;
+                row[4 * j + 3] = 255;
+            }
+            row += stride;
+        }
+    }
+
+    if (s->is_bayer && s->white_level && s->bpp == 16) {
+        uint16_t *row = (uint16_t *)dst;
+        for (i = 0; i < lines; i++) {
+            for (j = 0; j < width; j++)
+                row[j] = FFMIN((row[j] / (float)s->white_level) * 65535, 65535);
+            row += stride / 2;
+        }
+    }
+}
+
+/**
+ * Decode one strip or tile; jobs are ordered plane by plane.
+ */
+static int decode_strip(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    TiffContext *s = avctx->priv_data;
+    TiffThreadContext *td = &s->thread_ctx[threadnr];
+    const TiffStrip *strip = &s->strip_table[jobnr];
+    AVFrame *p  = s->frame;
+    int plane   = jobnr / s->nb_jobs_per_plane;
+    int idx     = jobnr % s->nb_jobs_per_plane;
+    int stride  = p->linesize[plane];
+    uint8_t *dst;
+    int x, y, ret;
+
+    if (s->is_tiled) {
+        x = idx % s->tiles_x * s->tile_width;
+        y = idx / s->tiles_x * s->tile_length;
+
+        av_fast_padded_malloc(&td->tile_buf, &td->tile_buf_size,
+                              (size_t)s->tile_stride * s->tile_length);
+        if (!td->tile_buf)
+            return AVERROR(ENOMEM);
+
+        /* tiles are always coded at full size, the edges are cropped after
+         * the predictor has been undone */
+        ret = tiff_unpack_strip(s, td, p, td->tile_buf, s->tile_stride,
+                                strip->src, strip->size, y,
+                                s->tile_length, s->tile_width);
+        if (ret < 0)
+            return ret;
+        postprocess_rows(s, td->tile_buf, s->tile_stride,
+                         s->tile_width, s->tile_length);
+
+        dst = p->data[plane] + y * stride + tiff_row_bytes(s, x);
+        av_image_copy_plane(dst, stride, td->tile_buf, s->tile_stride,
+                            tiff_row_bytes(s, FFMIN(s->tile_width, s->width - x)),
+                            FFMIN(s->tile_length, s->height - y));
+    } else {
+        int lines;
+
+        y     = idx * s->rps;
+        lines = FFMIN(s->rps, s->height - y);
+        dst   = p->data[plane] + y * stride;
+
+        ret = tiff_unpack_strip(s, td, p, dst, stride, strip->src, strip->size,
+                                y, lines, s->width);
+        if (ret < 0)
+            return ret;
+        postprocess_rows(s, dst, stride, s->width, lines);
+    }
+
+    return 0;
+}
+
 static int decode_frame(AVCodecContext *avctx,
                         void *data, int *got_frame, AVPacket *avpkt)
 {
@@ -1349,10 +1552,9 @@ static int decode_frame(AVCodecContext *avctx,
     AVFrame *const p = data;
     ThreadFrame frame = { .f = data };
     unsigned off;
-    int le, ret, plane, planes;
-    int i, j, entries, stride;
+    int le, ret, plane, planes, nb_jobs;
+    int i, entries;
     unsigned soff, ssize;
-    uint8_t *dst;
     GetByteContext stripsizes;
     GetByteContext stripdata;
 
@@ -1375,6 +1577,9 @@ again:
     s->fill_order  = 0;
     s->white_level = 0;
     s->is_bayer    = 0;
+    s->is_tiled    = 0;
+    s->tile_width  =
+    s->tile_length = 0;
     free_geotags(s);
 
     // Reset these offsets so we can tell if they were set this frame
@@ -1442,20 +1647,54 @@ again:
                          avpkt->size - s->strippos);
     }
 
-    if (s->rps <= 0 || s->rps % s->subsampling[1]) {
+    if (s->is_tiled) {
+        if (s->tile_width <= 0 || s->tile_length <= 0 ||
+            s->tile_width % 16 || s->tile_length % 16) {
+            av_log(avctx, AV_LOG_ERROR, "Invalid tile size %dx%d\n",
+                   s->tile_width, s->tile_length);
+            return AVERROR_INVALIDDATA;
+        }
+        if ((ret = av_image_check_size(s->tile_width, s->tile_length, 0, avctx)) < 0)
+            return ret;
+        if (s->photometric == TIFF_PHOTOMETRIC_YCBCR ||
+            s->compr == TIFF_CCITT_RLE || s->compr == TIFF_G3 || s->compr == TIFF_G4 ||
+            (s->bpp & 7 && avctx->pix_fmt != AV_PIX_FMT_PAL8 &&
+                           avctx->pix_fmt != AV_PIX_FMT_MONOBLACK)) {
+            avpriv_report_missing_feature(avctx, "Tiled images in this format");
+            return AVERROR_PATCHWELCOME;
+        }
+    } else if (s->rps <= 0 || s->rps % s->subsampling[1]) {
         av_log(avctx, AV_LOG_ERROR, "rps %d invalid\n", s->rps);
         return AVERROR_INVALIDDATA;
     }
 
+    if (s->predictor == 2 && s->photometric == TIFF_PHOTOMETRIC_YCBCR) {
+        av_log(s->avctx, AV_LOG_ERROR, "predictor == 2 with YUV is unsupported");
+        return AVERROR_PATCHWELCOME;
+    }
+
     planes = s->planar ? s->bppcount : 1;
+    if (s->is_tiled) {
+        s->tiles_x = (s->width  + s->tile_width  - 1) / s->tile_width;
+        s->tiles_y = (s->height + s->tile_length - 1) / s->tile_length;
+        s->nb_jobs_per_plane = s->tiles_x * s->tiles_y;
+        s->tile_stride = tiff_row_bytes(s, s->tile_width);
+    } else {
+        s->nb_jobs_per_plane = (s->height + s->rps - 1) / s->rps;
+    }
+    nb_jobs = planes * s->nb_jobs_per_plane;
+
+    av_fast_malloc(&s->strip_table, &s->strip_table_size,
+                   nb_jobs * sizeof(*s->strip_table));
+    av_fast_malloc(&s->strip_ret, &s->strip_ret_size,
+                   nb_jobs * sizeof(*s->strip_ret));
+    if (!s->strip_table || !s->strip_ret)
+        return AVERROR(ENOMEM);
+
     for (plane = 0; plane < planes; plane++) {
         int remaining = avpkt->size;
-        int decoded_height;
-        stride = p->linesize[plane];
-        dst = p->data[plane];
-        for (i = 0; i < s->height; i += s->rps) {
-            if (i)
-                dst += s->rps * stride;
+        for (i = 0; i < s->nb_jobs_per_plane; i++) {
+            TiffStrip *strip = &s->strip_table[plane * s->nb_jobs_per_plane + i];
             if (s->stripsizesoff)
                 ssize = ff_tget(&stripsizes, s->sstype, le);
             else
@@ -1471,83 +1710,16 @@ again:
                 return AVERROR_INVALIDDATA;
             }
             remaining -= ssize;
-            if ((ret = tiff_unpack_strip(s, p, dst, stride, avpkt->data + soff, ssize, i,
-                                         FFMIN(s->rps, s->height - i))) < 0) {
-                if (avctx->err_recognition & AV_EF_EXPLODE)
-                    return ret;
-                break;
-            }
-        }
-        decoded_height = FFMIN(i, s->height);
-
-        if (s->predictor == 2) {
-            if (s->photometric == TIFF_PHOTOMETRIC_YCBCR) {
-                av_log(s->avctx, AV_LOG_ERROR, "predictor == 2 with YUV is unsupported");
-                return AVERROR_PATCHWELCOME;
-            }
-            dst   = p->data[plane];
-            soff  = s->bpp >> 3;
-            if (s->planar)
-                soff  = FFMAX(soff / s->bppcount, 1);
-            ssize = s->width * soff;
-            if (s->avctx->pix_fmt == AV_PIX_FMT_RGB48LE ||
-                s->avctx->pix_fmt == AV_PIX_FMT_RGBA64LE ||
-                s->avctx->pix_fmt == AV_PIX_FMT_GRAY16LE ||
-                s->avctx->pix_fmt == AV_PIX_FMT_YA16LE ||
-                s->avctx->pix_fmt == AV_PIX_FMT_GBRP16LE ||
-                s->avctx->pix_fmt == AV_PIX_FMT_GBRAP16LE) {
-                for (i = 0; i < decoded_height; i++) {
-                    for (j = soff; j < ssize; j += 2)
-                        AV_WL16(dst + j, AV_RL16(dst + j) + AV_RL16(dst + j - soff));
-                    dst += stride;
-                }
-            } else if (s->avctx->pix_fmt == AV_PIX_FMT_RGB48BE ||
-                       s->avctx->pix_fmt == AV_PIX_FMT_RGBA64BE ||
-                       s->avctx->pix_fmt == AV_PIX_FMT_GRAY16BE ||
-                       s->avctx->pix_fmt == AV_PIX_FMT_YA16BE ||
-                       s->avctx->pix_fmt == AV_PIX_FMT_GBRP16BE ||
-                       s->avctx->pix_fmt == AV_PIX_FMT_GBRAP16BE) {
-                for (i = 0; i < decoded_height; i++) {
-                    for (j = soff; j < ssize; j += 2)
-                        AV_WB16(dst + j, AV_RB16(dst + j) + AV_RB16(dst + j - soff));
-                    dst += stride;
-                }
-            } else {
-                for (i = 0; i < decoded_height; i++) {
-                    for (j = soff; j < ssize; j++)
-                        dst[j] += dst[j - soff];
-                    dst += stride;
-                }
-            }
-        }
-
-        if (s->photometric == TIFF_PHOTOMETRIC_WHITE_IS_ZERO) {
-            int c = (s->avctx->pix_fmt == AV_PIX_FMT_PAL8 ? (1<<s->bpp) - 1 : 255);
-            dst = p->data[plane];
-            for (i = 0; i < s->height; i++) {
-                for (j = 0; j < stride; j++)
-                    dst[j] = c - dst[j];
-                dst += stride;
-            }
+            strip->src  = avpkt->data + soff;
+            strip->size = ssize;
         }
+    }
 
-        if (s->photometric == TIFF_PHOTOMETRIC_SEPARATED &&
-            s->avctx->pix_fmt == AV_PIX_FMT_RGB0) {
-            dst = p->data[plane];
-            for (i = 0; i < s->height; i++) {
-                for (j = 0; j < s->width; j++) {
-                    int k =  255 - dst[4 * j + 3];
-                    int r = (255 - dst[4 * j    ]) * k;
-                    int g = (255 - dst[4 * j + 1]) * k;
-                    int b = (255 - dst[4 * j + 2]) * k;
-                    dst[4 * j    ] = r * 257 >> 16;
-                    dst[4 * j + 1] = g * 257 >> 16;
-                    dst[4 * j + 2] = b * 257 >> 16;
-                    dst[4 * j + 3] = 255;
-                }
-                dst += p->linesize[plane];
-            }
-        }
+    s->frame = p;
+    avctx->execute2(avctx, decode_strip, NULL, s->strip_ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++) {
+        if (s->strip_ret[i] < 0 && (avctx->err_recognition & AV_EF_EXPLODE))
+            return s->strip_ret[i];
     }
 
     if (s->planar && s->bppcount > 2) {
@@ -1557,15 +1729,6 @@ again:
         FFSWAP(int,      p->linesize[0], p->linesize[1]);
     }
 
-    if (s->is_bayer && s->white_level && s->bpp == 16) {
-        uint16_t *dst = (uint16_t *)p->data[0];
-        for (i = 0; i < s->height; i++) {
-            for (j = 0; j < s->width; j++)
-                dst[j] = FFMIN((dst[j] / (float)s->white_level) * 65535, 65535);
-            dst += stride / 2;
-        }
-    }
-
     *got_frame = 1;
 
     return avpkt->size;
@@ -1574,15 +1737,27 @@ again:
 static av_cold int tiff_init(AVCodecContext *avctx)
 {
     TiffContext *s = avctx->priv_data;
+    int i;
 
     s->width  = 0;
     s->height = 0;
     s->subsampling[0] =
     s->subsampling[1] = 1;
     s->avctx  = avctx;
-    ff_lzw_decode_open(&s->lzw);
-    if (!s->lzw)
+    s->strip_table      = NULL;
+    s->strip_table_size = 0;
+    s->strip_ret        = NULL;
+    s->strip_ret_size   = 0;
+
+    s->nb_thread_ctx = avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1;
+    s->thread_ctx    = av_mallocz_array(s->nb_thread_ctx, sizeof(*s->thread_ctx));
+    if (!s->thread_ctx)
         return AVERROR(ENOMEM);
+    for (i = 0; i < s->nb_thread_ctx; i++) {
+        ff_lzw_decode_open(&s->thread_ctx[i].lzw);
+        if (!s->thread_ctx[i].lzw)
+            return AVERROR(ENOMEM);
+    }
     ff_ccitt_unpack_init();
 
     return 0;
@@ -1591,16 +1766,23 @@ static av_cold int tiff_init(AVCodecContext *avctx)
 static av_cold int tiff_end(AVCodecContext *avctx)
 {
     TiffContext *const s = avctx->priv_data;
+    int i;
 
     free_geotags(s);
 
-    ff_lzw_decode_close(&s->lzw);
-    av_freep(&s->deinvert_buf);
-    s->deinvert_buf_size = 0;
-    av_freep(&s->yuv_line);
-    s->yuv_line_size = 0;
-    av_freep(&s->fax_buffer);
-    s->fax_buffer_size = 0;
+    for (i = 0; s->thread_ctx && i < s->nb_thread_ctx; i++) {
+        TiffThreadContext *td = &s->thread_ctx[i];
+        ff_lzw_decode_close(&td->lzw);
+        av_freep(&td->deinvert_buf);
+        av_freep(&td->yuv_line);
+        av_freep(&td->fax_buffer);
+        av_freep(&td->tile_buf);
+    }
+    av_freep(&s->thread_ctx);
+    av_freep(&s->strip_table);
+    s->strip_table_size = 0;
+    av_freep(&s->strip_ret);
+    s->strip_ret_size = 0;
     return 0;
 }
 
@@ -1627,6 +1809,8 @@ AVCodec ff_tiff_decoder = {
     .close          = tiff_end,
     .decode         = decode_frame,
     .init_thread_copy = ONLY_IF_THREADS_ENABLED(tiff_init),
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
+    .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP,
     .priv_class     = &tiff_decoder_class,
 };
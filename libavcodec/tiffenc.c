@@ -66,6 +66,9 @@ typedef struct TiffEncoderContext {
     unsigned int strip_offsets_size;
     uint8_t *yuv_line;
     unsigned int yuv_line_size;
+    int tile_size;                          ///< tile width and length, 0 for strips
+    uint8_t *tile_buf;
+    unsigned int tile_buf_size;
     int rps;                                ///< row per strip
     uint8_t entries[TIFF_MAX_ENTRY * 12];   ///< entries in header
     int num_entries;                        ///< number of entries
@@ -228,6 +231,72 @@ static void pack_yuv(TiffEncoderContext *s, const AVFrame *p,
     }
 }
 
+/**
+ * Encode the picture as square tiles, the edge tiles are padded with zeroes.
+ *
+ * @return 0 on success, a negative AVERROR code otherwise
+ */
+static int encode_tiles(TiffEncoderContext *s, const AVFrame *p, uint8_t **ptr,
+                        int tiles_x, int tiles_y)
+{
+    int tile_row_bytes = (s->tile_size * s->bpp + 7) >> 3;
+    int i, j, ret;
+
+    av_fast_padded_malloc(&s->tile_buf, &s->tile_buf_size,
+                          tile_row_bytes * s->tile_size);
+    if (!s->tile_buf)
+        return AVERROR(ENOMEM);
+
+    if (s->compr == TIFF_LZW) {
+        s->lzws = av_malloc(ff_lzw_encode_state_size);
+        if (!s->lzws)
+            return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < tiles_x * tiles_y; i++) {
+        int x = i % tiles_x * s->tile_size;
+        int y = i / tiles_x * s->tile_size;
+        int w = FFMIN(s->tile_size, s->width  - x);
+        int h = FFMIN(s->tile_size, s->height - y);
+
+        memset(s->tile_buf, 0, tile_row_bytes * s->tile_size);
+        for (j = 0; j < h; j++)
+            memcpy(s->tile_buf + j * tile_row_bytes,
+                   p->data[0] + (y + j) * p->linesize[0] + ((x * s->bpp) >> 3),
+                   (w * s->bpp + 7) >> 3);
+
+        s->strip_offsets[i] = *ptr - s->buf_start;
+        if (s->compr == TIFF_LZW)
+            ff_lzw_encode_init(s->lzws, *ptr,
+                               s->buf_size - (*s->buf - s->buf_start),
+                               12, FF_LZW_TIFF, put_bits);
+        if (s->compr == TIFF_PACKBITS) {
+            /* PackBits runs must not cross rows */
+            for (j = 0; j < s->tile_size; j++) {
+                ret = encode_strip(s, s->tile_buf + j * tile_row_bytes, *ptr,
+                                   tile_row_bytes, s->compr);
+                if (ret < 0)
+                    goto fail;
+                *ptr += ret;
+            }
+        } else {
+            ret = encode_strip(s, s->tile_buf, *ptr,
+                               tile_row_bytes * s->tile_size, s->compr);
+            if (ret < 0)
+                goto fail;
+            *ptr += ret;
+        }
+        if (s->compr == TIFF_LZW)
+            *ptr += ff_lzw_encode_flush(s->lzws, flush_put_bits);
+        s->strip_sizes[i] = *ptr - s->buf_start - s->strip_offsets[i];
+    }
+    ret = 0;
+
+fail:
+    av_freep(&s->lzws);
+    return ret;
+}
+
 #define ADD_ENTRY(s, tag, type, count, ptr_val)         \
     do {                                                \
         ret = add_entry(s, tag, type, count, ptr_val);  \
@@ -259,6 +328,7 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     int is_yuv = 0, alpha = 0;
     int shift_h, shift_v;
     int packet_size;
+    int tiles_x = 0, tiles_y = 0;
 
     s->width          = avctx->width;
     s->height         = avctx->height;
@@ -313,6 +383,12 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         return AVERROR(EINVAL);
     }
 
+    if (s->tile_size && is_yuv) {
+        av_log(s->avctx, AV_LOG_ERROR,
+               "Tiles are not supported with YUV\n");
+        return AVERROR_PATCHWELCOME;
+    }
+
     for (i = 0; i < s->bpp_tab_size; i++)
         bpp_tab[i] = desc->comp[i].depth;
 
@@ -334,6 +410,15 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     packet_size = avctx->height * bytes_per_row * 2 +
                   avctx->height * 4 + AV_INPUT_BUFFER_MIN_SIZE;
 
+    if (s->tile_size) {
+        tiles_x = (s->width  - 1) / s->tile_size + 1;
+        tiles_y = (s->height - 1) / s->tile_size + 1;
+        strips  = tiles_x * tiles_y;
+        packet_size = (int64_t)tiles_y * s->tile_size *
+                      tiles_x * ((s->tile_size * s->bpp + 7) >> 3) * 2 +
+                      strips * 8 + AV_INPUT_BUFFER_MIN_SIZE;
+    }
+
     if ((ret = ff_alloc_packet2(avctx, pkt, packet_size, 0)) < 0)
         return ret;
     ptr          = pkt->data;
@@ -374,6 +459,13 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
         }
     }
 
+    if (s->tile_size) {
+        ret = encode_tiles(s, p, &ptr, tiles_x, tiles_y);
+        if (ret < 0) {
+            av_log(s->avctx, AV_LOG_ERROR, "Encode tile failed\n");
+            goto fail;
+        }
+    } else
 #if CONFIG_ZLIB
     if (s->compr == TIFF_DEFLATE || s->compr == TIFF_ADOBE_DEFLATE) {
         uint8_t *zbuf;
@@ -460,13 +552,22 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
 
     ADD_ENTRY1(s, TIFF_COMPR,       TIFF_SHORT, s->compr);
     ADD_ENTRY1(s, TIFF_PHOTOMETRIC, TIFF_SHORT, s->photometric_interpretation);
-    ADD_ENTRY(s,  TIFF_STRIP_OFFS,  TIFF_LONG,  strips, s->strip_offsets);
+    if (s->tile_size) {
+        ADD_ENTRY1(s, TIFF_TILE_WIDTH,  TIFF_LONG, s->tile_size);
+        ADD_ENTRY1(s, TIFF_TILE_LENGTH, TIFF_LONG, s->tile_size);
+        ADD_ENTRY(s,  TIFF_TILE_OFFSETS, TIFF_LONG, strips, s->strip_offsets);
+    } else
+        ADD_ENTRY(s,  TIFF_STRIP_OFFS,  TIFF_LONG,  strips, s->strip_offsets);
 
     if (s->bpp_tab_size)
         ADD_ENTRY1(s, TIFF_SAMPLES_PER_PIXEL, TIFF_SHORT, s->bpp_tab_size);
 
-    ADD_ENTRY1(s, TIFF_ROWSPERSTRIP, TIFF_LONG,     s->rps);
-    ADD_ENTRY(s,  TIFF_STRIP_SIZE,   TIFF_LONG,     strips, s->strip_sizes);
+    if (s->tile_size) {
+        ADD_ENTRY(s,  TIFF_TILE_BYTE_COUNTS, TIFF_LONG, strips, s->strip_sizes);
+    } else {
+        ADD_ENTRY1(s, TIFF_ROWSPERSTRIP, TIFF_LONG,     s->rps);
+        ADD_ENTRY(s,  TIFF_STRIP_SIZE,   TIFF_LONG,     strips, s->strip_sizes);
+    }
     ADD_ENTRY(s,  TIFF_XRES,         TIFF_RATIONAL, 1,      res);
     if (avctx->sample_aspect_ratio.num > 0 &&
         avctx->sample_aspect_ratio.den > 0) {
@@ -525,6 +626,11 @@ static av_cold int encode_init(AVCodecContext *avctx)
 {
     TiffEncoderContext *s = avctx->priv_data;
 
+    if (s->tile_size % 16) {
+        av_log(avctx, AV_LOG_ERROR, "Tile size must be a multiple of 16\n");
+        return AVERROR(EINVAL);
+    }
+
 #if !CONFIG_ZLIB
     if (s->compr == TIFF_DEFLATE) {
         av_log(avctx, AV_LOG_ERROR,
@@ -551,6 +657,7 @@ static av_cold int encode_close(AVCodecContext *avctx)
     av_freep(&s->strip_sizes);
     av_freep(&s->strip_offsets);
     av_freep(&s->yuv_line);
+    av_freep(&s->tile_buf);
 
     return 0;
 }
@@ -564,6 +671,7 @@ static const AVOption options[] = {
     { "raw",              NULL, 0,             AV_OPT_TYPE_CONST, { .i64 = TIFF_RAW      }, 0,        0,            VE, "compression_algo" },
     { "lzw",              NULL, 0,             AV_OPT_TYPE_CONST, { .i64 = TIFF_LZW      }, 0,        0,            VE, "compression_algo" },
     { "deflate",          NULL, 0,             AV_OPT_TYPE_CONST, { .i64 = TIFF_DEFLATE  }, 0,        0,            VE, "compression_algo" },
+    { "tile_size", "set the tile width and length, 0 to write strips", OFFSET(tile_size), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 4096, VE },
     { NULL },
 };
 
@@ -31,6 +31,7 @@
 #include "avcodec.h"
 #include "bswapdsp.h"
 #include "utvideodsp.h"
+#include "vlc.h"
 #include "lossless_videodsp.h"
 #include "lossless_videoencdsp.h"
 
@@ -85,6 +86,14 @@ typedef struct UtvideoContext {
     uint8_t *slice_bits, *slice_buffer[4];
     int      slice_bits_size;
 
+    /* decoder state shared by the slice jobs of the current frame */
+    AVFrame *frame;
+    const uint8_t *plane_start[5];
+    VLC      vlc[4];
+    int      fsym[4];
+    int      hshift, vshift;
+    ptrdiff_t slice_bits_stride;
+
     const uint8_t *packed_stream[4][256];
     size_t packed_stream_size[4][256];
     const uint8_t *control_stream[4][256];
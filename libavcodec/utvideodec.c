@@ -127,107 +127,85 @@ static int build_huff(const uint8_t *src, VLC *vlc, int *fsym)
                               syms,  sizeof(*syms),  sizeof(*syms), 0);
 }
 
-static int decode_plane10(UtvideoContext *c, int plane_no,
+static int decode_slice10(UtvideoContext *c, int plane_no, int slice,
                           uint16_t *dst, ptrdiff_t stride,
                           int width, int height,
-                          const uint8_t *src, const uint8_t *huff,
+                          const uint8_t *src, uint8_t *buf,
                           int use_pred)
 {
-    int i, j, slice, pix, ret;
+    int i, j, pix;
     int sstart, send;
-    VLC vlc;
+    VLC *vlc = &c->vlc[plane_no];
+    const int fsym = c->fsym[plane_no];
     GetBitContext gb;
-    int prev, fsym;
+    int prev;
+    int slice_data_start, slice_data_end, slice_size;
 
-    if ((ret = build_huff10(huff, &vlc, &fsym)) < 0) {
-        av_log(c->avctx, AV_LOG_ERROR, "Cannot build Huffman codes\n");
-        return ret;
-    }
-    if (fsym >= 0) { // build_huff reported a symbol to fill slices with
-        send = 0;
-        for (slice = 0; slice < c->slices; slice++) {
-            uint16_t *dest;
-
-            sstart = send;
-            send   = (height * (slice + 1) / c->slices);
-            dest   = dst + sstart * stride;
-
-            prev = 0x200;
-            for (j = sstart; j < send; j++) {
-                for (i = 0; i < width; i++) {
-                    pix = fsym;
-                    if (use_pred) {
-                        prev += pix;
-                        prev &= 0x3FF;
-                        pix   = prev;
-                    }
-                    dest[i] = pix;
-                }
-                dest += stride;
-            }
-        }
-        return 0;
-    }
-
-    send = 0;
-    for (slice = 0; slice < c->slices; slice++) {
-        uint16_t *dest;
-        int slice_data_start, slice_data_end, slice_size;
-
-        sstart = send;
-        send   = (height * (slice + 1) / c->slices);
-        dest   = dst + sstart * stride;
-
-        // slice offset and size validation was done earlier
-        slice_data_start = slice ? AV_RL32(src + slice * 4 - 4) : 0;
-        slice_data_end   = AV_RL32(src + slice * 4);
-        slice_size       = slice_data_end - slice_data_start;
-
-        if (!slice_size) {
-            av_log(c->avctx, AV_LOG_ERROR, "Plane has more than one symbol "
-                   "yet a slice has a length of zero.\n");
-            goto fail;
-        }
-
-        memset(c->slice_bits + slice_size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
-        c->bdsp.bswap_buf((uint32_t *) c->slice_bits,
-                          (uint32_t *)(src + slice_data_start + c->slices * 4),
-                          (slice_data_end - slice_data_start + 3) >> 2);
-        init_get_bits(&gb, c->slice_bits, slice_size * 8);
+    sstart = height *  slice      / c->slices;
+    send   = height * (slice + 1) / c->slices;
+    dst   += sstart * stride;
 
+    if (fsym >= 0) { // build_huff reported a symbol to fill slices with
         prev = 0x200;
         for (j = sstart; j < send; j++) {
             for (i = 0; i < width; i++) {
-                pix = get_vlc2(&gb, vlc.table, VLC_BITS, 3);
-                if (pix < 0) {
-                    av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
-                    goto fail;
-                }
+                pix = fsym;
                 if (use_pred) {
                     prev += pix;
                     prev &= 0x3FF;
                     pix   = prev;
                 }
-                dest[i] = pix;
-            }
-            dest += stride;
-            if (get_bits_left(&gb) < 0) {
-                av_log(c->avctx, AV_LOG_ERROR,
-                        "Slice decoding ran out of bits\n");
-                goto fail;
+                dst[i] = pix;
             }
+            dst += stride;
         }
-        if (get_bits_left(&gb) > 32)
-            av_log(c->avctx, AV_LOG_WARNING,
-                   "%d bits left after decoding slice\n", get_bits_left(&gb));
+        return 0;
+    }
+
+    // slice offset and size validation was done earlier
+    slice_data_start = slice ? AV_RL32(src + slice * 4 - 4) : 0;
+    slice_data_end   = AV_RL32(src + slice * 4);
+    slice_size       = slice_data_end - slice_data_start;
+
+    if (!slice_size) {
+        av_log(c->avctx, AV_LOG_ERROR, "Plane has more than one symbol "
+               "yet a slice has a length of zero.\n");
+        return AVERROR_INVALIDDATA;
     }
 
-    ff_free_vlc(&vlc);
+    memset(buf + slice_size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    c->bdsp.bswap_buf((uint32_t *) buf,
+                      (uint32_t *)(src + slice_data_start + c->slices * 4),
+                      (slice_data_end - slice_data_start + 3) >> 2);
+    init_get_bits(&gb, buf, slice_size * 8);
+
+    prev = 0x200;
+    for (j = sstart; j < send; j++) {
+        for (i = 0; i < width; i++) {
+            pix = get_vlc2(&gb, vlc->table, VLC_BITS, 3);
+            if (pix < 0) {
+                av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
+                return AVERROR_INVALIDDATA;
+            }
+            if (use_pred) {
+                prev += pix;
+                prev &= 0x3FF;
+                pix   = prev;
+            }
+            dst[i] = pix;
+        }
+        dst += stride;
+        if (get_bits_left(&gb) < 0) {
+            av_log(c->avctx, AV_LOG_ERROR,
+                    "Slice decoding ran out of bits\n");
+            return AVERROR_INVALIDDATA;
+        }
+    }
+    if (get_bits_left(&gb) > 32)
+        av_log(c->avctx, AV_LOG_WARNING,
+               "%d bits left after decoding slice\n", get_bits_left(&gb));
 
     return 0;
-fail:
-    ff_free_vlc(&vlc);
-    return AVERROR_INVALIDDATA;
 }
 
 static int compute_cmask(int plane_no, int interlaced, enum AVPixelFormat pix_fmt)
@@ -240,58 +218,58 @@ static int compute_cmask(int plane_no, int interlaced, enum AVPixelFormat pix_fm
     return ~is_luma;
 }
 
-static int decode_plane(UtvideoContext *c, int plane_no,
+static int decode_slice(UtvideoContext *c, int plane_no, int slice,
                         uint8_t *dst, ptrdiff_t stride,
                         int width, int height,
-                        const uint8_t *src, int use_pred)
+                        const uint8_t *src, uint8_t *buf, int use_pred)
 {
-    int i, j, slice, pix;
+    int i, j, pix;
     int sstart, send;
-    VLC vlc;
+    VLC *vlc = &c->vlc[plane_no];
+    const int fsym = c->fsym[plane_no];
     GetBitContext gb;
-    int ret, prev, fsym;
+    int ret, prev;
+    int slice_data_start, slice_data_end, slice_size;
     const int cmask = compute_cmask(plane_no, c->interlaced, c->avctx->pix_fmt);
 
+    sstart = (height *  slice      / c->slices) & cmask;
+    send   = (height * (slice + 1) / c->slices) & cmask;
+
     if (c->pack) {
-        send = 0;
-        for (slice = 0; slice < c->slices; slice++) {
-            GetBitContext cbit, pbit;
-            uint8_t *dest, *p;
+        GetBitContext cbit, pbit;
+        uint8_t *dest, *p;
 
-            ret = init_get_bits8(&cbit, c->control_stream[plane_no][slice], c->control_stream_size[plane_no][slice]);
-            if (ret < 0)
-                return ret;
+        ret = init_get_bits8(&cbit, c->control_stream[plane_no][slice], c->control_stream_size[plane_no][slice]);
+        if (ret < 0)
+            return ret;
 
-            ret = init_get_bits8(&pbit, c->packed_stream[plane_no][slice], c->packed_stream_size[plane_no][slice]);
-            if (ret < 0)
-                return ret;
+        ret = init_get_bits8(&pbit, c->packed_stream[plane_no][slice], c->packed_stream_size[plane_no][slice]);
+        if (ret < 0)
+            return ret;
 
-            sstart = send;
-            send   = (height * (slice + 1) / c->slices) & cmask;
-            dest   = dst + sstart * stride;
+        dest = dst + sstart * stride;
 
-            if (3 * ((dst + send * stride - dest + 7)/8) > get_bits_left(&cbit))
-                return AVERROR_INVALIDDATA;
+        if (3 * ((dst + send * stride - dest + 7)/8) > get_bits_left(&cbit))
+            return AVERROR_INVALIDDATA;
 
-            for (p = dest; p < dst + send * stride; p += 8) {
-                int bits = get_bits_le(&cbit, 3);
+        for (p = dest; p < dst + send * stride; p += 8) {
+            int bits = get_bits_le(&cbit, 3);
 
-                if (bits == 0) {
-                    *(uint64_t *) p = 0;
-                } else {
-                    uint32_t sub = 0x80 >> (8 - (bits + 1)), add;
-                    int k;
+            if (bits == 0) {
+                *(uint64_t *) p = 0;
+            } else {
+                uint32_t sub = 0x80 >> (8 - (bits + 1)), add;
+                int k;
 
-                    if ((bits + 1) * 8 > get_bits_left(&pbit))
-                        return AVERROR_INVALIDDATA;
+                if ((bits + 1) * 8 > get_bits_left(&pbit))
+                    return AVERROR_INVALIDDATA;
 
-                    for (k = 0; k < 8; k++) {
+                for (k = 0; k < 8; k++) {
 
-                        p[k] = get_bits_le(&pbit, bits + 1);
-                        add = (~p[k] & sub) << (8 - bits);
-                        p[k] -= sub;
-                        p[k] += add;
-                    }
+                    p[k] = get_bits_le(&pbit, bits + 1);
+                    add = (~p[k] & sub) << (8 - bits);
+                    p[k] -= sub;
+                    p[k] += add;
                 }
             }
         }
@@ -299,95 +277,69 @@ static int decode_plane(UtvideoContext *c, int plane_no,
         return 0;
     }
 
-    if (build_huff(src, &vlc, &fsym)) {
-        av_log(c->avctx, AV_LOG_ERROR, "Cannot build Huffman codes\n");
-        return AVERROR_INVALIDDATA;
-    }
+    dst += sstart * stride;
+
     if (fsym >= 0) { // build_huff reported a symbol to fill slices with
-        send = 0;
-        for (slice = 0; slice < c->slices; slice++) {
-            uint8_t *dest;
-
-            sstart = send;
-            send   = (height * (slice + 1) / c->slices) & cmask;
-            dest   = dst + sstart * stride;
-
-            prev = 0x80;
-            for (j = sstart; j < send; j++) {
-                for (i = 0; i < width; i++) {
-                    pix = fsym;
-                    if (use_pred) {
-                        prev += pix;
-                        pix   = prev;
-                    }
-                    dest[i] = pix;
+        prev = 0x80;
+        for (j = sstart; j < send; j++) {
+            for (i = 0; i < width; i++) {
+                pix = fsym;
+                if (use_pred) {
+                    prev += pix;
+                    pix   = prev;
                 }
-                dest += stride;
+                dst[i] = pix;
             }
+            dst += stride;
         }
         return 0;
     }
 
     src      += 256;
 
-    send = 0;
-    for (slice = 0; slice < c->slices; slice++) {
-        uint8_t *dest;
-        int slice_data_start, slice_data_end, slice_size;
-
-        sstart = send;
-        send   = (height * (slice + 1) / c->slices) & cmask;
-        dest   = dst + sstart * stride;
+    // slice offset and size validation was done earlier
+    slice_data_start = slice ? AV_RL32(src + slice * 4 - 4) : 0;
+    slice_data_end   = AV_RL32(src + slice * 4);
+    slice_size       = slice_data_end - slice_data_start;
 
-        // slice offset and size validation was done earlier
-        slice_data_start = slice ? AV_RL32(src + slice * 4 - 4) : 0;
-        slice_data_end   = AV_RL32(src + slice * 4);
-        slice_size       = slice_data_end - slice_data_start;
-
-        if (!slice_size) {
-            av_log(c->avctx, AV_LOG_ERROR, "Plane has more than one symbol "
-                   "yet a slice has a length of zero.\n");
-            goto fail;
-        }
-
-        memset(c->slice_bits + slice_size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
-        c->bdsp.bswap_buf((uint32_t *) c->slice_bits,
-                          (uint32_t *)(src + slice_data_start + c->slices * 4),
-                          (slice_data_end - slice_data_start + 3) >> 2);
-        init_get_bits(&gb, c->slice_bits, slice_size * 8);
+    if (!slice_size) {
+        av_log(c->avctx, AV_LOG_ERROR, "Plane has more than one symbol "
+               "yet a slice has a length of zero.\n");
+        return AVERROR_INVALIDDATA;
+    }
 
-        prev = 0x80;
-        for (j = sstart; j < send; j++) {
-            for (i = 0; i < width; i++) {
-                pix = get_vlc2(&gb, vlc.table, VLC_BITS, 3);
-                if (pix < 0) {
-                    av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
-                    goto fail;
-                }
-                if (use_pred) {
-                    prev += pix;
-                    pix   = prev;
-                }
-                dest[i] = pix;
+    memset(buf + slice_size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    c->bdsp.bswap_buf((uint32_t *) buf,
+                      (uint32_t *)(src + slice_data_start + c->slices * 4),
+                      (slice_data_end - slice_data_start + 3) >> 2);
+    init_get_bits(&gb, buf, slice_size * 8);
+
+    prev = 0x80;
+    for (j = sstart; j < send; j++) {
+        for (i = 0; i < width; i++) {
+            pix = get_vlc2(&gb, vlc->table, VLC_BITS, 3);
+            if (pix < 0) {
+                av_log(c->avctx, AV_LOG_ERROR, "Decoding error\n");
+                return AVERROR_INVALIDDATA;
             }
-            if (get_bits_left(&gb) < 0) {
-                av_log(c->avctx, AV_LOG_ERROR,
-                        "Slice decoding ran out of bits\n");
-                goto fail;
+            if (use_pred) {
+                prev += pix;
+                pix   = prev;
             }
-            dest += stride;
+            dst[i] = pix;
+        }
+        if (get_bits_left(&gb) < 0) {
+            av_log(c->avctx, AV_LOG_ERROR,
+                    "Slice decoding ran out of bits\n");
+            return AVERROR_INVALIDDATA;
         }
-        if (get_bits_left(&gb) > 32)
-            av_log(c->avctx, AV_LOG_WARNING,
-                   "%d bits left after decoding slice\n", get_bits_left(&gb));
+        dst += stride;
     }
-
-    ff_free_vlc(&vlc);
+    if (get_bits_left(&gb) > 32)
+        av_log(c->avctx, AV_LOG_WARNING,
+               "%d bits left after decoding slice\n", get_bits_left(&gb));
 
     return 0;
-fail:
-    ff_free_vlc(&vlc);
-    return AVERROR_INVALIDDATA;
 }
 
 #undef A
@@ -395,50 +347,49 @@ fail:
 #undef C
 
 static void restore_median_planar(UtvideoContext *c, uint8_t *src, ptrdiff_t stride,
-                                  int width, int height, int slices, int rmode)
+                                  int width, int height, int slices, int slice,
+                                  int rmode)
 {
-    int i, j, slice;
+    int i, j;
     int A, B, C;
     uint8_t *bsrc;
     int slice_start, slice_height;
     const int cmask = ~rmode;
 
-    for (slice = 0; slice < slices; slice++) {
-        slice_start  = ((slice * height) / slices) & cmask;
-        slice_height = ((((slice + 1) * height) / slices) & cmask) -
-                       slice_start;
-
-        if (!slice_height)
-            continue;
-        bsrc = src + slice_start * stride;
-
-        // first line - left neighbour prediction
-        bsrc[0] += 0x80;
-        c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
-        bsrc += stride;
-        if (slice_height <= 1)
-            continue;
-        // second line - first element has top prediction, the rest uses median
-        C        = bsrc[-stride];
-        bsrc[0] += C;
-        A        = bsrc[0];
-        for (i = 1; i < FFMIN(width, 16); i++) { /* scalar loop (DSP need align 16) */
-            B        = bsrc[i - stride];
-            bsrc[i] += mid_pred(A, B, (uint8_t)(A + B - C));
-            C        = B;
-            A        = bsrc[i];
-        }
-        if (width > 16)
-            c->llviddsp.add_median_pred(bsrc + 16, bsrc - stride + 16,
-                                        bsrc + 16, width - 16, &A, &B);
-
+    slice_start  = ((slice * height) / slices) & cmask;
+    slice_height = ((((slice + 1) * height) / slices) & cmask) -
+                   slice_start;
+
+    if (!slice_height)
+        return;
+    bsrc = src + slice_start * stride;
+
+    // first line - left neighbour prediction
+    bsrc[0] += 0x80;
+    c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
+    bsrc += stride;
+    if (slice_height <= 1)
+        return;
+    // second line - first element has top prediction, the rest uses median
+    C        = bsrc[-stride];
+    bsrc[0] += C;
+    A        = bsrc[0];
+    for (i = 1; i < FFMIN(width, 16); i++) { /* scalar loop (DSP need align 16) */
+        B        = bsrc[i - stride];
+        bsrc[i] += mid_pred(A, B, (uint8_t)(A + B - C));
+        C        = B;
+        A        = bsrc[i];
+    }
+    if (width > 16)
+        c->llviddsp.add_median_pred(bsrc + 16, bsrc - stride + 16,
+                                    bsrc + 16, width - 16, &A, &B);
+
+    bsrc += stride;
+    // the rest of lines use continuous median prediction
+    for (j = 2; j < slice_height; j++) {
+        c->llviddsp.add_median_pred(bsrc, bsrc - stride,
+                                        bsrc, width, &A, &B);
         bsrc += stride;
-        // the rest of lines use continuous median prediction
-        for (j = 2; j < slice_height; j++) {
-            c->llviddsp.add_median_pred(bsrc, bsrc - stride,
-                                            bsrc, width, &A, &B);
-            bsrc += stride;
-        }
     }
 }
 
@@ -447,105 +398,104 @@ static void restore_median_planar(UtvideoContext *c, uint8_t *src, ptrdiff_t str
  * two parts of the same "line".
  */
 static void restore_median_planar_il(UtvideoContext *c, uint8_t *src, ptrdiff_t stride,
-                                     int width, int height, int slices, int rmode)
+                                     int width, int height, int slices, int slice,
+                                     int rmode)
 {
-    int i, j, slice;
+    int i, j;
     int A, B, C;
     uint8_t *bsrc;
     int slice_start, slice_height;
     const int cmask   = ~(rmode ? 3 : 1);
     const ptrdiff_t stride2 = stride << 1;
 
-    for (slice = 0; slice < slices; slice++) {
-        slice_start    = ((slice * height) / slices) & cmask;
-        slice_height   = ((((slice + 1) * height) / slices) & cmask) -
-                         slice_start;
-        slice_height >>= 1;
-        if (!slice_height)
-            continue;
-
-        bsrc = src + slice_start * stride;
-
-        // first line - left neighbour prediction
-        bsrc[0] += 0x80;
-        A = c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
-        c->llviddsp.add_left_pred(bsrc + stride, bsrc + stride, width, A);
-        bsrc += stride2;
-        if (slice_height <= 1)
-            continue;
-        // second line - first element has top prediction, the rest uses median
-        C        = bsrc[-stride2];
-        bsrc[0] += C;
-        A        = bsrc[0];
-        for (i = 1; i < FFMIN(width, 16); i++) { /* scalar loop (DSP need align 16) */
-            B        = bsrc[i - stride2];
-            bsrc[i] += mid_pred(A, B, (uint8_t)(A + B - C));
-            C        = B;
-            A        = bsrc[i];
-        }
-        if (width > 16)
-            c->llviddsp.add_median_pred(bsrc + 16, bsrc - stride2 + 16,
-                                        bsrc + 16, width - 16, &A, &B);
-
+    slice_start    = ((slice * height) / slices) & cmask;
+    slice_height   = ((((slice + 1) * height) / slices) & cmask) -
+                     slice_start;
+    slice_height >>= 1;
+    if (!slice_height)
+        return;
+
+    bsrc = src + slice_start * stride;
+
+    // first line - left neighbour prediction
+    bsrc[0] += 0x80;
+    A = c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
+    c->llviddsp.add_left_pred(bsrc + stride, bsrc + stride, width, A);
+    bsrc += stride2;
+    if (slice_height <= 1)
+        return;
+    // second line - first element has top prediction, the rest uses median
+    C        = bsrc[-stride2];
+    bsrc[0] += C;
+    A        = bsrc[0];
+    for (i = 1; i < FFMIN(width, 16); i++) { /* scalar loop (DSP need align 16) */
+        B        = bsrc[i - stride2];
+        bsrc[i] += mid_pred(A, B, (uint8_t)(A + B - C));
+        C        = B;
+        A        = bsrc[i];
+    }
+    if (width > 16)
+        c->llviddsp.add_median_pred(bsrc + 16, bsrc - stride2 + 16,
+                                    bsrc + 16, width - 16, &A, &B);
+
+    c->llviddsp.add_median_pred(bsrc + stride, bsrc - stride,
+                                    bsrc + stride, width, &A, &B);
+    bsrc += stride2;
+    // the rest of lines use continuous median prediction
+    for (j = 2; j < slice_height; j++) {
+        c->llviddsp.add_median_pred(bsrc, bsrc - stride2,
+                                        bsrc, width, &A, &B);
         c->llviddsp.add_median_pred(bsrc + stride, bsrc - stride,
                                         bsrc + stride, width, &A, &B);
         bsrc += stride2;
-        // the rest of lines use continuous median prediction
-        for (j = 2; j < slice_height; j++) {
-            c->llviddsp.add_median_pred(bsrc, bsrc - stride2,
-                                            bsrc, width, &A, &B);
-            c->llviddsp.add_median_pred(bsrc + stride, bsrc - stride,
-                                            bsrc + stride, width, &A, &B);
-            bsrc += stride2;
-        }
     }
 }
 
 static void restore_gradient_planar(UtvideoContext *c, uint8_t *src, ptrdiff_t stride,
-                                    int width, int height, int slices, int rmode)
+                                    int width, int height, int slices, int slice,
+                                    int rmode)
 {
-    int i, j, slice;
+    int i, j;
     int A, B, C;
     uint8_t *bsrc;
     int slice_start, slice_height;
     const int cmask = ~rmode;
     int min_width = FFMIN(width, 32);
 
-    for (slice = 0; slice < slices; slice++) {
-        slice_start  = ((slice * height) / slices) & cmask;
-        slice_height = ((((slice + 1) * height) / slices) & cmask) -
-                       slice_start;
-
-        if (!slice_height)
-            continue;
-        bsrc = src + slice_start * stride;
-
-        // first line - left neighbour prediction
-        bsrc[0] += 0x80;
-        c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
-        bsrc += stride;
-        if (slice_height <= 1)
-            continue;
-        for (j = 1; j < slice_height; j++) {
-            // second line - first element has top prediction, the rest uses gradient
-            bsrc[0] = (bsrc[0] + bsrc[-stride]) & 0xFF;
-            for (i = 1; i < min_width; i++) { /* dsp need align 32 */
-                A = bsrc[i - stride];
-                B = bsrc[i - (stride + 1)];
-                C = bsrc[i - 1];
-                bsrc[i] = (A - B + C + bsrc[i]) & 0xFF;
-            }
-            if (width > 32)
-                c->llviddsp.add_gradient_pred(bsrc + 32, stride, width - 32);
-            bsrc += stride;
+    slice_start  = ((slice * height) / slices) & cmask;
+    slice_height = ((((slice + 1) * height) / slices) & cmask) -
+                   slice_start;
+
+    if (!slice_height)
+        return;
+    bsrc = src + slice_start * stride;
+
+    // first line - left neighbour prediction
+    bsrc[0] += 0x80;
+    c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
+    bsrc += stride;
+    if (slice_height <= 1)
+        return;
+    for (j = 1; j < slice_height; j++) {
+        // second line - first element has top prediction, the rest uses gradient
+        bsrc[0] = (bsrc[0] + bsrc[-stride]) & 0xFF;
+        for (i = 1; i < min_width; i++) { /* dsp need align 32 */
+            A = bsrc[i - stride];
+            B = bsrc[i - (stride + 1)];
+            C = bsrc[i - 1];
+            bsrc[i] = (A - B + C + bsrc[i]) & 0xFF;
         }
+        if (width > 32)
+            c->llviddsp.add_gradient_pred(bsrc + 32, stride, width - 32);
+        bsrc += stride;
     }
 }
 
 static void restore_gradient_planar_il(UtvideoContext *c, uint8_t *src, ptrdiff_t stride,
-                                      int width, int height, int slices, int rmode)
+                                      int width, int height, int slices, int slice,
+                                       int rmode)
 {
-    int i, j, slice;
+    int i, j;
     int A, B, C;
     uint8_t *bsrc;
     int slice_start, slice_height;
@@ -553,48 +503,120 @@ static void restore_gradient_planar_il(UtvideoContext *c, uint8_t *src, ptrdiff_
     const ptrdiff_t stride2 = stride << 1;
     int min_width = FFMIN(width, 32);
 
-    for (slice = 0; slice < slices; slice++) {
-        slice_start    = ((slice * height) / slices) & cmask;
-        slice_height   = ((((slice + 1) * height) / slices) & cmask) -
-                         slice_start;
-        slice_height >>= 1;
-        if (!slice_height)
-            continue;
+    slice_start    = ((slice * height) / slices) & cmask;
+    slice_height   = ((((slice + 1) * height) / slices) & cmask) -
+                     slice_start;
+    slice_height >>= 1;
+    if (!slice_height)
+        return;
+
+    bsrc = src + slice_start * stride;
+
+    // first line - left neighbour prediction
+    bsrc[0] += 0x80;
+    A = c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
+    c->llviddsp.add_left_pred(bsrc + stride, bsrc + stride, width, A);
+    bsrc += stride2;
+    if (slice_height <= 1)
+        return;
+    for (j = 1; j < slice_height; j++) {
+        // second line - first element has top prediction, the rest uses gradient
+        bsrc[0] = (bsrc[0] + bsrc[-stride2]) & 0xFF;
+        for (i = 1; i < min_width; i++) { /* dsp need align 32 */
+            A = bsrc[i - stride2];
+            B = bsrc[i - (stride2 + 1)];
+            C = bsrc[i - 1];
+            bsrc[i] = (A - B + C + bsrc[i]) & 0xFF;
+        }
+        if (width > 32)
+            c->llviddsp.add_gradient_pred(bsrc + 32, stride2, width - 32);
+
+        A = bsrc[-stride];
+        B = bsrc[-(1 + stride + stride - width)];
+        C = bsrc[width - 1];
+        bsrc[stride] = (A - B + C + bsrc[stride]) & 0xFF;
+        for (i = 1; i < width; i++) {
+            A = bsrc[i - stride];
+            B = bsrc[i - (1 + stride)];
+            C = bsrc[i - 1 + stride];
+            bsrc[i + stride] = (A - B + C + bsrc[i + stride]) & 0xFF;
+        }
+        bsrc += stride2;
+    }
+}
 
-        bsrc = src + slice_start * stride;
+static int decode_plane_slice(AVCodecContext *avctx, void *tdata,
+                              int jobnr, int threadnr)
+{
+    UtvideoContext *c = avctx->priv_data;
+    AVFrame *f = c->frame;
+    const int plane  = jobnr / c->slices;
+    const int slice  = jobnr % c->slices;
+    const int width  = plane ? avctx->width  >> c->hshift : avctx->width;
+    const int height = plane ? avctx->height >> c->vshift : avctx->height;
+    const int rmode  = avctx->pix_fmt == AV_PIX_FMT_YUV420P && !plane;
+    uint8_t *bits = c->slice_bits + threadnr * c->slice_bits_stride;
+    int ret;
 
-        // first line - left neighbour prediction
-        bsrc[0] += 0x80;
-        A = c->llviddsp.add_left_pred(bsrc, bsrc, width, 0);
-        c->llviddsp.add_left_pred(bsrc + stride, bsrc + stride, width, A);
-        bsrc += stride2;
-        if (slice_height <= 1)
-            continue;
-        for (j = 1; j < slice_height; j++) {
-            // second line - first element has top prediction, the rest uses gradient
-            bsrc[0] = (bsrc[0] + bsrc[-stride2]) & 0xFF;
-            for (i = 1; i < min_width; i++) { /* dsp need align 32 */
-                A = bsrc[i - stride2];
-                B = bsrc[i - (stride2 + 1)];
-                C = bsrc[i - 1];
-                bsrc[i] = (A - B + C + bsrc[i]) & 0xFF;
-            }
-            if (width > 32)
-                c->llviddsp.add_gradient_pred(bsrc + 32, stride2, width - 32);
-
-            A = bsrc[-stride];
-            B = bsrc[-(1 + stride + stride - width)];
-            C = bsrc[width - 1];
-            bsrc[stride] = (A - B + C + bsrc[stride]) & 0xFF;
-            for (i = 1; i < width; i++) {
-                A = bsrc[i - stride];
-                B = bsrc[i - (1 + stride)];
-                C = bsrc[i - 1 + stride];
-                bsrc[i + stride] = (A - B + C + bsrc[i + stride]) & 0xFF;
-            }
-            bsrc += stride2;
+    if (c->pro)
+        return decode_slice10(c, plane, slice, (uint16_t *)f->data[plane],
+                              f->linesize[plane] / 2, width, height,
+                              c->plane_start[plane], bits,
+                              c->frame_pred == PRED_LEFT);
+
+    ret = decode_slice(c, plane, slice, f->data[plane], f->linesize[plane],
+                       width, height, c->plane_start[plane], bits,
+                       c->frame_pred == PRED_LEFT);
+    if (ret < 0)
+        return ret;
+
+    if (c->frame_pred == PRED_MEDIAN) {
+        if (!c->interlaced) {
+            restore_median_planar(c, f->data[plane], f->linesize[plane],
+                                  width, height, c->slices, slice, rmode);
+        } else {
+            restore_median_planar_il(c, f->data[plane], f->linesize[plane],
+                                     width, height, c->slices, slice, rmode);
+        }
+    } else if (c->frame_pred == PRED_GRADIENT) {
+        if (!c->interlaced) {
+            restore_gradient_planar(c, f->data[plane], f->linesize[plane],
+                                    width, height, c->slices, slice, rmode);
+        } else {
+            restore_gradient_planar_il(c, f->data[plane], f->linesize[plane],
+                                       width, height, c->slices, slice, rmode);
         }
     }
+
+    return 0;
+}
+
+static int restore_rgb_slice(AVCodecContext *avctx, void *tdata,
+                             int jobnr, int threadnr)
+{
+    UtvideoContext *c = avctx->priv_data;
+    AVFrame *f = c->frame;
+    const int nb_jobs = *(int *)tdata;
+    const int sstart  = avctx->height *  jobnr      / nb_jobs;
+    const int send    = avctx->height * (jobnr + 1) / nb_jobs;
+    ptrdiff_t offset[3];
+    int i;
+
+    for (i = 0; i < 3; i++)
+        offset[i] = sstart * f->linesize[i];
+
+    if (c->pro)
+        c->utdsp.restore_rgb_planes10((uint16_t *)(f->data[2] + offset[2]),
+                                      (uint16_t *)(f->data[0] + offset[0]),
+                                      (uint16_t *)(f->data[1] + offset[1]),
+                                      f->linesize[2] / 2, f->linesize[0] / 2, f->linesize[1] / 2,
+                                      avctx->width, send - sstart);
+    else
+        c->utdsp.restore_rgb_planes(f->data[2] + offset[2], f->data[0] + offset[0],
+                                    f->data[1] + offset[1],
+                                    f->linesize[2], f->linesize[0], f->linesize[1],
+                                    avctx->width, send - sstart);
+    return 0;
 }
 
 static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
@@ -604,9 +626,9 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     int buf_size = avpkt->size;
     UtvideoContext *c = avctx->priv_data;
     int i, j;
-    const uint8_t *plane_start[5];
+    const uint8_t **plane_start = c->plane_start;
     int plane_size, max_slice_size = 0, slice_start, slice_end, slice_size;
-    int ret;
+    int ret, slice_ret[4 * 256];
     GetByteContext gb;
     ThreadFrame frame = { .f = data };
 
@@ -736,169 +758,46 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
     max_slice_size += 4*avctx->width;
 
     if (!c->pack) {
+        int nb_buffers = avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1;
+
+        c->slice_bits_stride = FFALIGN(max_slice_size + AV_INPUT_BUFFER_PADDING_SIZE, 64);
         av_fast_malloc(&c->slice_bits, &c->slice_bits_size,
-                       max_slice_size + AV_INPUT_BUFFER_PADDING_SIZE);
+                       (size_t)c->slice_bits_stride * nb_buffers);
 
         if (!c->slice_bits) {
             av_log(avctx, AV_LOG_ERROR, "Cannot allocate temporary buffer\n");
             return AVERROR(ENOMEM);
         }
-    }
 
-    switch (c->avctx->pix_fmt) {
-    case AV_PIX_FMT_GBRP:
-    case AV_PIX_FMT_GBRAP:
-        for (i = 0; i < c->planes; i++) {
-            ret = decode_plane(c, i, frame.f->data[i],
-                               frame.f->linesize[i], avctx->width,
-                               avctx->height, plane_start[i],
-                               c->frame_pred == PRED_LEFT);
-            if (ret)
-                return ret;
-            if (c->frame_pred == PRED_MEDIAN) {
-                if (!c->interlaced) {
-                    restore_median_planar(c, frame.f->data[i],
-                                          frame.f->linesize[i], avctx->width,
-                                          avctx->height, c->slices, 0);
-                } else {
-                    restore_median_planar_il(c, frame.f->data[i],
-                                             frame.f->linesize[i],
-                                             avctx->width, avctx->height, c->slices,
-                                             0);
-                }
-            } else if (c->frame_pred == PRED_GRADIENT) {
-                if (!c->interlaced) {
-                    restore_gradient_planar(c, frame.f->data[i],
-                                            frame.f->linesize[i], avctx->width,
-                                            avctx->height, c->slices, 0);
-                } else {
-                    restore_gradient_planar_il(c, frame.f->data[i],
-                                               frame.f->linesize[i],
-                                               avctx->width, avctx->height, c->slices,
-                                               0);
-                }
-            }
-        }
-        c->utdsp.restore_rgb_planes(frame.f->data[2], frame.f->data[0], frame.f->data[1],
-                                    frame.f->linesize[2], frame.f->linesize[0], frame.f->linesize[1],
-                                    avctx->width, avctx->height);
-        break;
-    case AV_PIX_FMT_GBRAP10:
-    case AV_PIX_FMT_GBRP10:
         for (i = 0; i < c->planes; i++) {
-            ret = decode_plane10(c, i, (uint16_t *)frame.f->data[i],
-                                 frame.f->linesize[i] / 2, avctx->width,
-                                 avctx->height, plane_start[i],
-                                 plane_start[i + 1] - 1024,
-                                 c->frame_pred == PRED_LEFT);
-            if (ret)
-                return ret;
-        }
-        c->utdsp.restore_rgb_planes10((uint16_t *)frame.f->data[2], (uint16_t *)frame.f->data[0], (uint16_t *)frame.f->data[1],
-                                      frame.f->linesize[2] / 2, frame.f->linesize[0] / 2, frame.f->linesize[1] / 2,
-                                      avctx->width, avctx->height);
-        break;
-    case AV_PIX_FMT_YUV420P:
-        for (i = 0; i < 3; i++) {
-            ret = decode_plane(c, i, frame.f->data[i], frame.f->linesize[i],
-                               avctx->width >> !!i, avctx->height >> !!i,
-                               plane_start[i], c->frame_pred == PRED_LEFT);
-            if (ret)
-                return ret;
-            if (c->frame_pred == PRED_MEDIAN) {
-                if (!c->interlaced) {
-                    restore_median_planar(c, frame.f->data[i], frame.f->linesize[i],
-                                          avctx->width >> !!i, avctx->height >> !!i,
-                                          c->slices, !i);
-                } else {
-                    restore_median_planar_il(c, frame.f->data[i], frame.f->linesize[i],
-                                             avctx->width  >> !!i,
-                                             avctx->height >> !!i,
-                                             c->slices, !i);
-                }
-            } else if (c->frame_pred == PRED_GRADIENT) {
-                if (!c->interlaced) {
-                    restore_gradient_planar(c, frame.f->data[i], frame.f->linesize[i],
-                                            avctx->width >> !!i, avctx->height >> !!i,
-                                            c->slices, !i);
-                } else {
-                    restore_gradient_planar_il(c, frame.f->data[i], frame.f->linesize[i],
-                                               avctx->width  >> !!i,
-                                               avctx->height >> !!i,
-                                               c->slices, !i);
-                }
-            }
-        }
-        break;
-    case AV_PIX_FMT_YUV422P:
-        for (i = 0; i < 3; i++) {
-            ret = decode_plane(c, i, frame.f->data[i], frame.f->linesize[i],
-                               avctx->width >> !!i, avctx->height,
-                               plane_start[i], c->frame_pred == PRED_LEFT);
-            if (ret)
-                return ret;
-            if (c->frame_pred == PRED_MEDIAN) {
-                if (!c->interlaced) {
-                    restore_median_planar(c, frame.f->data[i], frame.f->linesize[i],
-                                          avctx->width >> !!i, avctx->height,
-                                          c->slices, 0);
-                } else {
-                    restore_median_planar_il(c, frame.f->data[i], frame.f->linesize[i],
-                                             avctx->width >> !!i, avctx->height,
-                                             c->slices, 0);
-                }
-            } else if (c->frame_pred == PRED_GRADIENT) {
-                if (!c->interlaced) {
-                    restore_gradient_planar(c, frame.f->data[i], frame.f->linesize[i],
-                                            avctx->width >> !!i, avctx->height,
-                                            c->slices, 0);
-                } else {
-                    restore_gradient_planar_il(c, frame.f->data[i], frame.f->linesize[i],
-                                               avctx->width  >> !!i, avctx->height,
-                                               c->slices, 0);
-                }
-            }
-        }
-        break;
-    case AV_PIX_FMT_YUV444P:
-        for (i = 0; i < 3; i++) {
-            ret = decode_plane(c, i, frame.f->data[i], frame.f->linesize[i],
-                               avctx->width, avctx->height,
-                               plane_start[i], c->frame_pred == PRED_LEFT);
-            if (ret)
-                return ret;
-            if (c->frame_pred == PRED_MEDIAN) {
-                if (!c->interlaced) {
-                    restore_median_planar(c, frame.f->data[i], frame.f->linesize[i],
-                                          avctx->width, avctx->height,
-                                          c->slices, 0);
-                } else {
-                    restore_median_planar_il(c, frame.f->data[i], frame.f->linesize[i],
-                                             avctx->width, avctx->height,
-                                             c->slices, 0);
-                }
-            } else if (c->frame_pred == PRED_GRADIENT) {
-                if (!c->interlaced) {
-                    restore_gradient_planar(c, frame.f->data[i], frame.f->linesize[i],
-                                            avctx->width, avctx->height,
-                                            c->slices, 0);
-                } else {
-                    restore_gradient_planar_il(c, frame.f->data[i], frame.f->linesize[i],
-                                               avctx->width, avctx->height,
-                                               c->slices, 0);
-                }
+            if (c->pro)
+                ret = build_huff10(c->plane_start[i + 1] - 1024, &c->vlc[i], &c->fsym[i]);
+            else
+                ret = build_huff(c->plane_start[i], &c->vlc[i], &c->fsym[i]);
+            if (ret) {
+                av_log(avctx, AV_LOG_ERROR, "Cannot build Huffman codes\n");
+                ret = AVERROR_INVALIDDATA;
+                goto fail;
             }
         }
-        break;
-    case AV_PIX_FMT_YUV422P10:
-        for (i = 0; i < 3; i++) {
-            ret = decode_plane10(c, i, (uint16_t *)frame.f->data[i], frame.f->linesize[i] / 2,
-                                 avctx->width >> !!i, avctx->height,
-                                 plane_start[i], plane_start[i + 1] - 1024, c->frame_pred == PRED_LEFT);
-            if (ret)
-                return ret;
+    }
+
+    c->frame = frame.f;
+    avctx->execute2(avctx, decode_plane_slice, NULL, slice_ret,
+                    c->planes * c->slices);
+    for (i = 0; i < c->planes * c->slices; i++) {
+        if (slice_ret[i] < 0) {
+            ret = slice_ret[i];
+            goto fail;
         }
-        break;
+    }
+
+    if (avctx->pix_fmt == AV_PIX_FMT_GBRP   || avctx->pix_fmt == AV_PIX_FMT_GBRAP ||
+        avctx->pix_fmt == AV_PIX_FMT_GBRP10 || avctx->pix_fmt == AV_PIX_FMT_GBRAP10) {
+        int nb_bands = avctx->active_thread_type & FF_THREAD_SLICE ? avctx->thread_count : 1;
+
+        nb_bands = FFMIN(nb_bands, avctx->height);
+        avctx->execute2(avctx, restore_rgb_slice, &nb_bands, NULL, nb_bands);
     }
 
     frame.f->key_frame = 1;
@@ -907,8 +806,12 @@ static int decode_frame(AVCodecContext *avctx, void *data, int *got_frame,
 
     *got_frame = 1;
 
+    ret = buf_size;
+fail:
+    for (i = 0; i < c->planes; i++)
+        ff_free_vlc(&c->vlc[i]);
     /* always report that the buffer was completely consumed */
-    return buf_size;
+    return ret;
 }
 
 static av_cold int decode_init(AVCodecContext *avctx)
@@ -1019,6 +922,8 @@ static av_cold int decode_init(AVCodecContext *avctx)
     }
 
     av_pix_fmt_get_chroma_sub_sample(avctx->pix_fmt, &h_shift, &v_shift);
+    c->hshift = h_shift;
+    c->vshift = v_shift;
     if ((avctx->width  & ((1<<h_shift)-1)) ||
         (avctx->height & ((1<<v_shift)-1))) {
         avpriv_request_sample(avctx, "Odd dimensions");
@@ -1086,6 +991,7 @@ AVCodec ff_utvideo_decoder = {
     .init           = decode_init,
     .close          = decode_end,
     .decode         = decode_frame,
-    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
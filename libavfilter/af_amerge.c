@@ -355,4 +355,5 @@ AVFilter ff_af_amerge = {
     .outputs       = amerge_outputs,
     .priv_class    = &amerge_class,
     .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags_internal = FF_FILTER_FLAG_QUERY_FORMATS_STATE,
 };
@@ -30,23 +30,30 @@
 #define BUFFER_ALIGN 0
 
 
+static AVFrame *get_audio_buffer(AVFilterLink *link, int nb_samples);
+
 AVFrame *ff_null_get_audio_buffer(AVFilterLink *link, int nb_samples)
 {
-    return ff_get_audio_buffer(link->dst->outputs[0], nb_samples);
+    return get_audio_buffer(link->dst->outputs[0], nb_samples);
 }
 
 AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
 {
     AVFrame *frame = NULL;
+    FFBufferCache *cache;
     int channels = link->channels;
 
     av_assert0(channels == av_get_channel_layout_nb_channels(link->channel_layout) || !av_get_channel_layout_nb_channels(link->channel_layout));
 
+    /* the destination can allocate from the pool of its input link too */
+    cache = link->graph ? link->graph->internal->buffer_cache : NULL;
+    ff_link_lock(link);
     if (!link->frame_pool) {
-        link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, channels,
+        link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, cache,
+                                                    channels,
                                                     nb_samples, link->format, BUFFER_ALIGN);
         if (!link->frame_pool)
-            return NULL;
+            goto end;
     } else {
         int pool_channels = 0;
         int pool_nb_samples = 0;
@@ -56,21 +63,24 @@ AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
         if (ff_frame_pool_get_audio_config(link->frame_pool,
                                            &pool_channels, &pool_nb_samples,
                                            &pool_format, &pool_align) < 0) {
-            return NULL;
+            goto end;
         }
 
         if (pool_channels != channels || pool_nb_samples < nb_samples ||
             pool_format != link->format || pool_align != BUFFER_ALIGN) {
 
             ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, channels,
+            link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, cache,
+                                                        channels,
                                                         nb_samples, link->format, BUFFER_ALIGN);
             if (!link->frame_pool)
-                return NULL;
+                goto end;
         }
     }
 
     frame = ff_frame_pool_get(link->frame_pool);
+end:
+    ff_link_unlock(link);
     if (!frame)
         return NULL;
 
@@ -83,7 +93,7 @@ AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
     return frame;
 }
 
-AVFrame *ff_get_audio_buffer(AVFilterLink *link, int nb_samples)
+static AVFrame *get_audio_buffer(AVFilterLink *link, int nb_samples)
 {
     AVFrame *ret = NULL;
 
@@ -95,3 +105,13 @@ AVFrame *ff_get_audio_buffer(AVFilterLink *link, int nb_samples)
 
     return ret;
 }
+
+AVFrame *ff_get_audio_buffer(AVFilterLink *link, int nb_samples)
+{
+    AVFrame *ret = get_audio_buffer(link, nb_samples);
+
+    /* accounted to the requesting filter, not the ones passing it on */
+    if (ret)
+        ff_filter_profile_alloc(link, ret);
+    return ret;
+}
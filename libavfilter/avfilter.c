@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <time.h>
+
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/buffer.h"
@@ -33,6 +35,7 @@
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -42,6 +45,7 @@
 #include "filters.h"
 #include "formats.h"
 #include "internal.h"
+#include "thread.h"
 
 #include "libavutil/ffversion.h"
 const char av_filter_ffversion[] = "FFmpeg version " FFMPEG_VERSION;
@@ -156,6 +160,11 @@ int avfilter_link(AVFilterContext *src, unsigned srcpad,
     link = av_mallocz(sizeof(*link));
     if (!link)
         return AVERROR(ENOMEM);
+    link->internal = av_mallocz(sizeof(*link->internal));
+    if (!link->internal) {
+        av_free(link);
+        return AVERROR(ENOMEM);
+    }
 
     src->outputs[srcpad] = dst->inputs[dstpad] = link;
 
@@ -179,7 +188,10 @@ void avfilter_link_free(AVFilterLink **link)
     av_frame_free(&(*link)->partial_buf);
     ff_framequeue_free(&(*link)->fifo);
     ff_frame_pool_uninit((FFFramePool**)&(*link)->frame_pool);
+    if ((*link)->internal && (*link)->internal->locked)
+        ff_mutex_destroy(&(*link)->internal->lock);
 
+    av_freep(&(*link)->internal);
     av_freep(link);
 }
 
@@ -192,7 +204,64 @@ int avfilter_link_get_channels(AVFilterLink *link)
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    AVFilterGraph *graph = filter->graph;
+
+    if (graph && graph->internal->sched) {
+        ff_graph_sched_lock(graph);
+        filter->ready = FFMAX(filter->ready, priority);
+        ff_graph_sched_unlock(graph);
+    } else {
+        filter->ready = FFMAX(filter->ready, priority);
+    }
+}
+
+void ff_link_lock(AVFilterLink *link)
+{
+    if (link->internal->locked)
+        ff_mutex_lock(&link->internal->lock);
+}
+
+void ff_link_unlock(AVFilterLink *link)
+{
+    if (link->internal->locked)
+        ff_mutex_unlock(&link->internal->lock);
+}
+
+/**
+ * Number of frames the source of a pipelined link is allowed to produce
+ * ahead of its destination.
+ */
+#define PIPELINE_QUEUE_SIZE 2
+
+static int filter_output_wanted(AVFilterContext *filter)
+{
+    unsigned i;
+    int wanted = 0;
+
+    for (i = 0; i < filter->nb_outputs && !wanted; i++) {
+        AVFilterLink *link = filter->outputs[i];
+        ff_link_lock(link);
+        wanted = link->frame_wanted_out;
+        ff_link_unlock(link);
+    }
+    return wanted;
+}
+
+/**
+ * Keep the queue of a pipelined link filled, so that its source works on
+ * the next frames while the destination processes the current one, as
+ * long as frames are wanted further down the chain.
+ * Must be called with the link locked.
+ */
+static void link_prefetch(AVFilterLink *link)
+{
+    if (link->internal->pipelined && !link->frame_wanted_out &&
+        !link->status_in && !link->status_out &&
+        ff_framequeue_queued_frames(&link->fifo) < PIPELINE_QUEUE_SIZE &&
+        filter_output_wanted(link->dst)) {
+        link->frame_wanted_out = 1;
+        ff_filter_set_ready(link->src, 100);
+    }
 }
 
 /**
@@ -203,15 +272,23 @@ static void filter_unblock(AVFilterContext *filter)
 {
     unsigned i;
 
-    for (i = 0; i < filter->nb_outputs; i++)
-        filter->outputs[i]->frame_blocked_in = 0;
+    for (i = 0; i < filter->nb_outputs; i++) {
+        AVFilterLink *link = filter->outputs[i];
+        ff_link_lock(link);
+        link->frame_blocked_in = 0;
+        ff_link_unlock(link);
+    }
 }
 
 
 void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
 {
-    if (link->status_in == status)
+    ff_link_lock(link);
+    /* with pipelining, the destination may have closed the link meanwhile */
+    if (link->status_in == status || (link->internal->pipelined && link->status_in)) {
+        ff_link_unlock(link);
         return;
+    }
     av_assert0(!link->status_in);
     link->status_in = status;
     link->status_in_pts = pts;
@@ -219,12 +296,15 @@ void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
     link->frame_blocked_in = 0;
     filter_unblock(link->dst);
     ff_filter_set_ready(link->dst, 200);
+    ff_link_unlock(link);
 }
 
-void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts)
+static void link_set_out_status(AVFilterLink *link, int status, int64_t pts)
 {
-    av_assert0(!link->frame_wanted_out);
+    /* a pipelined link can have been requested ahead */
+    av_assert0(!link->frame_wanted_out || link->internal->pipelined);
     av_assert0(!link->status_out);
+    link->frame_wanted_out = 0;
     link->status_out = status;
     if (pts != AV_NOPTS_VALUE)
         ff_update_link_current_pts(link, pts);
@@ -232,6 +312,13 @@ void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts
     ff_filter_set_ready(link->src, 200);
 }
 
+void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts)
+{
+    ff_link_lock(link);
+    link_set_out_status(link, status, pts);
+    ff_link_unlock(link);
+}
+
 void avfilter_link_set_closed(AVFilterLink *link, int closed)
 {
     ff_avfilter_link_set_out_status(link, closed ? AVERROR_EOF : 0, AV_NOPTS_VALUE);
@@ -406,27 +493,31 @@ void ff_tlog_link(void *ctx, AVFilterLink *link, int end)
 
 int ff_request_frame(AVFilterLink *link)
 {
+    int ret = 0;
+
     FF_TPRINTF_START(NULL, request_frame); ff_tlog_link(NULL, link, 1);
 
     av_assert1(!link->dst->filter->activate);
-    if (link->status_out)
-        return link->status_out;
-    if (link->status_in) {
+    ff_link_lock(link);
+    if (link->status_out) {
+        ret = link->status_out;
+    } else if (link->status_in) {
         if (ff_framequeue_queued_frames(&link->fifo)) {
             av_assert1(!link->frame_wanted_out);
             av_assert1(link->dst->ready >= 300);
-            return 0;
         } else {
             /* Acknowledge status change. Filters using ff_request_frame() will
                handle the change automatically. Filters can also check the
                status directly but none do yet. */
-            ff_avfilter_link_set_out_status(link, link->status_in, link->status_in_pts);
-            return link->status_out;
+            link_set_out_status(link, link->status_in, link->status_in_pts);
+            ret = link->status_out;
         }
+    } else {
+        link->frame_wanted_out = 1;
+        ff_filter_set_ready(link->src, 100);
     }
-    link->frame_wanted_out = 1;
-    ff_filter_set_ready(link->src, 100);
-    return 0;
+    ff_link_unlock(link);
+    return ret;
 }
 
 static int64_t guess_status_pts(AVFilterContext *ctx, int status, AVRational link_time_base)
@@ -440,8 +531,11 @@ static int64_t guess_status_pts(AVFilterContext *ctx, int status, AVRational lin
     if (r < INT64_MAX)
         return r;
     av_log(ctx, AV_LOG_WARNING, "EOF timestamp not reliable\n");
-    for (i = 0; i < ctx->nb_inputs; i++)
+    for (i = 0; i < ctx->nb_inputs; i++) {
+        ff_link_lock(ctx->inputs[i]);
         r = FFMIN(r, av_rescale_q(ctx->inputs[i]->status_in_pts, ctx->inputs[i]->time_base, link_time_base));
+        ff_link_unlock(ctx->inputs[i]);
+    }
     if (r < INT64_MAX)
         return r;
     return AV_NOPTS_VALUE;
@@ -453,13 +547,15 @@ static int ff_request_frame_to_filter(AVFilterLink *link)
 
     FF_TPRINTF_START(NULL, request_frame_to_filter); ff_tlog_link(NULL, link, 1);
     /* Assume the filter is blocked, let the method clear it if not */
+    ff_link_lock(link);
     link->frame_blocked_in = 1;
+    ff_link_unlock(link);
     if (link->srcpad->request_frame)
         ret = link->srcpad->request_frame(link);
     else if (link->src->inputs[0])
         ret = ff_request_frame(link->src->inputs[0]);
     if (ret < 0) {
-        if (ret != AVERROR(EAGAIN) && ret != link->status_in)
+        if (ret != AVERROR(EAGAIN) && ret != ff_outlink_get_status(link))
             ff_avfilter_link_set_in_status(link, ret, guess_status_pts(link->src, ret, link->time_base));
         if (ret == AVERROR_EOF)
             ret = 0;
@@ -548,10 +644,16 @@ void ff_update_link_current_pts(AVFilterLink *link, int64_t pts)
     if (pts == AV_NOPTS_VALUE)
         return;
     link->current_pts = pts;
-    link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
-    if (link->graph && link->age_index >= 0)
+    if (link->graph && link->age_index >= 0) {
+        /* sinks can be activated concurrently by the graph scheduler */
+        ff_graph_sched_lock(link->graph);
+        link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
         ff_avfilter_graph_update_heap(link->graph, link);
+        ff_graph_sched_unlock(link->graph);
+    } else {
+        link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
+    }
 }
 
 int avfilter_process_command(AVFilterContext *filter, const char *cmd, const char *arg, char *res, int res_len, int flags)
@@ -719,6 +821,10 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
             goto err;
     }
 
+    atomic_init(&ret->internal->active, 0);
+    if (ff_mutex_init(&ret->internal->profile_lock, NULL))
+        goto err;
+
     return ret;
 
 err:
@@ -795,6 +901,7 @@ void avfilter_free(AVFilterContext *filter)
     av_expr_free(filter->enable);
     filter->enable = NULL;
     av_freep(&filter->var_values);
+    ff_mutex_destroy(&filter->internal->profile_lock);
     av_freep(&filter->internal);
     av_free(filter);
 }
@@ -1112,15 +1219,24 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
         }
     }
 
+    ff_link_lock(link);
     link->frame_blocked_in = link->frame_wanted_out = 0;
     link->frame_count_in++;
     filter_unblock(link->dst);
     ret = ff_framequeue_add(&link->fifo, frame);
+    if (ret >= 0) {
+        link->max_queued_frames  = FFMAX(link->max_queued_frames,
+                                         ff_framequeue_queued_frames(&link->fifo));
+        link->max_queued_samples = FFMAX(link->max_queued_samples,
+                                         ff_framequeue_queued_samples(&link->fifo));
+        link_prefetch(link);
+        ff_filter_set_ready(link->dst, 300);
+    }
+    ff_link_unlock(link);
     if (ret < 0) {
         av_frame_free(&frame);
         return ret;
     }
-    ff_filter_set_ready(link->dst, 300);
     return 0;
 
 error:
@@ -1130,9 +1246,14 @@ error:
 
 static int samples_ready(AVFilterLink *link, unsigned min)
 {
-    return ff_framequeue_queued_frames(&link->fifo) &&
-           (ff_framequeue_queued_samples(&link->fifo) >= min ||
-            link->status_in);
+    int ret;
+
+    ff_link_lock(link);
+    ret = ff_framequeue_queued_frames(&link->fifo) &&
+          (ff_framequeue_queued_samples(&link->fifo) >= min ||
+           link->status_in);
+    ff_link_unlock(link);
+    return ret;
 }
 
 static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
@@ -1145,9 +1266,12 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
     /* Note: this function relies on no format changes and must only be
        called with enough samples. */
     av_assert1(samples_ready(link, link->min_samples));
+    ff_link_lock(link);
     frame0 = frame = ff_framequeue_peek(&link->fifo, 0);
     if (!link->fifo.samples_skipped && frame->nb_samples >= min && frame->nb_samples <= max) {
         *rframe = ff_framequeue_take(&link->fifo);
+        link_prefetch(link);
+        ff_link_unlock(link);
         return 0;
     }
     nb_frames = 0;
@@ -1164,6 +1288,9 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
             break;
         frame = ff_framequeue_peek(&link->fifo, nb_frames);
     }
+    /* only the destination takes frames from the queue, the frames counted
+       above stay there while the buffer is allocated */
+    ff_link_unlock(link);
 
     buf = ff_get_audio_buffer(link, nb_samples);
     if (!buf)
@@ -1175,6 +1302,7 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
     }
     buf->pts = frame0->pts;
 
+    ff_link_lock(link);
     p = 0;
     for (i = 0; i < nb_frames; i++) {
         frame = ff_framequeue_take(&link->fifo);
@@ -1190,6 +1318,8 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
                         link->channels, link->format);
         ff_framequeue_skip_samples(&link->fifo, n, link->time_base);
     }
+    link_prefetch(link);
+    ff_link_unlock(link);
 
     *rframe = buf;
     return 0;
@@ -1201,7 +1331,7 @@ static int ff_filter_frame_to_filter(AVFilterLink *link)
     AVFilterContext *dst = link->dst;
     int ret;
 
-    av_assert1(ff_framequeue_queued_frames(&link->fifo));
+    av_assert1(ff_inlink_queued_frames(link));
     ret = link->min_samples ?
           ff_inlink_consume_samples(link, link->min_samples, link->max_samples, &frame) :
           ff_inlink_consume_frame(link, &frame);
@@ -1238,7 +1368,7 @@ static int forward_status_change(AVFilterContext *filter, AVFilterLink *in)
         return 0;
     }
     while (!in->status_out) {
-        if (!filter->outputs[out]->status_in) {
+        if (!ff_outlink_get_status(filter->outputs[out])) {
             progress++;
             ret = ff_request_frame_to_filter(filter->outputs[out]);
             if (ret < 0)
@@ -1269,16 +1399,26 @@ static int ff_filter_activate_default(AVFilterContext *filter)
         }
     }
     for (i = 0; i < filter->nb_inputs; i++) {
-        if (filter->inputs[i]->status_in && !filter->inputs[i]->status_out) {
-            av_assert1(!ff_framequeue_queued_frames(&filter->inputs[i]->fifo));
-            return forward_status_change(filter, filter->inputs[i]);
+        AVFilterLink *link = filter->inputs[i];
+        int status_in;
+
+        ff_link_lock(link);
+        status_in = link->status_in;
+        ff_link_unlock(link);
+        if (status_in && !link->status_out) {
+            av_assert1(!ff_inlink_queued_frames(link));
+            return forward_status_change(filter, link);
         }
     }
     for (i = 0; i < filter->nb_outputs; i++) {
-        if (filter->outputs[i]->frame_wanted_out &&
-            !filter->outputs[i]->frame_blocked_in) {
-            return ff_request_frame_to_filter(filter->outputs[i]);
-        }
+        AVFilterLink *link = filter->outputs[i];
+        int wanted;
+
+        ff_link_lock(link);
+        wanted = link->frame_wanted_out && !link->frame_blocked_in;
+        ff_link_unlock(link);
+        if (wanted)
+            return ff_request_frame_to_filter(link);
     }
     return FFERROR_NOT_READY;
 }
@@ -1418,58 +1558,174 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
  */
 
+static int64_t thread_cpu_time(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+
+    if (!clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return ts.tv_sec * INT64_C(1000000) + ts.tv_nsec / 1000;
+#endif
+    return 0;
+}
+
 int ff_filter_activate(AVFilterContext *filter)
 {
+    int profile = filter->graph && filter->graph->internal->profile;
+    int64_t wall_time = 0, cpu_time = 0;
     int ret;
 
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
-    filter->ready = 0;
+    if (profile) {
+        atomic_store(&filter->internal->active, 1);
+        wall_time = av_gettime_relative();
+        cpu_time  = thread_cpu_time();
+    }
+    /* the graph scheduler clears it under its lock when picking the filter,
+     * clearing it here could lose a concurrent ff_filter_set_ready() */
+    if (!filter->graph || !filter->graph->internal->sched)
+        filter->ready = 0;
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
     if (ret == FFERROR_NOT_READY)
         ret = 0;
+    if (profile) {
+        AVFilterProfile *p = &filter->internal->profile;
+        wall_time = av_gettime_relative() - wall_time;
+        cpu_time  = thread_cpu_time() - cpu_time;
+        ff_mutex_lock(&filter->internal->profile_lock);
+        p->nb_activations++;
+        p->wall_time += wall_time;
+        p->cpu_time  += cpu_time;
+        ff_mutex_unlock(&filter->internal->profile_lock);
+        atomic_store(&filter->internal->active, 0);
+    }
     return ret;
 }
 
+void ff_filter_profile_alloc(AVFilterLink *link, const AVFrame *frame)
+{
+    AVFilterContext *filter;
+    int64_t bytes = 0;
+    int i;
+
+    if (!link->graph || !link->graph->internal->profile)
+        return;
+    /* Filters request buffers on their outputs as well as on their inputs.
+     * With neither end being activated, the request is forwarded by a
+     * get_video_buffer callback and already accounted to the filter that
+     * made it, or made while configuring the graph. */
+    if (atomic_load(&link->src->internal->active))
+        filter = link->src;
+    else if (atomic_load(&link->dst->internal->active))
+        filter = link->dst;
+    else
+        return;
+    for (i = 0; i < FF_ARRAY_ELEMS(frame->buf) && frame->buf[i]; i++)
+        bytes += frame->buf[i]->size;
+    for (i = 0; i < frame->nb_extended_buf; i++)
+        bytes += frame->extended_buf[i]->size;
+    ff_mutex_lock(&filter->internal->profile_lock);
+    filter->internal->profile.bytes_allocated += bytes;
+    ff_mutex_unlock(&filter->internal->profile_lock);
+}
+
+int avfilter_get_profile(AVFilterContext *filter, AVFilterProfile *profile)
+{
+    int i;
+
+    if (!filter->graph || !filter->graph->internal->profile)
+        return AVERROR(EINVAL);
+    ff_mutex_lock(&filter->internal->profile_lock);
+    *profile = filter->internal->profile;
+    ff_mutex_unlock(&filter->internal->profile_lock);
+    for (i = 0; i < filter->nb_inputs; i++)
+        if (filter->inputs[i])
+            profile->frames_in  += filter->inputs[i]->frame_count_out;
+    for (i = 0; i < filter->nb_outputs; i++)
+        if (filter->outputs[i])
+            profile->frames_out += filter->outputs[i]->frame_count_in;
+    return 0;
+}
+
+int avfilter_link_get_profile(AVFilterLink *link, AVFilterLinkProfile *profile)
+{
+    if (!link->graph || !link->graph->internal->profile)
+        return AVERROR(EINVAL);
+    ff_link_lock(link);
+    profile->frames             = link->frame_count_in;
+    profile->max_queued_frames  = link->max_queued_frames;
+    profile->max_queued_samples = link->max_queued_samples;
+    ff_link_unlock(link);
+    return 0;
+}
+
 int ff_inlink_acknowledge_status(AVFilterLink *link, int *rstatus, int64_t *rpts)
 {
+    int ret;
+
     *rpts = link->current_pts;
-    if (ff_framequeue_queued_frames(&link->fifo))
-        return *rstatus = 0;
-    if (link->status_out)
-        return *rstatus = link->status_out;
-    if (!link->status_in)
-        return *rstatus = 0;
-    *rstatus = link->status_out = link->status_in;
-    ff_update_link_current_pts(link, link->status_in_pts);
-    *rpts = link->current_pts;
-    return 1;
+    ff_link_lock(link);
+    if (ff_framequeue_queued_frames(&link->fifo)) {
+        ret = *rstatus = 0;
+    } else if (link->status_out) {
+        ret = *rstatus = link->status_out;
+    } else if (!link->status_in) {
+        ret = *rstatus = 0;
+    } else {
+        *rstatus = link->status_out = link->status_in;
+        ff_update_link_current_pts(link, link->status_in_pts);
+        *rpts = link->current_pts;
+        ret = 1;
+    }
+    ff_link_unlock(link);
+    return ret;
 }
 
 size_t ff_inlink_queued_frames(AVFilterLink *link)
 {
-    return ff_framequeue_queued_frames(&link->fifo);
+    size_t ret;
+
+    ff_link_lock(link);
+    ret = ff_framequeue_queued_frames(&link->fifo);
+    ff_link_unlock(link);
+    return ret;
 }
 
 int ff_inlink_check_available_frame(AVFilterLink *link)
 {
-    return ff_framequeue_queued_frames(&link->fifo) > 0;
+    return ff_inlink_queued_frames(link) > 0;
 }
 
 int ff_inlink_queued_samples(AVFilterLink *link)
 {
-    return ff_framequeue_queued_samples(&link->fifo);
+    int ret;
+
+    ff_link_lock(link);
+    ret = ff_framequeue_queued_samples(&link->fifo);
+    ff_link_unlock(link);
+    return ret;
 }
 
-int ff_inlink_check_available_samples(AVFilterLink *link, unsigned min)
+static int check_available_samples(AVFilterLink *link, unsigned min)
 {
     uint64_t samples = ff_framequeue_queued_samples(&link->fifo);
     av_assert1(min);
     return samples >= min || (link->status_in && samples);
 }
 
+int ff_inlink_check_available_samples(AVFilterLink *link, unsigned min)
+{
+    int ret;
+
+    ff_link_lock(link);
+    ret = check_available_samples(link, min);
+    ff_link_unlock(link);
+    return ret;
+}
+
 static void consume_update(AVFilterLink *link, const AVFrame *frame)
 {
     ff_update_link_current_pts(link, frame->pts);
@@ -1483,15 +1739,21 @@ int ff_inlink_consume_frame(AVFilterLink *link, AVFrame **rframe)
     AVFrame *frame;
 
     *rframe = NULL;
-    if (!ff_inlink_check_available_frame(link))
+    ff_link_lock(link);
+    if (!ff_framequeue_queued_frames(&link->fifo)) {
+        ff_link_unlock(link);
         return 0;
+    }
 
     if (link->fifo.samples_skipped) {
         frame = ff_framequeue_peek(&link->fifo, 0);
+        ff_link_unlock(link);
         return ff_inlink_consume_samples(link, frame->nb_samples, frame->nb_samples, rframe);
     }
 
     frame = ff_framequeue_take(&link->fifo);
+    link_prefetch(link);
+    ff_link_unlock(link);
     consume_update(link, frame);
     *rframe = frame;
     return 1;
@@ -1505,10 +1767,14 @@ int ff_inlink_consume_samples(AVFilterLink *link, unsigned min, unsigned max,
 
     av_assert1(min);
     *rframe = NULL;
-    if (!ff_inlink_check_available_samples(link, min))
+    ff_link_lock(link);
+    if (!check_available_samples(link, min)) {
+        ff_link_unlock(link);
         return 0;
+    }
     if (link->status_in)
         min = FFMIN(min, ff_framequeue_queued_samples(&link->fifo));
+    ff_link_unlock(link);
     ret = take_samples(link, min, max, &frame);
     if (ret < 0)
         return ret;
@@ -1519,7 +1785,12 @@ int ff_inlink_consume_samples(AVFilterLink *link, unsigned min, unsigned max,
 
 AVFrame *ff_inlink_peek_frame(AVFilterLink *link, size_t idx)
 {
-    return ff_framequeue_peek(&link->fifo, idx);
+    AVFrame *frame;
+
+    ff_link_lock(link);
+    frame = ff_framequeue_peek(&link->fifo, idx);
+    ff_link_unlock(link);
+    return frame;
 }
 
 int ff_inlink_make_frame_writable(AVFilterLink *link, AVFrame **rframe)
@@ -1606,30 +1877,52 @@ int ff_inlink_evaluate_timeline_at_frame(AVFilterLink *link, const AVFrame *fram
 
 void ff_inlink_request_frame(AVFilterLink *link)
 {
-    av_assert1(!link->status_in);
+    ff_link_lock(link);
+    /* with pipelining, the source can change the status at any time */
+    av_assert1(link->internal->pipelined || !link->status_in);
     av_assert1(!link->status_out);
-    link->frame_wanted_out = 1;
-    ff_filter_set_ready(link->src, 100);
+    if (!link->status_in) {
+        link->frame_wanted_out = 1;
+        ff_filter_set_ready(link->src, 100);
+    }
+    ff_link_unlock(link);
 }
 
 void ff_inlink_set_status(AVFilterLink *link, int status)
 {
     if (link->status_out)
         return;
+    ff_link_lock(link);
     link->frame_wanted_out = 0;
     link->frame_blocked_in = 0;
-    ff_avfilter_link_set_out_status(link, status, AV_NOPTS_VALUE);
+    link_set_out_status(link, status, AV_NOPTS_VALUE);
     while (ff_framequeue_queued_frames(&link->fifo)) {
            AVFrame *frame = ff_framequeue_take(&link->fifo);
            av_frame_free(&frame);
     }
     if (!link->status_in)
         link->status_in = status;
+    ff_link_unlock(link);
+}
+
+int ff_outlink_frame_wanted(AVFilterLink *link)
+{
+    int ret;
+
+    ff_link_lock(link);
+    ret = link->frame_wanted_out;
+    ff_link_unlock(link);
+    return ret;
 }
 
 int ff_outlink_get_status(AVFilterLink *link)
 {
-    return link->status_in;
+    int ret;
+
+    ff_link_lock(link);
+    ret = link->status_in;
+    ff_link_unlock(link);
+    return ret;
 }
 
 const AVClass *avfilter_get_class(void)
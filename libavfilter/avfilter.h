@@ -332,6 +332,21 @@ typedef struct AVFilter {
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Activate independent filters of the graph concurrently.
+ * Only meaningful for AVFilterGraph.thread_type and only with the
+ * graph's internal thread pool.
+ */
+#define AVFILTER_THREAD_GRAPH (1 << 1)
+
+/**
+ * Run linear chains of filters of the graph as a pipeline, each filter
+ * working on its own frame concurrently with its neighbours.
+ * Only meaningful for AVFilterGraph.thread_type; implies
+ * AVFILTER_THREAD_GRAPH.
+ */
+#define AVFILTER_THREAD_PIPELINE (1 << 2)
+
 typedef struct AVFilterInternal AVFilterInternal;
 
 /** An instance of a filter */
@@ -642,6 +657,17 @@ struct AVFilterLink {
      */
     int status_out;
 
+    /**
+     * Threading state of the link.
+     */
+    struct AVFilterLinkInternal *internal;
+
+    /**
+     * Highest number of frames and samples queued in fifo.
+     */
+    unsigned max_queued_frames;
+    uint64_t max_queued_samples;
+
 #endif /* FF_INTERNAL_FIELDS */
 
 };
@@ -858,6 +884,9 @@ typedef struct AVFilterGraph {
      * bit AND with AVFilterContext.thread_type to get the final mask used for
      * determining allowed threading types. I.e. a threading type needs to be
      * set in both to be allowed.
+     *
+     * AVFILTER_THREAD_GRAPH and AVFILTER_THREAD_PIPELINE are not set by
+     * default and must be set before adding any filters to the filtergraph.
      */
     int thread_type;
 
@@ -896,6 +925,20 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Collect profiling counters for the filters and the links of the
+     * graph, see avfilter_get_profile() and avfilter_link_get_profile().
+     * Must be set before avfilter_graph_config().
+     */
+    int profile;
+
+    /**
+     * If set, profiling is enabled and the profile of the graph is written
+     * to this file, as JSON, when the graph is freed.
+     * Access ONLY through AVOptions.
+     */
+    char *profile_file;
+
     /**
      * Private fields
      *
@@ -985,6 +1028,54 @@ enum {
  */
 int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx);
 
+/**
+ * Result of the format negotiation of a configured filter graph, to be
+ * reused when configuring graphs built the same way.
+ */
+typedef struct AVFilterGraphTemplate AVFilterGraphTemplate;
+
+/**
+ * Create a template from a filter graph configured with
+ * avfilter_graph_config().
+ *
+ * The template records the formats negotiated on each link and the
+ * conversion filters inserted automatically, identifying filters by
+ * their instance names. It does not reference the graph, which can be
+ * freed afterwards, and can be used by several threads at once.
+ *
+ * @param tmpl pointer set to the new template
+ * @param graph a configured filter graph
+ * @return >= 0 in case of success, a negative AVERROR code otherwise;
+ *         AVERROR(EINVAL) if the filters do not all have distinct names
+ */
+int avfilter_graph_template_create(AVFilterGraphTemplate **tmpl,
+                                   const AVFilterGraph *graph);
+
+/**
+ * Free a graph template and set *tmpl to NULL.
+ */
+void avfilter_graph_template_free(AVFilterGraphTemplate **tmpl);
+
+/**
+ * Check validity and configure all the links and formats in the graph,
+ * taking the formats from a template instead of negotiating them.
+ *
+ * The graph must contain the same filters, with the same names, options
+ * and links, as the one the template was created from, typically by
+ * parsing the same description. The sources and sinks are checked
+ * against the template, so their parameters can differ as long as the
+ * formats are still supported. If the graph does not match, the formats
+ * are negotiated as with avfilter_graph_config().
+ *
+ * @param graphctx the filter graph
+ * @param tmpl the template
+ * @param log_ctx context used for logging
+ * @return >= 0 in case of success, a negative AVERROR code otherwise
+ */
+int avfilter_graph_config_template(AVFilterGraph *graphctx,
+                                   const AVFilterGraphTemplate *tmpl,
+                                   void *log_ctx);
+
 /**
  * Free a graph, destroy its links, and set *graph to NULL.
  * If *graph is NULL, do nothing.
@@ -1131,6 +1222,66 @@ int avfilter_graph_send_command(AVFilterGraph *graph, const char *target, const
 int avfilter_graph_queue_command(AVFilterGraph *graph, const char *target, const char *cmd, const char *arg, int flags, double ts);
 
 
+/**
+ * Profiling counters of a filter, see AVFilterGraph.profile.
+ * New fields can be added to the end with minor version bumps.
+ */
+typedef struct AVFilterProfile {
+    int64_t nb_activations;     ///< number of activations of the filter
+    int64_t wall_time;          ///< total wall clock time spent activating it, in microseconds
+    /**
+     * Total CPU time of the threads activating the filter, in
+     * microseconds, 0 if not supported on the platform.
+     */
+    int64_t cpu_time;
+    int64_t frames_in;          ///< frames consumed from the inputs
+    int64_t frames_out;         ///< frames sent to the outputs
+    /**
+     * Bytes of frame buffers requested by the filter while it is
+     * activated, usually for its outputs.
+     */
+    int64_t bytes_allocated;
+} AVFilterProfile;
+
+/**
+ * Profiling counters of a link, see AVFilterGraph.profile.
+ * New fields can be added to the end with minor version bumps.
+ */
+typedef struct AVFilterLinkProfile {
+    int64_t frames;             ///< frames sent on the link
+    int64_t max_queued_frames;  ///< highest number of frames queued on the link
+    int64_t max_queued_samples; ///< highest number of samples queued on the link
+} AVFilterLinkProfile;
+
+/**
+ * Get the profiling counters of a filter. The counters are updated while
+ * the graph is running and should be read between calls to it.
+ *
+ * @return >= 0 in case of success, AVERROR(EINVAL) if profiling is not
+ *         enabled in the graph of the filter
+ */
+int avfilter_get_profile(AVFilterContext *filter, AVFilterProfile *profile);
+
+/**
+ * Get the profiling counters of a link.
+ *
+ * @return >= 0 in case of success, AVERROR(EINVAL) if profiling is not
+ *         enabled in the graph of the link
+ */
+int avfilter_link_get_profile(AVFilterLink *link, AVFilterLinkProfile *profile);
+
+/**
+ * Dump the profiling counters of all the filters and links of a graph
+ * as a JSON object.
+ *
+ * @param graph    the graph to dump
+ * @param options  formatting options; currently ignored
+ * @return  a string, or NULL in case of memory allocation failure or if
+ *          profiling is not enabled in the graph; the string must be freed
+ *          using av_free
+ */
+char *avfilter_graph_dump_profile(AVFilterGraph *graph, const char *options);
+
 /**
  * Dump a graph into a human-readable string representation.
  *
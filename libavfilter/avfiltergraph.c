@@ -28,10 +28,12 @@
 #include "libavutil/avstring.h"
 #include "libavutil/bprint.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/crc.h"
 #include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -50,12 +52,18 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = F|V|A, .unit = "thread_type" },
+        { "pipeline", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_PIPELINE }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads),
         AV_OPT_TYPE_INT,   { .i64 = 0 }, 0, INT_MAX, F|V|A },
     {"scale_sws_opts"       , "default scale filter options"        , OFFSET(scale_sws_opts)        ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|V },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|A },
+    { "profile",     "Collect filter and link profiling counters", OFFSET(profile),
+        AV_OPT_TYPE_BOOL,  { .i64 = 0 }, 0, 1, F|V|A },
+    { "profile_file", "Write the profile as JSON to this file when the graph is freed",
+        OFFSET(profile_file), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, F|V|A },
     { NULL },
 };
 
@@ -72,6 +80,24 @@ void ff_graph_thread_free(AVFilterGraph *graph)
 {
 }
 
+int ff_graph_sched_run(AVFilterGraph *graph)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_graph_sched_lock(AVFilterGraph *graph)
+{
+}
+
+void ff_graph_sched_unlock(AVFilterGraph *graph)
+{
+}
+
+int ff_graph_sched_config(AVFilterGraph *graph)
+{
+    return 0;
+}
+
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
     graph->thread_type = 0;
@@ -92,6 +118,13 @@ AVFilterGraph *avfilter_graph_alloc(void)
         return NULL;
     }
 
+    ret->internal->buffer_cache = ff_buffer_cache_alloc();
+    if (!ret->internal->buffer_cache) {
+        av_freep(&ret->internal);
+        av_freep(&ret);
+        return NULL;
+    }
+
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&ret->internal->frame_queues);
@@ -117,20 +150,54 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
     }
 }
 
+static void write_profile(AVFilterGraph *graph)
+{
+    char *json = avfilter_graph_dump_profile(graph, NULL);
+    FILE *f;
+
+    if (!json)
+        return;
+    f = av_fopen_utf8(graph->profile_file, "w");
+    if (!f || fputs(json, f) < 0)
+        av_log(graph, AV_LOG_ERROR, "Could not write the profile to '%s'\n",
+               graph->profile_file);
+    if (f)
+        fclose(f);
+    av_free(json);
+}
+
 void avfilter_graph_free(AVFilterGraph **graph)
 {
     if (!*graph)
         return;
 
+    if ((*graph)->internal->profile && (*graph)->profile_file)
+        write_profile(*graph);
+
     while ((*graph)->nb_filters)
         avfilter_free((*graph)->filters[0]);
 
     ff_graph_thread_free(*graph);
 
+    if ((*graph)->internal->buffer_cache) {
+        FFBufferCacheStats stats;
+
+        ff_buffer_cache_get_stats((*graph)->internal->buffer_cache, &stats);
+        if (stats.nb_allocs)
+            av_log(*graph, AV_LOG_VERBOSE,
+                   "Frame buffers: %"PRIu64" allocations, %"PRIu64" reuses, "
+                   "peak %"PRIu64" bytes allocated, %"PRIu64" bytes in use\n",
+                   stats.nb_allocs, stats.nb_reuses,
+                   stats.allocated_peak, stats.in_use_peak);
+        /* buffers still referenced outside the graph keep it alive */
+        ff_buffer_cache_uninit(&(*graph)->internal->buffer_cache);
+    }
+
     av_freep(&(*graph)->sink_links);
 
     av_freep(&(*graph)->scale_sws_opts);
     av_freep(&(*graph)->aresample_swr_opts);
+    av_freep(&(*graph)->profile_file);
 #if FF_API_LAVR_OPTS
     av_freep(&(*graph)->resample_lavr_opts);
 #endif
@@ -565,6 +632,7 @@ static int query_formats(AVFilterGraph *graph, AVClass *log_ctx)
 
                 if ((ret = avfilter_insert_filter(link, convert, 0, 0)) < 0)
                     return ret;
+                convert->internal->auto_convert = 1;
 
                 if ((ret = filter_query_formats(convert)) < 0)
                     return ret;
@@ -1184,6 +1252,513 @@ static int graph_config_formats(AVFilterGraph *graph, AVClass *log_ctx)
     return 0;
 }
 
+typedef struct TemplateFilter {
+    char *name;
+    const AVFilter *filter;
+    uint32_t opts_crc;          ///< CRC of the serialized options
+} TemplateFilter;
+
+typedef struct TemplateLink {
+    char *src, *dst;            ///< names of the filters
+    const AVFilter *srcf, *dstf;
+    int srcpad, dstpad;
+    enum AVMediaType type;
+    int format;
+    int sample_rate;
+    uint64_t channel_layout;
+    int channels;
+} TemplateLink;
+
+typedef struct TemplateConvert {
+    const AVFilter *filter;
+    char *name;
+    int in, out;                ///< indexes of the links of the filter
+} TemplateConvert;
+
+struct AVFilterGraphTemplate {
+    TemplateFilter  *filters;
+    int           nb_filters;
+    TemplateLink    *links;
+    int           nb_links;
+    TemplateConvert *converts;
+    int           nb_converts;
+};
+
+void avfilter_graph_template_free(AVFilterGraphTemplate **tmpl)
+{
+    int i;
+
+    if (!*tmpl)
+        return;
+    for (i = 0; i < (*tmpl)->nb_filters; i++)
+        av_freep(&(*tmpl)->filters[i].name);
+    for (i = 0; i < (*tmpl)->nb_links; i++) {
+        av_freep(&(*tmpl)->links[i].src);
+        av_freep(&(*tmpl)->links[i].dst);
+    }
+    for (i = 0; i < (*tmpl)->nb_converts; i++)
+        av_freep(&(*tmpl)->converts[i].name);
+    av_freep(&(*tmpl)->filters);
+    av_freep(&(*tmpl)->links);
+    av_freep(&(*tmpl)->converts);
+    av_freep(tmpl);
+}
+
+static int template_find_link(const AVFilterGraphTemplate *tmpl,
+                              const char *src, int srcpad,
+                              const char *dst, int dstpad)
+{
+    int i;
+
+    for (i = 0; i < tmpl->nb_links; i++) {
+        const TemplateLink *l = &tmpl->links[i];
+        if (l->srcpad == srcpad && l->dstpad == dstpad &&
+            !strcmp(l->src, src) && !strcmp(l->dst, dst))
+            return i;
+    }
+    return -1;
+}
+
+static int filter_opts_crc(AVFilterContext *f, uint32_t *crc)
+{
+    char *opts = NULL;
+    int ret;
+
+    /* the parameters of sources and sinks are checked when querying them */
+    *crc = 0;
+    if (!f->filter->priv_class || !f->nb_inputs || !f->nb_outputs)
+        return 0;
+    ret = av_opt_serialize(f->priv, 0, 0, &opts, '=', ':');
+    if (ret < 0)
+        return ret;
+    *crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE), 0, opts, strlen(opts));
+    av_free(opts);
+    return 0;
+}
+
+int avfilter_graph_template_create(AVFilterGraphTemplate **ptmpl,
+                                   const AVFilterGraph *graph)
+{
+    AVFilterGraphTemplate *tmpl;
+    int i, j, nb_links = 0, ret;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        /* filters are matched by name */
+        if (!f->name)
+            return AVERROR(EINVAL);
+        for (j = 0; j < i; j++)
+            if (!strcmp(graph->filters[j]->name, f->name))
+                return AVERROR(EINVAL);
+        for (j = 0; j < f->nb_inputs; j++)
+            if (!f->inputs[j] || f->inputs[j]->init_state != AVLINK_INIT)
+                return AVERROR(EINVAL);
+        nb_links += f->nb_inputs;
+    }
+
+    tmpl = av_mallocz(sizeof(*tmpl));
+    if (!tmpl)
+        return AVERROR(ENOMEM);
+    tmpl->filters = av_mallocz_array(graph->nb_filters, sizeof(*tmpl->filters));
+    tmpl->links   = av_mallocz_array(nb_links, sizeof(*tmpl->links));
+    if ((graph->nb_filters && !tmpl->filters) || (nb_links && !tmpl->links)) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        TemplateFilter *tf = &tmpl->filters[tmpl->nb_filters++];
+
+        tf->name   = av_strdup(f->name);
+        tf->filter = f->filter;
+        if (!tf->name) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        if ((ret = filter_opts_crc(f, &tf->opts_crc)) < 0)
+            goto fail;
+
+        for (j = 0; j < f->nb_inputs; j++) {
+            AVFilterLink *link = f->inputs[j];
+            TemplateLink *l = &tmpl->links[tmpl->nb_links++];
+
+            l->src            = av_strdup(link->src->name);
+            l->dst            = av_strdup(link->dst->name);
+            if (!l->src || !l->dst) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+            l->srcf           = link->src->filter;
+            l->dstf           = link->dst->filter;
+            l->srcpad         = FF_OUTLINK_IDX(link);
+            l->dstpad         = FF_INLINK_IDX(link);
+            l->type           = link->type;
+            l->format         = link->format;
+            l->sample_rate    = link->sample_rate;
+            l->channel_layout = link->channel_layout;
+            l->channels       = link->channels;
+        }
+    }
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        TemplateConvert *c;
+
+        if (!f->internal->auto_convert)
+            continue;
+        /* conversions are only ever inserted between two other filters */
+        if (f->inputs[0]->src->internal->auto_convert ||
+            f->outputs[0]->dst->internal->auto_convert) {
+            ret = AVERROR(ENOSYS);
+            goto fail;
+        }
+        c = av_dynarray2_add((void **)&tmpl->converts, &tmpl->nb_converts,
+                             sizeof(*tmpl->converts), NULL);
+        if (!c) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        c->filter = f->filter;
+        c->name   = av_strdup(f->name);
+        c->in     = template_find_link(tmpl, f->inputs[0]->src->name,
+                                       FF_OUTLINK_IDX(f->inputs[0]), f->name, 0);
+        c->out    = template_find_link(tmpl, f->name, 0, f->outputs[0]->dst->name,
+                                       FF_INLINK_IDX(f->outputs[0]));
+        if (!c->name) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    *ptmpl = tmpl;
+    return 0;
+
+fail:
+    avfilter_graph_template_free(&tmpl);
+    return ret;
+}
+
+static int formats_contain(const AVFilterFormats *fmts, int fmt)
+{
+    int i;
+
+    for (i = 0; i < fmts->nb_formats; i++)
+        if (fmts->formats[i] == fmt)
+            return 1;
+    return 0;
+}
+
+static int layouts_contain(const AVFilterChannelLayouts *layouts,
+                           uint64_t layout, int channels)
+{
+    int i;
+
+    if (layouts->all_counts || (layout && layouts->all_layouts))
+        return 1;
+    for (i = 0; i < layouts->nb_channel_layouts; i++)
+        if ((layout && layouts->channel_layouts[i] == layout) ||
+            layouts->channel_layouts[i] == FF_COUNT2LAYOUT(channels))
+            return 1;
+    return 0;
+}
+
+/**
+ * Check the formats declared by the filters on both ends of a link
+ * against the template.
+ */
+static int template_check_link(AVFilterLink *link,
+                               const TemplateLink *in, const TemplateLink *out)
+{
+    if (link->type != in->type || link->type != out->type)
+        return 0;
+    if ((link->in_formats  && !formats_contain(link->in_formats,  in->format)) ||
+        (link->out_formats && !formats_contain(link->out_formats, out->format)))
+        return 0;
+    if (link->type == AVMEDIA_TYPE_AUDIO) {
+        if ((link->in_samplerates && link->in_samplerates->nb_formats &&
+             !formats_contain(link->in_samplerates, in->sample_rate)) ||
+            (link->out_samplerates && link->out_samplerates->nb_formats &&
+             !formats_contain(link->out_samplerates, out->sample_rate)))
+            return 0;
+        if ((link->in_channel_layouts &&
+             !layouts_contain(link->in_channel_layouts,
+                              in->channel_layout, in->channels)) ||
+            (link->out_channel_layouts &&
+             !layouts_contain(link->out_channel_layouts,
+                              out->channel_layout, out->channels)))
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * Check that a filter is of the same type and has the same options as the
+ * filter of the same name in a template.
+ *
+ * @return 1 if it does, 0 if it does not, a negative AVERROR code on error
+ */
+static int template_match_filter(const AVFilterGraphTemplate *tmpl,
+                                 AVFilterContext *f)
+{
+    uint32_t crc;
+    int i, ret;
+
+    for (i = 0; i < tmpl->nb_filters; i++) {
+        const TemplateFilter *tf = &tmpl->filters[i];
+
+        if (strcmp(tf->name, f->name))
+            continue;
+        if (tf->filter != f->filter)
+            return 0;
+        if ((ret = filter_opts_crc(f, &crc)) < 0)
+            return ret;
+        return crc == tf->opts_crc;
+    }
+    return 0;
+}
+
+/**
+ * Find the records of a link in a template: in describes the source end
+ * of the link and out the destination end, they differ if a conversion
+ * filter was inserted on the link. The filters on both ends must be of
+ * the same type as in the template, their options are checked once with
+ * template_match_filter().
+ */
+static int template_match_link(const AVFilterGraphTemplate *tmpl,
+                               AVFilterLink *link,
+                               const TemplateLink **in, const TemplateLink **out)
+{
+    int srcpad = FF_OUTLINK_IDX(link), dstpad = FF_INLINK_IDX(link), i;
+
+    i = template_find_link(tmpl, link->src->name, srcpad, link->dst->name, dstpad);
+    if (i >= 0) {
+        *in = *out = &tmpl->links[i];
+        return (*in)->srcf == link->src->filter && (*in)->dstf == link->dst->filter;
+    }
+    for (i = 0; i < tmpl->nb_converts; i++) {
+        *in  = &tmpl->links[tmpl->converts[i].in];
+        *out = &tmpl->links[tmpl->converts[i].out];
+        if ((*in)->srcpad == srcpad && (*out)->dstpad == dstpad &&
+            !strcmp((*in)->src, link->src->name) &&
+            !strcmp((*out)->dst, link->dst->name))
+            return (*in)->srcf == link->src->filter &&
+                   (*out)->dstf == link->dst->filter ? 2 : 0;
+    }
+    return 0;
+}
+
+/**
+ * Declare the formats of the source end of a link as recorded in the
+ * template, for the destination filter to query its formats.
+ */
+static int template_declare_link(AVFilterLink *link, const TemplateLink *l)
+{
+    AVFilterFormats *formats = NULL, *samplerates = NULL;
+    AVFilterChannelLayouts *layouts = NULL;
+    int ret;
+
+    if (!link->in_formats &&
+        ((ret = ff_add_format(&formats, l->format)) < 0 ||
+         (ret = ff_formats_ref(formats, &link->in_formats)) < 0))
+        return ret;
+    if (link->type != AVMEDIA_TYPE_AUDIO)
+        return 0;
+    if (!link->in_samplerates &&
+        ((ret = ff_add_format(&samplerates, l->sample_rate)) < 0 ||
+         (ret = ff_formats_ref(samplerates, &link->in_samplerates)) < 0))
+        return ret;
+    if (!link->in_channel_layouts &&
+        ((ret = ff_add_channel_layout(&layouts, l->channel_layout ?
+                                      l->channel_layout :
+                                      FF_COUNT2LAYOUT(l->channels))) < 0 ||
+         (ret = ff_channel_layouts_ref(layouts, &link->in_channel_layouts)) < 0))
+        return ret;
+    return 0;
+}
+
+/**
+ * Sources and sinks are queried to check the template against their
+ * parameters, and some filters set up their state while querying.
+ */
+static int template_query_needed(AVFilterContext *f)
+{
+    return !f->nb_inputs || !f->nb_outputs ||
+           (f->filter->flags_internal & FF_FILTER_FLAG_QUERY_FORMATS_STATE);
+}
+
+static void graph_unref_formats(AVFilterGraph *graph)
+{
+    int i, j;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        for (j = 0; j < f->nb_inputs; j++) {
+            AVFilterLink *link = f->inputs[j];
+            ff_formats_unref(&link->in_formats);
+            ff_formats_unref(&link->out_formats);
+            ff_formats_unref(&link->in_samplerates);
+            ff_formats_unref(&link->out_samplerates);
+            ff_channel_layouts_unref(&link->in_channel_layouts);
+            ff_channel_layouts_unref(&link->out_channel_layouts);
+        }
+    }
+}
+
+/**
+ * Configure the formats of all the links in the graph from a template.
+ *
+ * Only the sources, the sinks and the filters needing it are queried, to
+ * check that the template still applies. Return AVERROR(EAGAIN), before
+ * inserting any filter and with no formats declared, if it does not.
+ */
+static int graph_config_formats_template(AVFilterGraph *graph,
+                                         const AVFilterGraphTemplate *tmpl,
+                                         AVClass *log_ctx)
+{
+    const TemplateLink *in, *out;
+    AVFilterContext **converts = NULL;
+    int i, j, ret, nb_links = 0, nb_converted = 0, progress, pending;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        if (!graph->filters[i]->name)
+            return AVERROR(EAGAIN);
+        if ((ret = template_match_filter(tmpl, graph->filters[i])) <= 0)
+            return ret < 0 ? ret : AVERROR(EAGAIN);
+    }
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        for (j = 0; j < f->nb_inputs; j++) {
+            switch (template_match_link(tmpl, f->inputs[j], &in, &out)) {
+            case 0:  return AVERROR(EAGAIN);
+            case 1:  nb_links++;     break;
+            default: nb_converted++; break;
+            }
+        }
+    }
+    if (nb_converted != tmpl->nb_converts ||
+        nb_links + 2 * nb_converted != tmpl->nb_links)
+        return AVERROR(EAGAIN);
+
+    /* query the filters after those they are connected to, if queried */
+    do {
+        progress = pending = 0;
+        for (i = 0; i < graph->nb_filters; i++) {
+            AVFilterContext *f = graph->filters[i];
+
+            if (!template_query_needed(f) || formats_declared(f))
+                continue;
+            for (j = 0; j < f->nb_inputs; j++)
+                if (template_query_needed(f->inputs[j]->src) &&
+                    !formats_declared(f->inputs[j]->src))
+                    break;
+            if (j < f->nb_inputs) {
+                pending++;
+                continue;
+            }
+
+            if (f->filter->flags_internal & FF_FILTER_FLAG_QUERY_FORMATS_STATE) {
+                for (j = 0; j < f->nb_inputs; j++) {
+                    if (template_query_needed(f->inputs[j]->src))
+                        continue;
+                    template_match_link(tmpl, f->inputs[j], &in, &out);
+                    if ((ret = template_declare_link(f->inputs[j], in)) < 0)
+                        return ret;
+                }
+            }
+            if (f->filter->query_formats)
+                ret = filter_query_formats(f);
+            else
+                ret = ff_default_query_formats(f);
+            if (ret == AVERROR(EAGAIN))
+                goto mismatch;
+            if (ret < 0)
+                return ret;
+            progress++;
+        }
+    } while (pending && progress);
+    if (pending)
+        goto mismatch;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        for (j = 0; j < f->nb_inputs; j++) {
+            template_match_link(tmpl, f->inputs[j], &in, &out);
+            if (!template_check_link(f->inputs[j], in, out))
+                goto mismatch;
+        }
+    }
+
+    /* create all the conversion filters first, their options depend on
+     * those of the graph and may not match the template anymore */
+    if (tmpl->nb_converts) {
+        converts = av_calloc(tmpl->nb_converts, sizeof(*converts));
+        if (!converts)
+            return AVERROR(ENOMEM);
+    }
+    for (i = 0; i < tmpl->nb_converts; i++) {
+        const TemplateConvert *c = &tmpl->converts[i];
+
+        ret = avfilter_graph_create_filter(&converts[i], c->filter, c->name,
+                                           tmpl->links[c->out].type == AVMEDIA_TYPE_VIDEO ?
+                                           graph->scale_sws_opts :
+                                           graph->aresample_swr_opts,
+                                           NULL, graph);
+        if (ret >= 0)
+            ret = template_match_filter(tmpl, converts[i]);
+        if (ret <= 0) {
+            for (j = 0; j <= i; j++)
+                avfilter_free(converts[j]);
+            av_free(converts);
+            if (ret < 0)
+                return ret;
+            goto mismatch;
+        }
+    }
+    for (i = 0; i < tmpl->nb_converts; i++) {
+        const TemplateConvert *c = &tmpl->converts[i];
+        AVFilterContext *dst;
+        AVFilterLink *link;
+
+        out  = &tmpl->links[c->out];
+        dst  = avfilter_graph_get_filter(graph, out->dst);
+        link = dst->inputs[out->dstpad];
+        if ((ret = avfilter_insert_filter(link, converts[i], 0, 0)) < 0)
+            break;
+        converts[i]->internal->auto_convert = 1;
+    }
+    av_free(converts);
+    if (ret < 0)
+        return ret;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        for (j = 0; j < f->nb_inputs; j++) {
+            AVFilterLink *link = f->inputs[j];
+
+            if (template_match_link(tmpl, link, &in, &out) != 1)
+                return AVERROR_BUG;
+            link->format         = in->format;
+            link->sample_rate    = in->sample_rate;
+            link->channel_layout = in->channel_layout;
+            link->channels       = in->channels;
+        }
+    }
+    graph_unref_formats(graph);
+
+    return 0;
+
+mismatch:
+    graph_unref_formats(graph);
+    return AVERROR(EAGAIN);
+}
+
 static int graph_config_pointers(AVFilterGraph *graph,
                                              AVClass *log_ctx)
 {
@@ -1264,7 +1839,8 @@ static int graph_insert_fifos(AVFilterGraph *graph, AVClass *log_ctx)
     return 0;
 }
 
-int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
+static int graph_config(AVFilterGraph *graphctx,
+                        const AVFilterGraphTemplate *tmpl, void *log_ctx)
 {
     int ret;
 
@@ -1272,7 +1848,15 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_insert_fifos(graphctx, log_ctx)) < 0)
         return ret;
-    if ((ret = graph_config_formats(graphctx, log_ctx)))
+    if (tmpl) {
+        ret = graph_config_formats_template(graphctx, tmpl, log_ctx);
+        if (ret == AVERROR(EAGAIN))
+            av_log(log_ctx, AV_LOG_VERBOSE, "The graph does not match the "
+                   "template, negotiating the formats.\n");
+    }
+    if (!tmpl || ret == AVERROR(EAGAIN))
+        ret = graph_config_formats(graphctx, log_ctx);
+    if (ret < 0)
         return ret;
     if ((ret = graph_config_links(graphctx, log_ctx)))
         return ret;
@@ -1280,10 +1864,26 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
+    if ((ret = ff_graph_sched_config(graphctx)) < 0)
+        return ret;
+
+    graphctx->internal->profile = graphctx->profile || graphctx->profile_file;
 
     return 0;
 }
 
+int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
+{
+    return graph_config(graphctx, NULL, log_ctx);
+}
+
+int avfilter_graph_config_template(AVFilterGraph *graphctx,
+                                   const AVFilterGraphTemplate *tmpl,
+                                   void *log_ctx)
+{
+    return graph_config(graphctx, tmpl, log_ctx);
+}
+
 int avfilter_graph_send_command(AVFilterGraph *graph, const char *target, const char *cmd, const char *arg, char *res, int res_len, int flags)
 {
     int i, r = AVERROR(ENOSYS);
@@ -1445,6 +2045,8 @@ int ff_filter_graph_run_once(AVFilterGraph *graph)
     unsigned i;
 
     av_assert0(graph->nb_filters);
+    if (graph->internal->sched)
+        return ff_graph_sched_run(graph);
     filter = graph->filters[0];
     for (i = 1; i < graph->nb_filters; i++)
         if (graph->filters[i]->ready > filter->ready)
@@ -175,6 +175,58 @@ void ff_copy_rectangle(uint8_t *dst[4], int dst_linesize[4],
     }
 }
 
+static av_always_inline int mask_empty4(const uint8_t *m, ptrdiff_t mask_linesize,
+                                        int hsub, int vsub)
+{
+    uint64_t v = hsub ? AV_RN64(m) : AV_RN32(m);
+
+    if (vsub)
+        v |= hsub ? AV_RN64(m + mask_linesize) : AV_RN32(m + mask_linesize);
+    return !v;
+}
+
+static av_always_inline int blend_mask_row(uint8_t *dst, const uint8_t *mask,
+                                           ptrdiff_t mask_linesize, int w,
+                                           unsigned src, unsigned alpha,
+                                           int hsub, int vsub)
+{
+    int x;
+
+    for (x = 0; x < w; x++) {
+        const uint8_t *m = mask + (x << hsub);
+        unsigned t, a;
+
+        /* the mask of a text is mostly empty, and empty leaves dst unchanged */
+        if (!(x & 3) && x + 4 <= w && mask_empty4(m, mask_linesize, hsub, vsub)) {
+            x += 3;
+            continue;
+        }
+        t = m[0];
+        if (hsub)
+            t += m[1];
+        if (vsub)
+            t += hsub ? m[mask_linesize] + m[mask_linesize + 1] : m[mask_linesize];
+        /* same rounding as blend_pixel() */
+        a = (t >> (hsub + vsub)) * alpha;
+        dst[x] = ((0x1010101 - a) * dst[x] + a * src) >> 24;
+    }
+    return w;
+}
+
+#define DEFINE_BLEND_MASK_ROW(hsub, vsub)                                     \
+static int blend_mask_row_##hsub##vsub##_c(uint8_t *dst, const uint8_t *mask, \
+                                           ptrdiff_t mask_linesize, int w,    \
+                                           unsigned src, unsigned alpha)      \
+{                                                                             \
+    return blend_mask_row(dst, mask, mask_linesize, w, src, alpha,            \
+                          hsub, vsub);                                        \
+}
+
+DEFINE_BLEND_MASK_ROW(0, 0)
+DEFINE_BLEND_MASK_ROW(1, 0)
+DEFINE_BLEND_MASK_ROW(0, 1)
+DEFINE_BLEND_MASK_ROW(1, 1)
+
 int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
@@ -225,6 +277,18 @@ int ff_draw_init(FFDrawContext *draw, enum AVPixelFormat format, unsigned flags)
     for (i = 0; i < (desc->nb_components - !!(desc->flags & AV_PIX_FMT_FLAG_ALPHA && !(flags & FF_DRAW_PROCESS_ALPHA))); i++)
         draw->comp_mask[desc->comp[i].plane] |=
             1 << desc->comp[i].offset;
+    for (i = 0; i < nb_planes; i++) {
+        static int (* const blend_mask_rows[2][2])(uint8_t *dst, const uint8_t *mask,
+                                                   ptrdiff_t mask_linesize, int w,
+                                                   unsigned src, unsigned alpha) = {
+            { blend_mask_row_00_c, blend_mask_row_01_c },
+            { blend_mask_row_10_c, blend_mask_row_11_c },
+        };
+
+        if (pixelstep[i] == 1 && desc->comp[0].depth == 8 &&
+            draw->hsub[i] <= 1 && draw->vsub[i] <= 1)
+            draw->blend_mask_row[i] = blend_mask_rows[draw->hsub[i]][draw->vsub[i]];
+    }
     return 0;
 }
 
@@ -598,9 +662,12 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
                           unsigned src, unsigned alpha,
                           const uint8_t *mask, int mask_linesize, int l2depth, int w,
                           unsigned hsub, unsigned vsub,
-                          int xm, int left, int right, int hband)
+                          int xm, int left, int right, int hband,
+                          int (*blend_row)(uint8_t *dst, const uint8_t *mask,
+                                           ptrdiff_t mask_linesize, int w,
+                                           unsigned src, unsigned alpha))
 {
-    int x;
+    int x = 0;
 
     if (left) {
         blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
@@ -608,7 +675,12 @@ static void blend_line_hv(uint8_t *dst, int dst_delta,
         dst += dst_delta;
         xm += left;
     }
-    for (x = 0; x < w; x++) {
+    if (blend_row && l2depth == 3 && hband == 1 << vsub) {
+        x = blend_row(dst, mask + xm, mask_linesize, w, src, alpha);
+        dst += x * dst_delta;
+        xm += x << hsub;
+    }
+    for (; x < w; x++) {
         blend_pixel(dst, src, alpha, mask, mask_linesize, l2depth,
                     1 << hsub, hband, hsub + vsub, xm);
         dst += dst_delta;
@@ -625,6 +697,8 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                    int l2depth, unsigned endianness, int x0, int y0)
 {
     unsigned alpha, nb_planes, nb_comp, plane, comp;
+    int (*blend_row)(uint8_t *dst, const uint8_t *mask, ptrdiff_t mask_linesize,
+                     int w, unsigned src, unsigned alpha);
     int xm0, ym0, w_sub, h_sub, x_sub, y_sub, left, right, top, bottom, y;
     uint8_t *p0, *p;
     const uint8_t *m;
@@ -645,6 +719,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
     nb_planes += !nb_planes;
     for (plane = 0; plane < nb_planes; plane++) {
         nb_comp = draw->pixelstep[plane];
+        blend_row = l2depth == 3 ? draw->blend_mask_row[plane] : NULL;
         p0 = pointer_at(draw, dst, dst_linesize, plane, x0, y0);
         w_sub = mask_w;
         h_sub = mask_h;
@@ -665,7 +740,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                                   color->comp[plane].u8[comp], alpha,
                                   m, mask_linesize, l2depth, w_sub,
                                   draw->hsub[plane], draw->vsub[plane],
-                                  xm0, left, right, top);
+                                  xm0, left, right, top, blend_row);
                 } else {
                     blend_line_hv16(p, draw->pixelstep[plane],
                                     color->comp[plane].u16[comp], alpha,
@@ -682,7 +757,8 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                                   color->comp[plane].u8[comp], alpha,
                                   m, mask_linesize, l2depth, w_sub,
                                   draw->hsub[plane], draw->vsub[plane],
-                                  xm0, left, right, 1 << draw->vsub[plane]);
+                                  xm0, left, right, 1 << draw->vsub[plane],
+                                  blend_row);
                     p += dst_linesize[plane];
                     m += mask_linesize << draw->vsub[plane];
                 }
@@ -703,7 +779,7 @@ void ff_blend_mask(FFDrawContext *draw, FFDrawColor *color,
                                   color->comp[plane].u8[comp], alpha,
                                   m, mask_linesize, l2depth, w_sub,
                                   draw->hsub[plane], draw->vsub[plane],
-                                  xm0, left, right, bottom);
+                                  xm0, left, right, bottom, blend_row);
                 } else {
                     blend_line_hv16(p, draw->pixelstep[plane],
                                     color->comp[plane].u16[comp], alpha,
@@ -57,6 +57,16 @@ typedef struct FFDrawContext {
     uint8_t vsub_max;
     int full_range;
     unsigned flags;
+
+    /**
+     * Blend the first pixels of a row of an 8 bits per pixel plane with the
+     * src component value, weighted by alpha times an 8 bits mask averaged
+     * over the 1 << hsub by 1 << vsub mask pixels covered by each pixel.
+     * Return the number of pixels blended. NULL for the other planes.
+     */
+    int (*blend_mask_row[MAX_PLANES])(uint8_t *dst, const uint8_t *mask,
+                                      ptrdiff_t mask_linesize, int w,
+                                      unsigned src, unsigned alpha);
 } FFDrawContext;
 
 typedef struct FFDrawColor {
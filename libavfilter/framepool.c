@@ -26,6 +26,260 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/thread.h"
+
+/**
+ * Number of requests in its size class after which a released buffer
+ * that has not been reused is freed.
+ */
+#define CACHE_MAX_IDLE 64
+
+/**
+ * Number of requests of any size after which the released buffers of a
+ * size class that is not requested anymore are freed.
+ */
+#define CACHE_MAX_UNUSED 1024
+
+/**
+ * Number of requests between two trims of the cache.
+ */
+#define CACHE_TRIM_INTERVAL 64
+
+typedef struct CacheBucket CacheBucket;
+
+typedef struct CacheEntry {
+    FFBufferCache *cache;
+    CacheBucket   *bucket;
+    uint8_t       *data;
+    uint64_t       released;    ///< nb_gets of the bucket at the last release
+    struct CacheEntry *prev, *next;
+} CacheEntry;
+
+struct CacheBucket {
+    size_t      size;
+    uint64_t    nb_gets;        ///< number of requests in this size class
+    uint64_t    last_get;       ///< tick of the last request
+    /* released buffers, most recently released first */
+    CacheEntry *idle_head, *idle_tail;
+};
+
+struct FFBufferCache {
+    AVMutex      lock;
+    CacheBucket **buckets;
+    int           nb_buckets;
+    uint64_t     tick;
+    int          nb_outstanding;
+    int          closed;
+    FFBufferCacheStats stats;
+};
+
+static size_t cache_size_class(int size)
+{
+    int step;
+
+    if (size <= 256)
+        return 256;
+    step = 1 << (av_log2(size - 1) - 2);
+    return FFALIGN((size_t)size, step);
+}
+
+static void cache_entry_free(FFBufferCache *cache, CacheEntry *entry)
+{
+    cache->stats.allocated -= entry->bucket->size;
+    av_free(entry->data);
+    av_free(entry);
+}
+
+static void cache_unlink(CacheBucket *bucket, CacheEntry *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        bucket->idle_head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        bucket->idle_tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+/* free the buffers which have not been reused for a while */
+static void cache_trim(FFBufferCache *cache)
+{
+    int i;
+
+    for (i = 0; i < cache->nb_buckets; i++) {
+        CacheBucket *bucket = cache->buckets[i];
+        int unused = cache->tick - bucket->last_get > CACHE_MAX_UNUSED;
+
+        while (bucket->idle_tail &&
+               (unused || bucket->nb_gets - bucket->idle_tail->released > CACHE_MAX_IDLE)) {
+            CacheEntry *entry = bucket->idle_tail;
+            cache_unlink(bucket, entry);
+            cache_entry_free(cache, entry);
+        }
+    }
+}
+
+static void cache_free(FFBufferCache *cache)
+{
+    int i;
+
+    for (i = 0; i < cache->nb_buckets; i++)
+        av_free(cache->buckets[i]);
+    av_freep(&cache->buckets);
+    ff_mutex_destroy(&cache->lock);
+    av_free(cache);
+}
+
+FFBufferCache *ff_buffer_cache_alloc(void)
+{
+    FFBufferCache *cache = av_mallocz(sizeof(*cache));
+
+    if (!cache)
+        return NULL;
+    if (ff_mutex_init(&cache->lock, NULL)) {
+        av_free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void ff_buffer_cache_uninit(FFBufferCache **pcache)
+{
+    FFBufferCache *cache = *pcache;
+    int i, outstanding;
+
+    if (!cache)
+        return;
+    *pcache = NULL;
+
+    ff_mutex_lock(&cache->lock);
+    for (i = 0; i < cache->nb_buckets; i++) {
+        CacheBucket *bucket = cache->buckets[i];
+        while (bucket->idle_head) {
+            CacheEntry *entry = bucket->idle_head;
+            cache_unlink(bucket, entry);
+            cache_entry_free(cache, entry);
+        }
+    }
+    cache->closed = 1;
+    outstanding = cache->nb_outstanding;
+    ff_mutex_unlock(&cache->lock);
+
+    if (!outstanding)
+        cache_free(cache);
+}
+
+static void cache_release(void *opaque, uint8_t *data)
+{
+    CacheEntry *entry = opaque;
+    CacheBucket *bucket = entry->bucket;
+    FFBufferCache *cache = entry->cache;
+    int destroy = 0;
+
+    ff_mutex_lock(&cache->lock);
+    cache->stats.in_use -= bucket->size;
+    cache->nb_outstanding--;
+    if (cache->closed) {
+        cache_entry_free(cache, entry);
+        destroy = !cache->nb_outstanding;
+    } else {
+        entry->released = bucket->nb_gets;
+        entry->next     = bucket->idle_head;
+        if (bucket->idle_head)
+            bucket->idle_head->prev = entry;
+        else
+            bucket->idle_tail = entry;
+        bucket->idle_head = entry;
+    }
+    ff_mutex_unlock(&cache->lock);
+
+    if (destroy)
+        cache_free(cache);
+}
+
+static CacheBucket *cache_get_bucket(FFBufferCache *cache, size_t size)
+{
+    CacheBucket *bucket;
+    int i;
+
+    for (i = 0; i < cache->nb_buckets; i++)
+        if (cache->buckets[i]->size == size)
+            return cache->buckets[i];
+
+    /* allocated separately, entries keep pointing to their bucket */
+    bucket = av_mallocz(sizeof(*bucket));
+    if (!bucket)
+        return NULL;
+    bucket->size = size;
+    if (av_dynarray_add_nofree(&cache->buckets, &cache->nb_buckets, bucket) < 0) {
+        av_free(bucket);
+        return NULL;
+    }
+    return bucket;
+}
+
+AVBufferRef *ff_buffer_cache_get(FFBufferCache *cache, int size)
+{
+    CacheBucket *bucket;
+    CacheEntry *entry = NULL;
+    AVBufferRef *buf;
+
+    ff_mutex_lock(&cache->lock);
+    cache->tick++;
+    bucket = cache_get_bucket(cache, cache_size_class(size));
+    if (!bucket)
+        goto fail;
+    bucket->nb_gets++;
+    bucket->last_get = cache->tick;
+
+    if (bucket->idle_head) {
+        entry = bucket->idle_head;
+        cache_unlink(bucket, entry);
+        cache->stats.nb_reuses++;
+    } else {
+        entry = av_mallocz(sizeof(*entry));
+        if (!entry)
+            goto fail;
+        entry->cache  = cache;
+        entry->bucket = bucket;
+        entry->data   = av_mallocz(bucket->size);
+        if (!entry->data) {
+            av_freep(&entry);
+            goto fail;
+        }
+        cache->stats.allocated += bucket->size;
+        cache->stats.allocated_peak = FFMAX(cache->stats.allocated_peak,
+                                            cache->stats.allocated);
+        cache->stats.nb_allocs++;
+    }
+
+    buf = av_buffer_create(entry->data, size, cache_release, entry, 0);
+    if (!buf)
+        goto fail;
+    cache->nb_outstanding++;
+    cache->stats.in_use += bucket->size;
+    cache->stats.in_use_peak = FFMAX(cache->stats.in_use_peak,
+                                     cache->stats.in_use);
+    if (!(cache->tick % CACHE_TRIM_INTERVAL))
+        cache_trim(cache);
+    ff_mutex_unlock(&cache->lock);
+    return buf;
+
+fail:
+    if (entry)
+        cache_entry_free(cache, entry);
+    ff_mutex_unlock(&cache->lock);
+    return NULL;
+}
+
+void ff_buffer_cache_get_stats(FFBufferCache *cache, FFBufferCacheStats *stats)
+{
+    ff_mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    ff_mutex_unlock(&cache->lock);
+}
 
 struct FFFramePool {
 
@@ -46,9 +300,14 @@ struct FFFramePool {
     int linesize[4];
     AVBufferPool *pools[4];
 
+    /* graph-wide cache used instead of the pools when set */
+    FFBufferCache *cache;
+    int sizes[4];
+
 };
 
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(int size),
+                                      FFBufferCache *cache,
                                       int width,
                                       int height,
                                       enum AVPixelFormat format,
@@ -66,6 +325,7 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(int size),
         return NULL;
 
     pool->type = AVMEDIA_TYPE_VIDEO;
+    pool->cache = cache;
     pool->width = width;
     pool->height = height;
     pool->format = format;
@@ -96,17 +356,22 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(int size),
         if (i == 1 || i == 2)
             h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
 
-        pool->pools[i] = av_buffer_pool_init(pool->linesize[i] * h + 16 + 16 - 1,
-                                             alloc);
+        pool->sizes[i] = pool->linesize[i] * h + 16 + 16 - 1;
+        if (cache)
+            continue;
+        pool->pools[i] = av_buffer_pool_init(pool->sizes[i], alloc);
         if (!pool->pools[i])
             goto fail;
     }
 
     if (desc->flags & AV_PIX_FMT_FLAG_PAL ||
         desc->flags & FF_PSEUDOPAL) {
-        pool->pools[1] = av_buffer_pool_init(AVPALETTE_SIZE, alloc);
-        if (!pool->pools[1])
-            goto fail;
+        pool->sizes[1] = AVPALETTE_SIZE;
+        if (!cache) {
+            pool->pools[1] = av_buffer_pool_init(AVPALETTE_SIZE, alloc);
+            if (!pool->pools[1])
+                goto fail;
+        }
     }
 
     return pool;
@@ -117,6 +382,7 @@ fail:
 }
 
 FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(int size),
+                                      FFBufferCache *cache,
                                       int channels,
                                       int nb_samples,
                                       enum AVSampleFormat format,
@@ -132,6 +398,7 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(int size),
     planar = av_sample_fmt_is_planar(format);
 
     pool->type = AVMEDIA_TYPE_AUDIO;
+    pool->cache = cache;
     pool->planes = planar ? channels : 1;
     pool->channels = channels;
     pool->nb_samples = nb_samples;
@@ -143,9 +410,12 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(int size),
     if (ret < 0)
         goto fail;
 
-    pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
-    if (!pool->pools[0])
-        goto fail;
+    pool->sizes[0] = pool->linesize[0];
+    if (!cache) {
+        pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
+        if (!pool->pools[0])
+            goto fail;
+    }
 
     return pool;
 
@@ -192,6 +462,13 @@ int ff_frame_pool_get_audio_config(FFFramePool *pool,
     return 0;
 }
 
+static AVBufferRef *frame_pool_get_buffer(FFFramePool *pool, int plane)
+{
+    if (pool->cache)
+        return ff_buffer_cache_get(pool->cache, pool->sizes[plane]);
+    return av_buffer_pool_get(pool->pools[plane]);
+}
+
 AVFrame *ff_frame_pool_get(FFFramePool *pool)
 {
     int i;
@@ -216,10 +493,10 @@ AVFrame *ff_frame_pool_get(FFFramePool *pool)
 
         for (i = 0; i < 4; i++) {
             frame->linesize[i] = pool->linesize[i];
-            if (!pool->pools[i])
+            if (!pool->sizes[i])
                 break;
 
-            frame->buf[i] = av_buffer_pool_get(pool->pools[i]);
+            frame->buf[i] = frame_pool_get_buffer(pool, i);
             if (!frame->buf[i])
                 goto fail;
 
@@ -258,13 +535,13 @@ AVFrame *ff_frame_pool_get(FFFramePool *pool)
         }
 
         for (i = 0; i < FFMIN(pool->planes, AV_NUM_DATA_POINTERS); i++) {
-            frame->buf[i] = av_buffer_pool_get(pool->pools[0]);
+            frame->buf[i] = frame_pool_get_buffer(pool, 0);
             if (!frame->buf[i])
                 goto fail;
             frame->extended_data[i] = frame->data[i] = frame->buf[i]->data;
         }
         for (i = 0; i < frame->nb_extended_buf; i++) {
-            frame->extended_buf[i] = av_buffer_pool_get(pool->pools[0]);
+            frame->extended_buf[i] = frame_pool_get_buffer(pool, 0);
             if (!frame->extended_buf[i])
                 goto fail;
             frame->extended_data[i + AV_NUM_DATA_POINTERS] = frame->extended_buf[i]->data;
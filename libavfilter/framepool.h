@@ -24,6 +24,56 @@
 #include "libavutil/buffer.h"
 #include "libavutil/frame.h"
 
+/**
+ * Buffer cache shared by the frame pools of a filter graph.
+ *
+ * Buffers are grouped in size classes (four per power of two), so that
+ * buffers released by any pool can be reused by any other pool needing a
+ * buffer of about the same size, including the new pool of a link after
+ * a change of resolution. Released buffers not reused within the next
+ * allocations are freed.
+ */
+typedef struct FFBufferCache FFBufferCache;
+
+typedef struct FFBufferCacheStats {
+    uint64_t allocated;         ///< bytes allocated, in use or kept for reuse
+    uint64_t allocated_peak;    ///< high-water mark of allocated
+    uint64_t in_use;            ///< bytes in buffers currently referenced
+    uint64_t in_use_peak;       ///< high-water mark of in_use
+    uint64_t nb_allocs;         ///< buffers allocated from the system
+    uint64_t nb_reuses;         ///< buffers served from the cache
+} FFBufferCacheStats;
+
+/**
+ * Allocate a buffer cache.
+ *
+ * @return newly created buffer cache on success, NULL on error.
+ */
+FFBufferCache *ff_buffer_cache_alloc(void);
+
+/**
+ * Free the cached buffers and release the cache. It is safe to call this
+ * function while some of the buffers are still in use, the cache is then
+ * destroyed when the last of them is released.
+ *
+ * @param cache pointer to the cache to be freed. It will be set to NULL.
+ */
+void ff_buffer_cache_uninit(FFBufferCache **cache);
+
+/**
+ * Get a buffer of at least size bytes, newly allocated buffers are
+ * zeroed. This function may be called simultaneously from multiple
+ * threads.
+ *
+ * @return a new reference on success, NULL on error.
+ */
+AVBufferRef *ff_buffer_cache_get(FFBufferCache *cache, int size);
+
+/**
+ * Get the allocation statistics of the cache.
+ */
+void ff_buffer_cache_get_stats(FFBufferCache *cache, FFBufferCacheStats *stats);
+
 /**
  * Frame pool. This structure is opaque and not meant to be accessed
  * directly. It is allocated with ff_frame_pool_init() and freed with
@@ -37,6 +87,8 @@ typedef struct FFFramePool FFFramePool;
  * @param alloc a function that will be used to allocate new frame buffers when
  * the pool is empty. May be NULL, then the default allocator will be used
  * (av_buffer_alloc()).
+ * @param cache buffer cache to get the frame buffers from instead of
+ * pools private to this frame pool, alloc is then ignored. May be NULL.
  * @param width width of each frame in this pool
  * @param height height of each frame in this pool
  * @param format format of each frame in this pool
@@ -44,6 +96,7 @@ typedef struct FFFramePool FFFramePool;
  * @return newly created video frame pool on success, NULL on error.
  */
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(int size),
+                                      FFBufferCache *cache,
                                       int width,
                                       int height,
                                       enum AVPixelFormat format,
@@ -55,6 +108,8 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(int size),
  * @param alloc a function that will be used to allocate new frame buffers when
  * the pool is empty. May be NULL, then the default allocator will be used
  * (av_buffer_alloc()).
+ * @param cache buffer cache to get the frame buffers from instead of
+ * a pool private to this frame pool, alloc is then ignored. May be NULL.
  * @param channels channels of each frame in this pool
  * @param nb_samples number of samples of each frame in this pool
  * @param format format of each frame in this pool
@@ -62,6 +117,7 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(int size),
  * @return newly created audio frame pool on success, NULL on error.
  */
 FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(int size),
+                                      FFBufferCache *cache,
                                       int channels,
                                       int samples,
                                       enum AVSampleFormat format,
@@ -163,3 +163,92 @@ char *avfilter_graph_dump(AVFilterGraph *graph, const char *options)
     av_bprint_finalize(&buf, &dump);
     return dump;
 }
+
+static void print_json_string(AVBPrint *buf, const char *str)
+{
+    av_bprint_chars(buf, '"', 1);
+    for (; str && *str; str++) {
+        if (*str == '"' || *str == '\\')
+            av_bprintf(buf, "\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            av_bprintf(buf, "\\u%04x", *str);
+        else
+            av_bprint_chars(buf, *str, 1);
+    }
+    av_bprint_chars(buf, '"', 1);
+}
+
+static void profile_dump_to_buf(AVBPrint *buf, AVFilterGraph *graph)
+{
+    FFBufferCacheStats stats = { 0 };
+    unsigned i, j;
+    int first = 1;
+
+    av_bprintf(buf, "{\n  \"filters\": [");
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+        AVFilterProfile p;
+
+        if (avfilter_get_profile(filter, &p) < 0)
+            continue;
+        av_bprintf(buf, "%s\n    { \"name\": ", i ? "," : "");
+        print_json_string(buf, filter->name);
+        av_bprintf(buf, ", \"filter\": ");
+        print_json_string(buf, filter->filter->name);
+        av_bprintf(buf, ", \"activations\": %"PRId64", \"wall_time_us\": %"PRId64
+                   ", \"cpu_time_us\": %"PRId64", \"frames_in\": %"PRId64
+                   ", \"frames_out\": %"PRId64", \"bytes_allocated\": %"PRId64" }",
+                   p.nb_activations, p.wall_time, p.cpu_time,
+                   p.frames_in, p.frames_out, p.bytes_allocated);
+    }
+
+    av_bprintf(buf, "\n  ],\n  \"links\": [");
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+
+        for (j = 0; j < filter->nb_outputs; j++) {
+            AVFilterLink *link = filter->outputs[j];
+            AVFilterLinkProfile p;
+
+            if (!link || avfilter_link_get_profile(link, &p) < 0)
+                continue;
+            av_bprintf(buf, "%s\n    { \"src\": ", first ? "" : ",");
+            print_json_string(buf, link->src->name);
+            av_bprintf(buf, ", \"srcpad\": ");
+            print_json_string(buf, avfilter_pad_get_name(link->srcpad, 0));
+            av_bprintf(buf, ", \"dst\": ");
+            print_json_string(buf, link->dst->name);
+            av_bprintf(buf, ", \"dstpad\": ");
+            print_json_string(buf, avfilter_pad_get_name(link->dstpad, 0));
+            av_bprintf(buf, ", \"frames\": %"PRId64", \"max_queued_frames\": %"PRId64
+                       ", \"max_queued_samples\": %"PRId64" }",
+                       p.frames, p.max_queued_frames, p.max_queued_samples);
+            first = 0;
+        }
+    }
+
+    if (graph->internal->buffer_cache)
+        ff_buffer_cache_get_stats(graph->internal->buffer_cache, &stats);
+    av_bprintf(buf, "\n  ],\n  \"buffer_cache\": { \"allocations\": %"PRIu64
+               ", \"reuses\": %"PRIu64", \"allocated_peak\": %"PRIu64
+               ", \"in_use_peak\": %"PRIu64" }\n}\n",
+               stats.nb_allocs, stats.nb_reuses,
+               stats.allocated_peak, stats.in_use_peak);
+}
+
+char *avfilter_graph_dump_profile(AVFilterGraph *graph, const char *options)
+{
+    AVBPrint buf;
+    char *dump;
+
+    if (!graph->internal->profile)
+        return NULL;
+    av_bprint_init(&buf, 0, AV_BPRINT_SIZE_UNLIMITED);
+    profile_dump_to_buf(&buf, graph);
+    if (!av_bprint_is_complete(&buf)) {
+        av_bprint_finalize(&buf, NULL);
+        return NULL;
+    }
+    av_bprint_finalize(&buf, &dump);
+    return dump;
+}
@@ -24,7 +24,10 @@
  * internal API functions
  */
 
+#include <stdatomic.h>
+
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "framepool.h"
@@ -148,11 +151,37 @@ struct AVFilterPad {
 struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
+    void *sched;
+    FFBufferCache *buffer_cache;
+    int profile;            ///< collect the profiling counters
     FFFrameQueueGlobal frame_queues;
 };
 
+struct AVFilterLinkInternal {
+    /**
+     * Set by the graph scheduler in pipeline mode: the internal fields of
+     * the link are then accessed with lock held, see ff_link_lock().
+     */
+    int locked;
+
+    /**
+     * If set, the filters on both ends of the link can be activated
+     * concurrently, and the source runs ahead of the destination.
+     */
+    int pipelined;
+
+    AVMutex lock;
+};
+
+typedef struct AVFilterLinkInternal AVFilterLinkInternal;
+
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+    int busy;               ///< being activated by the graph scheduler
+    int auto_convert;       ///< inserted by the format negotiation
+    atomic_int active;      ///< in ff_filter_activate(), with profiling
+    AVMutex profile_lock;
+    AVFilterProfile profile;    ///< protected by profile_lock
 };
 
 /**
@@ -243,6 +272,15 @@ void ff_avfilter_link_set_in_status(AVFilterLink *link, int status, int64_t pts)
  */
 void ff_avfilter_link_set_out_status(AVFilterLink *link, int status, int64_t pts);
 
+/**
+ * Lock the state of a link shared by the filters on both ends, when they
+ * can be activated concurrently. No-op otherwise.
+ * The frame queue, status and request fields of a link must only be
+ * accessed through the functions of filters.h, which lock it as needed.
+ */
+void ff_link_lock(AVFilterLink *link);
+void ff_link_unlock(AVFilterLink *link);
+
 void ff_command_queue_pop(AVFilterContext *filter);
 
 /* misc trace functions */
@@ -373,6 +411,12 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name);
 
 int ff_filter_activate(AVFilterContext *filter);
 
+/**
+ * Account the buffers of a frame requested on a link to the profile of
+ * the filter on either end being activated, which requested it.
+ */
+void ff_filter_profile_alloc(AVFilterLink *link, const AVFrame *frame);
+
 /**
  * Remove a filter from a graph;
  */
@@ -384,6 +428,13 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The query_formats callback of the filter also sets up some of its
+ * private state, it must be called even when the formats are known in
+ * advance from a graph template.
+ */
+#define FF_FILTER_FLAG_QUERY_FORMATS_STATE (1 << 1)
+
 /**
  * Run one round of processing on a filter graph.
  */
@@ -29,6 +29,9 @@
 #include "libavutil/thread.h"
 #include "libavutil/slicethread.h"
 
+#define FF_INTERNAL_FIELDS 1
+#include "framequeue.h"
+
 #include "avfilter.h"
 #include "internal.h"
 #include "thread.h"
@@ -38,6 +41,9 @@ typedef struct ThreadContext {
     AVSliceThread *thread;
     avfilter_action_func *func;
 
+    /* serializes the filters sharing the pool with graph threading */
+    pthread_mutex_t execute_lock;
+
     /* per-execute parameters */
     AVFilterContext *ctx;
     void *arg;
@@ -55,6 +61,7 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    pthread_mutex_destroy(&c->execute_lock);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -64,23 +71,266 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
     if (nb_jobs <= 0)
         return 0;
+
+    pthread_mutex_lock(&c->execute_lock);
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+    pthread_mutex_unlock(&c->execute_lock);
     return 0;
 }
 
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
+    int ret = pthread_mutex_init(&c->execute_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
     nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
-    if (nb_threads <= 1)
+    if (nb_threads <= 1) {
         avpriv_slicethread_free(&c->thread);
+        pthread_mutex_destroy(&c->execute_lock);
+    }
     return FFMAX(nb_threads, 1);
 }
 
+/**
+ * Graph-level scheduler: activate the ready filters of the graph from
+ * several threads at once.
+ *
+ * Two filters sharing a link are never activated concurrently, so the
+ * links themselves (frame queues, status and flags) keep being accessed
+ * by a single thread at a time, as with the serial scheduler. Activating
+ * a filter also clears frame_blocked_in on the outputs of the filters it
+ * pushes to, and notifies the filters two hops up and down through the
+ * ready field, so the exclusion extends to those; filters merely sharing
+ * a source, like the branches of split, run in parallel.
+ *
+ * In pipeline mode, all the links are locked (see ff_link_lock()) and the
+ * exclusion only remains between filters connected by a link outside of
+ * a linear chain.
+ */
+typedef struct GraphScheduler {
+    AVFilterGraph *graph;
+    AVSliceThread *thread;
+
+    int pipeline;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+
+    /* per-run state, protected by lock */
+    int running;            ///< number of filters being activated
+    int activations;        ///< number of filters activated in this run
+    int max_activations;
+    int ret;
+} GraphScheduler;
+
+static int filter_is_busy(AVFilterContext *ctx)
+{
+    return ctx && ctx->internal->busy;
+}
+
+static int filter_conflicts(GraphScheduler *s, AVFilterContext *ctx)
+{
+    unsigned i, j;
+
+    for (i = 0; i < ctx->nb_inputs; i++) {
+        AVFilterContext *src = ctx->inputs[i] ? ctx->inputs[i]->src : NULL;
+        if (!src || ctx->inputs[i]->internal->pipelined)
+            continue;
+        if (src->internal->busy)
+            return 1;
+        if (s->pipeline)
+            continue;
+        for (j = 0; j < src->nb_inputs; j++)
+            if (src->inputs[j] && filter_is_busy(src->inputs[j]->src))
+                return 1;
+    }
+    for (i = 0; i < ctx->nb_outputs; i++) {
+        AVFilterContext *dst = ctx->outputs[i] ? ctx->outputs[i]->dst : NULL;
+        if (!dst || ctx->outputs[i]->internal->pipelined)
+            continue;
+        if (dst->internal->busy)
+            return 1;
+        if (s->pipeline)
+            continue;
+        for (j = 0; j < dst->nb_outputs; j++)
+            if (dst->outputs[j] && filter_is_busy(dst->outputs[j]->dst))
+                return 1;
+        /* other filters pushing to the same destination */
+        for (j = 0; j < dst->nb_inputs; j++)
+            if (dst->inputs[j] && filter_is_busy(dst->inputs[j]->src))
+                return 1;
+    }
+    return 0;
+}
+
+/* must be called with the lock held */
+static AVFilterContext *sched_pick_filter(GraphScheduler *s)
+{
+    AVFilterGraph *graph = s->graph;
+    AVFilterContext *best = NULL;
+    unsigned i;
+
+    if (s->ret < 0 || s->activations >= s->max_activations)
+        return NULL;
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *ctx = graph->filters[i];
+
+        /* the ready field of a busy filter belongs to its thread */
+        if (ctx->internal->busy || !ctx->ready ||
+            (best && ctx->ready <= best->ready))
+            continue;
+        if (!filter_conflicts(s, ctx))
+            best = ctx;
+    }
+    return best;
+}
+
+static void sched_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    GraphScheduler *s = priv;
+    AVFilterContext *ctx;
+    int ret;
+
+    pthread_mutex_lock(&s->lock);
+    while (1) {
+        ctx = sched_pick_filter(s);
+        if (!ctx) {
+            if (!s->running)
+                break;
+            pthread_cond_wait(&s->cond, &s->lock);
+            continue;
+        }
+
+        ctx->internal->busy = 1;
+        ctx->ready = 0;
+        s->running++;
+        s->activations++;
+        pthread_mutex_unlock(&s->lock);
+
+        ret = ff_filter_activate(ctx);
+
+        pthread_mutex_lock(&s->lock);
+        ctx->internal->busy = 0;
+        s->running--;
+        if (ret < 0 && s->ret >= 0)
+            s->ret = ret;
+        pthread_cond_broadcast(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void sched_uninit(GraphScheduler *s)
+{
+    avpriv_slicethread_free(&s->thread);
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+}
+
+static int sched_init(AVFilterGraph *graph)
+{
+    GraphScheduler *s;
+    int ret;
+
+    s = av_mallocz(sizeof(*s));
+    if (!s)
+        return AVERROR(ENOMEM);
+    s->graph    = graph;
+    s->pipeline = !!(graph->thread_type & AVFILTER_THREAD_PIPELINE);
+
+    if ((ret = pthread_mutex_init(&s->lock, NULL))) {
+        av_free(s);
+        return AVERROR(ret);
+    }
+    if ((ret = pthread_cond_init(&s->cond, NULL))) {
+        pthread_mutex_destroy(&s->lock);
+        av_free(s);
+        return AVERROR(ret);
+    }
+    ret = avpriv_slicethread_create(&s->thread, s, sched_worker, NULL,
+                                    graph->nb_threads);
+    if (ret <= 1) {
+        sched_uninit(s);
+        av_free(s);
+        return ret < 0 ? ret : 0;
+    }
+
+    graph->internal->sched = s;
+    return 0;
+}
+
+int ff_graph_sched_run(AVFilterGraph *graph)
+{
+    GraphScheduler *s = graph->internal->sched;
+    int activations;
+
+    /* bound the run like the serial scheduler bounds a step, so the
+     * caller gets a chance to push or pull frames; a pipeline needs to run
+     * until it drains, and the bounded queues keep it from running away */
+    s->running         = 0;
+    s->activations     = 0;
+    s->max_activations = s->pipeline ? INT_MAX : graph->nb_filters;
+    s->ret             = 0;
+
+    avpriv_slicethread_execute(s->thread, graph->nb_threads, 0);
+
+    activations = s->activations;
+    if (s->ret < 0)
+        return s->ret;
+    return activations ? 0 : AVERROR(EAGAIN);
+}
+
+int ff_graph_sched_config(AVFilterGraph *graph)
+{
+    GraphScheduler *s = graph->internal->sched;
+    unsigned i, j;
+    int ret;
+
+    if (!s || !s->pipeline)
+        return 0;
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *ctx = graph->filters[i];
+
+        for (j = 0; j < ctx->nb_outputs; j++) {
+            AVFilterLink *link = ctx->outputs[j];
+            AVFilterContext *dst = link->dst;
+
+            if (link->internal->locked)
+                continue;
+            if ((ret = ff_mutex_init(&link->internal->lock, NULL)))
+                return AVERROR(ret);
+            link->internal->locked = 1;
+            /* Only pipeline linear chains, not into sinks, and not when the
+             * destination allocates the frames of its source. */
+            link->internal->pipelined = ctx->nb_outputs == 1 && dst->nb_inputs == 1 &&
+                              dst->nb_outputs &&
+                              !link->dstpad->get_video_buffer &&
+                              !link->dstpad->get_audio_buffer;
+        }
+    }
+    return 0;
+}
+
+void ff_graph_sched_lock(AVFilterGraph *graph)
+{
+    GraphScheduler *s = graph->internal->sched;
+    if (s)
+        pthread_mutex_lock(&s->lock);
+}
+
+void ff_graph_sched_unlock(AVFilterGraph *graph)
+{
+    GraphScheduler *s = graph->internal->sched;
+    if (s)
+        pthread_mutex_unlock(&s->lock);
+}
+
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
     int ret;
@@ -105,11 +355,21 @@ int ff_graph_thread_init(AVFilterGraph *graph)
 
     graph->internal->thread_execute = thread_execute;
 
+    if (graph->thread_type & (AVFILTER_THREAD_GRAPH | AVFILTER_THREAD_PIPELINE)) {
+        ret = sched_init(graph);
+        if (ret < 0)
+            return ret;
+    }
+
     return 0;
 }
 
 void ff_graph_thread_free(AVFilterGraph *graph)
 {
+    if (graph->internal->sched) {
+        sched_uninit(graph->internal->sched);
+        av_freep(&graph->internal->sched);
+    }
     if (graph->internal->thread)
         slice_thread_uninit(graph->internal->thread);
     av_freep(&graph->internal->thread);
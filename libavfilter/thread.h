@@ -25,4 +25,26 @@ int ff_graph_thread_init(AVFilterGraph *graph);
 
 void ff_graph_thread_free(AVFilterGraph *graph);
 
+/**
+ * Activate the ready filters of the graph, several at a time, until
+ * nothing is left to do or every filter had a chance to run.
+ * Only valid if graph->internal->sched is set.
+ *
+ * @return 0 on success, AVERROR(EAGAIN) if no filter was ready or the
+ *         first error returned by an activation
+ */
+int ff_graph_sched_run(AVFilterGraph *graph);
+
+/**
+ * Lock and unlock the scheduling state of the graph: the ready fields of
+ * the filters and the sink links heap. No-ops without graph threading.
+ */
+void ff_graph_sched_lock(AVFilterGraph *graph);
+void ff_graph_sched_unlock(AVFilterGraph *graph);
+
+/**
+ * Set up the links of a configured graph for pipelining, if enabled.
+ */
+int ff_graph_sched_config(AVFilterGraph *graph);
+
 #endif /* AVFILTER_THREAD_H */
@@ -37,7 +37,7 @@ typedef struct UnsharpFilterParam {
     int steps_y;                             ///< vertical step count
     int scalebits;                           ///< bits to shift pixel
     int32_t halfscale;                       ///< amount to add to pixel
-    uint32_t *sc[MAX_MATRIX_SIZE - 1];       ///< finite state machine storage
+    uint32_t **sc;                           ///< finite state machine storage, 2 * steps_y rows per job
 } UnsharpFilterParam;
 
 typedef struct UnsharpContext {
@@ -48,7 +48,27 @@ typedef struct UnsharpContext {
     UnsharpFilterParam chroma; ///< chroma parameters (width, height, amount)
     int hsub, vsub;
     int opencl;
+    int nb_jobs;
+    uint32_t *line;            ///< per-job row of filtered sums, padded by steps_x on each side
+    int line_size;             ///< number of elements of each job's row
     int (* apply_unsharp)(AVFilterContext *ctx, AVFrame *in, AVFrame *out);
+
+    /**
+     * Feed one source row to the vertical state machine and write the
+     * vertically summed row to dst.
+     * sc holds nb_sc rows of at least width elements, rounded up to 8.
+     */
+    void (*column_sum)(uint32_t *dst, uint32_t *const *sc, int nb_sc,
+                       const uint8_t *src, int width);
+    /**
+     * Run nb_sr passes of pairwise horizontal sums in place; buf holds
+     * width + nb_sr elements on input and the width filtered sums on output.
+     */
+    void (*row_sum)(uint32_t *buf, int width, int nb_sr);
+    void (*sharpen)(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                    int width, int amount, int scalebits);
 } UnsharpContext;
 
+void ff_unsharp_init(UnsharpContext *s);
+
 #endif /* AVFILTER_UNSHARP_H */
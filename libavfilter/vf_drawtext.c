@@ -134,6 +134,26 @@ enum expansion_mode {
     EXP_STRFTIME,
 };
 
+/**
+ * Glyph bitmaps packed in rows of shelves, as 8 bits coverage.
+ */
+typedef struct GlyphAtlas {
+    uint8_t *data;
+    int linesize;                   ///< width of the atlas
+    int height;                     ///< number of allocated rows
+    int shelf_x, shelf_y, shelf_h;  ///< free position and height of the last shelf
+} GlyphAtlas;
+
+/**
+ * Coverage of all the glyphs of a text, blended in one pass.
+ */
+typedef struct TextMask {
+    uint8_t *data;
+    unsigned int size;
+    int linesize, w, h;
+    int x, y;                       ///< position relative to the text origin
+} TextMask;
+
 typedef struct DrawTextContext {
     const AVClass *class;
     int exp_mode;                   ///< expansion mode to use for the text
@@ -178,6 +198,13 @@ typedef struct DrawTextContext {
     FT_Face face;                   ///< freetype font face handle
     FT_Stroker stroker;             ///< freetype stroker handle
     struct AVTreeNode *glyphs;      ///< rendered glyphs, stored using the UTF-32 char code
+    GlyphAtlas atlas;               ///< bitmaps of the rendered glyphs
+    char *cache_text;               ///< expanded text the cached layout was made for
+    unsigned int cache_fontsize;    ///< font size the cached layout was made for
+    int cache_text_w, cache_text_h; ///< size of the cached text
+    int cache_y_min, cache_y_max;   ///< min descent and max ascent of the cached text
+    TextMask text_mask;             ///< coverage of the glyphs of the cached text
+    TextMask border_mask;           ///< coverage of the glyph borders of the cached text
     char *x_expr;                   ///< expression for x position
     char *y_expr;                   ///< expression for y position
     AVExpr *x_pexpr, *y_pexpr;      ///< parsed expressions for x and y
@@ -280,13 +307,15 @@ static const struct ft_error {
 
 #define FT_ERRMSG(e) ft_errors[e].err_msg
 
+typedef struct AtlasRect {
+    int x, y, w, h;
+} AtlasRect;
+
 typedef struct Glyph {
-    FT_Glyph glyph;
-    FT_Glyph border_glyph;
     uint32_t code;
     unsigned int fontsize;
-    FT_Bitmap bitmap; ///< array holding bitmaps of font
-    FT_Bitmap border_bitmap; ///< array holding bitmaps of font border
+    AtlasRect bitmap;        ///< position of the glyph bitmap in the atlas
+    AtlasRect border_bitmap; ///< position of the glyph border bitmap in the atlas
     FT_BBox bbox;
     int advance;
     int bitmap_left;
@@ -304,12 +333,87 @@ static int glyph_cmp(const void *key, const void *b)
          return FFDIFFSIGN((int64_t)a->fontsize, (int64_t)bb->fontsize);
 }
 
+#define ATLAS_WIDTH 1024
+
+static int atlas_resize(GlyphAtlas *atlas, int linesize, int height)
+{
+    uint8_t *data;
+    int y;
+
+    if (linesize > INT_MAX / height)
+        return AVERROR(ENOMEM);
+    data = av_malloc(linesize * height);
+    if (!data)
+        return AVERROR(ENOMEM);
+    for (y = 0; y < atlas->shelf_y + atlas->shelf_h; y++)
+        memcpy(data + y * linesize, atlas->data + y * atlas->linesize, atlas->linesize);
+    av_free(atlas->data);
+    atlas->data     = data;
+    atlas->linesize = linesize;
+    atlas->height   = height;
+    return 0;
+}
+
+/**
+ * Copy a rendered glyph bitmap into the atlas, expanding monochrome bitmaps
+ * to 8 bits coverage.
+ */
+static int atlas_add(GlyphAtlas *atlas, AtlasRect *rect, const FT_Bitmap *bitmap)
+{
+    int linesize = FFMAX(atlas->linesize, FFALIGN(bitmap->width, ATLAS_WIDTH));
+    int x, y, ret;
+
+    rect->x = rect->y = 0;
+    rect->w = bitmap->width;
+    rect->h = bitmap->rows;
+    if (!rect->w || !rect->h)
+        return 0;
+
+    if (atlas->shelf_x + rect->w > linesize) {
+        atlas->shelf_x  = 0;
+        atlas->shelf_y += atlas->shelf_h;
+        atlas->shelf_h  = 0;
+    }
+    if (linesize != atlas->linesize || atlas->shelf_y + rect->h > atlas->height) {
+        int height = atlas->height;
+
+        if (atlas->shelf_y + rect->h > height)
+            height = FFMAX(2 * height, atlas->shelf_y + rect->h);
+        if ((ret = atlas_resize(atlas, linesize, height)) < 0)
+            return ret;
+    }
+
+    rect->x = atlas->shelf_x;
+    rect->y = atlas->shelf_y;
+    for (y = 0; y < rect->h; y++) {
+        const uint8_t *src = bitmap->buffer + y * bitmap->pitch;
+        uint8_t *dst = atlas->data + (rect->y + y) * atlas->linesize + rect->x;
+
+        if (bitmap->pixel_mode == FT_PIXEL_MODE_MONO) {
+            for (x = 0; x < rect->w; x++)
+                dst[x] = (src[x >> 3] >> (~x & 7) & 1) * 255;
+        } else {
+            memcpy(dst, src, rect->w);
+        }
+    }
+    atlas->shelf_x += rect->w;
+    atlas->shelf_h  = FFMAX(atlas->shelf_h, rect->h);
+    return 0;
+}
+
+static int supported_bitmap(const FT_Bitmap *bitmap)
+{
+    return bitmap->pixel_mode == FT_PIXEL_MODE_MONO ||
+           bitmap->pixel_mode == FT_PIXEL_MODE_GRAY;
+}
+
 /**
  * Load glyphs corresponding to the UTF-32 codepoint code.
  */
 static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
 {
     DrawTextContext *s = ctx->priv;
+    FT_Glyph ft_glyph = NULL, border_glyph = NULL;
     FT_BitmapGlyph bitmapglyph;
     Glyph *glyph;
     struct AVTreeNode *node = NULL;
@@ -327,38 +431,57 @@ static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
     glyph->code  = code;
     glyph->fontsize = s->fontsize;
 
-    if (FT_Get_Glyph(s->face->glyph, &glyph->glyph)) {
+    if (FT_Get_Glyph(s->face->glyph, &ft_glyph)) {
         ret = AVERROR(EINVAL);
         goto error;
     }
     if (s->borderw) {
-        glyph->border_glyph = glyph->glyph;
-        if (FT_Glyph_StrokeBorder(&glyph->border_glyph, s->stroker, 0, 0) ||
-            FT_Glyph_To_Bitmap(&glyph->border_glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
+        FT_Glyph stroked = ft_glyph;
+
+        if (FT_Glyph_StrokeBorder(&stroked, s->stroker, 0, 0)) {
             ret = AVERROR_EXTERNAL;
             goto error;
         }
-        bitmapglyph = (FT_BitmapGlyph) glyph->border_glyph;
-        glyph->border_bitmap = bitmapglyph->bitmap;
+        border_glyph = stroked;
+        if (FT_Glyph_To_Bitmap(&border_glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
+            ret = AVERROR_EXTERNAL;
+            goto error;
+        }
+        bitmapglyph = (FT_BitmapGlyph) border_glyph;
+        if (!supported_bitmap(&bitmapglyph->bitmap)) {
+            ret = AVERROR(EINVAL);
+            goto error;
+        }
+        if ((ret = atlas_add(&s->atlas, &glyph->border_bitmap, &bitmapglyph->bitmap)) < 0)
+            goto error;
     }
-    if (FT_Glyph_To_Bitmap(&glyph->glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
+    if (FT_Glyph_To_Bitmap(&ft_glyph, FT_RENDER_MODE_NORMAL, 0, 1)) {
         ret = AVERROR_EXTERNAL;
         goto error;
     }
-    bitmapglyph = (FT_BitmapGlyph) glyph->glyph;
+    bitmapglyph = (FT_BitmapGlyph) ft_glyph;
+    if (!supported_bitmap(&bitmapglyph->bitmap)) {
+        ret = AVERROR(EINVAL);
+        goto error;
+    }
+    if ((ret = atlas_add(&s->atlas, &glyph->bitmap, &bitmapglyph->bitmap)) < 0)
+        goto error;
 
-    glyph->bitmap      = bitmapglyph->bitmap;
     glyph->bitmap_left = bitmapglyph->left;
     glyph->bitmap_top  = bitmapglyph->top;
     glyph->advance     = s->face->glyph->advance.x >> 6;
 
     /* measure text height to calculate text_height (or the maximum text height) */
-    FT_Glyph_Get_CBox(glyph->glyph, ft_glyph_bbox_pixels, &glyph->bbox);
+    FT_Glyph_Get_CBox(ft_glyph, ft_glyph_bbox_pixels, &glyph->bbox);
+
+    /* the bitmaps now live in the atlas */
+    FT_Done_Glyph(ft_glyph);
+    FT_Done_Glyph(border_glyph);
 
     /* cache the newly created glyph */
     if (!(node = av_tree_node_alloc())) {
-        ret = AVERROR(ENOMEM);
-        goto error;
+        av_freep(&glyph);
+        return AVERROR(ENOMEM);
     }
     av_tree_insert(&s->glyphs, glyph, glyph_cmp, &node);
 
@@ -367,9 +490,8 @@ static int load_glyph(AVFilterContext *ctx, Glyph **glyph_ptr, uint32_t code)
     return 0;
 
 error:
-    if (glyph)
-        av_freep(&glyph->glyph);
-
+    FT_Done_Glyph(ft_glyph);
+    FT_Done_Glyph(border_glyph);
     av_freep(&glyph);
     av_freep(&node);
     return ret;
@@ -785,10 +907,6 @@ static int query_formats(AVFilterContext *ctx)
 
 static int glyph_enu_free(void *opaque, void *elem)
 {
-    Glyph *glyph = elem;
-
-    FT_Done_Glyph(glyph->glyph);
-    FT_Done_Glyph(glyph->border_glyph);
     av_free(elem);
     return 0;
 }
@@ -810,6 +928,13 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_tree_enumerate(s->glyphs, NULL, NULL, glyph_enu_free);
     av_tree_destroy(s->glyphs);
     s->glyphs = NULL;
+    av_freep(&s->atlas.data);
+    memset(&s->atlas, 0, sizeof(s->atlas));
+
+    av_freep(&s->cache_text);
+    av_freep(&s->text_mask.data);
+    av_freep(&s->border_mask.data);
+    s->text_mask.size = s->border_mask.size = 0;
 
     FT_Done_Face(s->face);
     FT_Stroker_Done(s->stroker);
@@ -1174,51 +1299,82 @@ static int expand_text(AVFilterContext *ctx, char *text, AVBPrint *bp)
     return 0;
 }
 
-static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
-                       int width, int height,
-                       FFDrawColor *color,
-                       int x, int y, int borderw)
+/**
+ * Combine the bitmaps of all the glyphs of the expanded text, or of their
+ * borders, into one coverage mask.
+ */
+static int build_text_mask(DrawTextContext *s, TextMask *mask, int borderw)
 {
     char *text = s->expanded_text.str;
     uint32_t code = 0;
-    int i, x1, y1;
+    int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+    int i, pass, x, y;
     uint8_t *p;
-    Glyph *glyph = NULL;
 
-    for (i = 0, p = text; *p; i++) {
-        FT_Bitmap bitmap;
-        Glyph dummy = { 0 };
-        GET_UTF8(code, *p++, continue;);
-
-        /* skip new line chars, just go to new line */
-        if (code == '\n' || code == '\r' || code == '\t')
-            continue;
-
-        dummy.code = code;
-        dummy.fontsize = s->fontsize;
-        glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
-
-        bitmap = borderw ? glyph->border_bitmap : glyph->bitmap;
-
-        if (glyph->bitmap.pixel_mode != FT_PIXEL_MODE_MONO &&
-            glyph->bitmap.pixel_mode != FT_PIXEL_MODE_GRAY)
-            return AVERROR(EINVAL);
-
-        x1 = s->positions[i].x+s->x+x - borderw;
-        y1 = s->positions[i].y+s->y+y - borderw;
+    /* first find the bounding box of the bitmaps, then combine them */
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0, p = text; *p; i++) {
+            const AtlasRect *rect;
+            Glyph *glyph, dummy = { 0 };
+            GET_UTF8(code, *p++, continue;);
+
+            /* skip new line chars, just go to new line */
+            if (is_newline(code) || code == '\t')
+                continue;
+
+            dummy.code = code;
+            dummy.fontsize = s->fontsize;
+            glyph = av_tree_find(s->glyphs, &dummy, glyph_cmp, NULL);
+
+            rect = borderw ? &glyph->border_bitmap : &glyph->bitmap;
+            if (!rect->w || !rect->h)
+                continue;
+
+            x = s->positions[i].x - borderw;
+            y = s->positions[i].y - borderw;
+            if (!pass) {
+                x0 = FFMIN(x0, x);
+                y0 = FFMIN(y0, y);
+                x1 = FFMAX(x1, x + rect->w);
+                y1 = FFMAX(y1, y + rect->h);
+            } else {
+                const uint8_t *src = s->atlas.data + rect->y * s->atlas.linesize + rect->x;
+                uint8_t *dst = mask->data + (y - y0) * mask->linesize + x - x0;
+                int xx, yy;
+
+                /* union of the coverages where the glyphs overlap */
+                for (yy = 0; yy < rect->h; yy++) {
+                    for (xx = 0; xx < rect->w; xx++) {
+                        unsigned m = dst[xx], g = src[xx];
+                        dst[xx] = m + g - (m * g + 127) / 255;
+                    }
+                    src += s->atlas.linesize;
+                    dst += mask->linesize;
+                }
+            }
+        }
 
-        ff_blend_mask(&s->dc, color,
-                      frame->data, frame->linesize, width, height,
-                      bitmap.buffer, bitmap.pitch,
-                      bitmap.width, bitmap.rows,
-                      bitmap.pixel_mode == FT_PIXEL_MODE_MONO ? 0 : 3,
-                      0, x1, y1);
+        if (!pass) {
+            if (x0 >= x1) {
+                mask->w = mask->h = 0;
+                return 0;
+            }
+            if (x1 - x0 > INT_MAX / (y1 - y0))
+                return AVERROR(EINVAL);
+            mask->x = x0;
+            mask->y = y0;
+            mask->w = mask->linesize = x1 - x0;
+            mask->h = y1 - y0;
+            av_fast_malloc(&mask->data, &mask->size, mask->linesize * mask->h);
+            if (!mask->data)
+                return AVERROR(ENOMEM);
+            memset(mask->data, 0, mask->linesize * mask->h);
+        }
     }
 
     return 0;
 }
 
-
 static void update_color_with_alpha(DrawTextContext *s, FFDrawColor *color, const FFDrawColor incolor)
 {
     *color = incolor;
@@ -1241,17 +1397,18 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
-static int draw_text(AVFilterContext *ctx, AVFrame *frame,
-                     int width, int height)
+/**
+ * Load the glyphs of the expanded text, compute their positions and combine
+ * them into the text masks, which are reused as long as the text does not
+ * change.
+ */
+static int layout_text(AVFilterContext *ctx)
 {
     DrawTextContext *s = ctx->priv;
-    AVFilterLink *inlink = ctx->inputs[0];
-
     uint32_t code = 0, prev_code = 0;
     int x = 0, y = 0, i = 0, ret;
     int max_text_line_w = 0, len;
-    int box_w, box_h;
-    char *text;
+    char *text = s->expanded_text.str;
     uint8_t *p;
     int y_min = 32000, y_max = -32000;
     int x_min = 32000, x_max = -32000;
@@ -1259,44 +1416,8 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     Glyph *glyph = NULL, *prev_glyph = NULL;
     Glyph dummy = { 0 };
 
-    time_t now = time(0);
-    struct tm ltime;
-    AVBPrint *bp = &s->expanded_text;
-
-    FFDrawColor fontcolor;
-    FFDrawColor shadowcolor;
-    FFDrawColor bordercolor;
-    FFDrawColor boxcolor;
-
-    av_bprint_clear(bp);
-
-    if(s->basetime != AV_NOPTS_VALUE)
-        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
-
-    switch (s->exp_mode) {
-    case EXP_NONE:
-        av_bprintf(bp, "%s", s->text);
-        break;
-    case EXP_NORMAL:
-        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
-            return ret;
-        break;
-    case EXP_STRFTIME:
-        localtime_r(&now, &ltime);
-        av_bprint_strftime(bp, s->text, &ltime);
-        break;
-    }
-
-    if (s->tc_opt_string) {
-        char tcbuf[AV_TIMECODE_STR_SIZE];
-        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count_out);
-        av_bprint_clear(bp);
-        av_bprintf(bp, "%s%s", s->text, tcbuf);
-    }
+    av_freep(&s->cache_text);
 
-    if (!av_bprint_is_complete(bp))
-        return AVERROR(ENOMEM);
-    text = s->expanded_text.str;
     if ((len = s->expanded_text.len) > s->nb_positions) {
         if (!(s->positions =
               av_realloc(s->positions, len*sizeof(*s->positions))))
@@ -1304,26 +1425,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         s->nb_positions = len;
     }
 
-    if (s->fontcolor_expr[0]) {
-        /* If expression is set, evaluate and replace the static value */
-        av_bprint_clear(&s->expanded_fontcolor);
-        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
-            return ret;
-        if (!av_bprint_is_complete(&s->expanded_fontcolor))
-            return AVERROR(ENOMEM);
-        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
-        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
-        if (ret)
-            return ret;
-        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
-    }
-
-    x = 0;
-    y = 0;
-
-    if ((ret = update_fontsize(ctx)) < 0)
-        return ret;
-
     /* load and cache glyphs */
     for (i = 0, p = text; *p; i++) {
         GET_UTF8(code, *p++, continue;);
@@ -1386,13 +1487,170 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
 
     max_text_line_w = FFMAX(x, max_text_line_w);
 
-    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = max_text_line_w;
-    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = y + s->max_glyph_h;
+    s->cache_text_w = max_text_line_w;
+    s->cache_text_h = y + s->max_glyph_h;
+    s->cache_y_min  = y_min;
+    s->cache_y_max  = y_max;
+
+    if ((ret = build_text_mask(s, &s->text_mask, 0)) < 0)
+        return ret;
+    if (s->borderw && (ret = build_text_mask(s, &s->border_mask, s->borderw)) < 0)
+        return ret;
+
+    if (!(s->cache_text = av_strdup(text)))
+        return AVERROR(ENOMEM);
+    s->cache_fontsize = s->fontsize;
+
+    return 0;
+}
+
+typedef struct ThreadData {
+    AVFrame *frame;
+    FFDrawColor *fontcolor, *shadowcolor, *bordercolor, *boxcolor;
+    int width, height;
+    int box_w, box_h;
+    int y0, y1;                     ///< frame rows covered by the drawing
+} ThreadData;
+
+static void blend_text_mask(DrawTextContext *s, FFDrawColor *color,
+                            uint8_t *data[4], int *linesize, int width, int height,
+                            const TextMask *mask, int x, int y)
+{
+    if (mask->w && mask->h)
+        ff_blend_mask(&s->dc, color, data, linesize, width, height,
+                      mask->data, mask->linesize, mask->w, mask->h,
+                      3, 0, x + mask->x, y + mask->y);
+}
+
+/**
+ * Draw the part of the box and text in a band of rows. The bands are aligned
+ * on the chroma subsampling so the result does not depend on the slicing.
+ */
+static int draw_text_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *frame = td->frame;
+    int vsub = s->dc.vsub_max;
+    int units = (td->y1 - td->y0 + (1 << vsub) - 1) >> vsub;
+    int start = td->y0 + ((units *  jobnr      / nb_jobs) << vsub);
+    int end   = td->y0 + ((units * (jobnr + 1) / nb_jobs) << vsub);
+    int x = s->x, y = s->y - start, height;
+    uint8_t *data[4] = { NULL };
+    int i;
+
+    end    = FFMIN(end, td->height);
+    height = end - start;
+    if (height <= 0)
+        return 0;
+    for (i = 0; i < s->dc.nb_planes; i++)
+        data[i] = frame->data[i] + (start >> s->dc.vsub[i]) * frame->linesize[i];
+
+    if (s->draw_box)
+        ff_blend_rectangle(&s->dc, td->boxcolor,
+                           data, frame->linesize, td->width, height,
+                           x - s->boxborderw, y - s->boxborderw,
+                           td->box_w + s->boxborderw * 2, td->box_h + s->boxborderw * 2);
+
+    if (s->shadowx || s->shadowy)
+        blend_text_mask(s, td->shadowcolor, data, frame->linesize, td->width, height,
+                        &s->text_mask, x + s->shadowx, y + s->shadowy);
+
+    if (s->borderw)
+        blend_text_mask(s, td->bordercolor, data, frame->linesize, td->width, height,
+                        &s->border_mask, x, y);
+
+    blend_text_mask(s, td->fontcolor, data, frame->linesize, td->width, height,
+                    &s->text_mask, x, y);
+
+    return 0;
+}
+
+static void update_extent(int *y0, int *y1, int y, int h)
+{
+    if (h > 0) {
+        *y0 = FFMIN(*y0, y);
+        *y1 = FFMAX(*y1, y + h);
+    }
+}
+
+static int draw_text(AVFilterContext *ctx, AVFrame *frame,
+                     int width, int height)
+{
+    DrawTextContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+
+    ThreadData td;
+    int ret, nb_jobs;
+
+    time_t now = time(0);
+    struct tm ltime;
+    AVBPrint *bp = &s->expanded_text;
+
+    FFDrawColor fontcolor;
+    FFDrawColor shadowcolor;
+    FFDrawColor bordercolor;
+    FFDrawColor boxcolor;
+
+    av_bprint_clear(bp);
+
+    if(s->basetime != AV_NOPTS_VALUE)
+        now= frame->pts*av_q2d(ctx->inputs[0]->time_base) + s->basetime/1000000;
+
+    switch (s->exp_mode) {
+    case EXP_NONE:
+        av_bprintf(bp, "%s", s->text);
+        break;
+    case EXP_NORMAL:
+        if ((ret = expand_text(ctx, s->text, &s->expanded_text)) < 0)
+            return ret;
+        break;
+    case EXP_STRFTIME:
+        localtime_r(&now, &ltime);
+        av_bprint_strftime(bp, s->text, &ltime);
+        break;
+    }
+
+    if (s->tc_opt_string) {
+        char tcbuf[AV_TIMECODE_STR_SIZE];
+        av_timecode_make_string(&s->tc, tcbuf, inlink->frame_count_out);
+        av_bprint_clear(bp);
+        av_bprintf(bp, "%s%s", s->text, tcbuf);
+    }
+
+    if (!av_bprint_is_complete(bp))
+        return AVERROR(ENOMEM);
+
+    if (s->fontcolor_expr[0]) {
+        /* If expression is set, evaluate and replace the static value */
+        av_bprint_clear(&s->expanded_fontcolor);
+        if ((ret = expand_text(ctx, s->fontcolor_expr, &s->expanded_fontcolor)) < 0)
+            return ret;
+        if (!av_bprint_is_complete(&s->expanded_fontcolor))
+            return AVERROR(ENOMEM);
+        av_log(s, AV_LOG_DEBUG, "Evaluated fontcolor is '%s'\n", s->expanded_fontcolor.str);
+        ret = av_parse_color(s->fontcolor.rgba, s->expanded_fontcolor.str, -1, s);
+        if (ret)
+            return ret;
+        ff_draw_color(&s->dc, &s->fontcolor, s->fontcolor.rgba);
+    }
+
+    if ((ret = update_fontsize(ctx)) < 0)
+        return ret;
+
+    if (!s->cache_text || s->cache_fontsize != s->fontsize ||
+        strcmp(s->cache_text, s->expanded_text.str)) {
+        if ((ret = layout_text(ctx)) < 0)
+            return ret;
+    }
+
+    s->var_values[VAR_TW] = s->var_values[VAR_TEXT_W] = s->cache_text_w;
+    s->var_values[VAR_TH] = s->var_values[VAR_TEXT_H] = s->cache_text_h;
 
     s->var_values[VAR_MAX_GLYPH_W] = s->max_glyph_w;
     s->var_values[VAR_MAX_GLYPH_H] = s->max_glyph_h;
-    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = y_max;
-    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = y_min;
+    s->var_values[VAR_MAX_GLYPH_A] = s->var_values[VAR_ASCENT ] = s->cache_y_max;
+    s->var_values[VAR_MAX_GLYPH_D] = s->var_values[VAR_DESCENT] = s->cache_y_min;
 
     s->var_values[VAR_LINE_H] = s->var_values[VAR_LH] = s->max_glyph_h;
 
@@ -1407,8 +1665,8 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
     update_color_with_alpha(s, &bordercolor, s->bordercolor);
     update_color_with_alpha(s, &boxcolor   , s->boxcolor   );
 
-    box_w = max_text_line_w;
-    box_h = y + s->max_glyph_h;
+    td.box_w = s->cache_text_w;
+    td.box_h = s->cache_text_h;
 
     if (s->fix_bounds) {
 
@@ -1430,33 +1688,37 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame,
         if (s->x - offsetleft < 0) s->x = offsetleft;
         if (s->y - offsettop < 0)  s->y = offsettop;
 
-        if (s->x + box_w + offsetright > width)
-            s->x = FFMAX(width - box_w - offsetright, 0);
-        if (s->y + box_h + offsetbottom > height)
-            s->y = FFMAX(height - box_h - offsetbottom, 0);
+        if (s->x + td.box_w + offsetright > width)
+            s->x = FFMAX(width - td.box_w - offsetright, 0);
+        if (s->y + td.box_h + offsetbottom > height)
+            s->y = FFMAX(height - td.box_h - offsetbottom, 0);
     }
 
-    /* draw box */
+    /* rows covered by the box, shadow, border and text */
+    td.y0 = INT_MAX;
+    td.y1 = INT_MIN;
     if (s->draw_box)
-        ff_blend_rectangle(&s->dc, &boxcolor,
-                           frame->data, frame->linesize, width, height,
-                           s->x - s->boxborderw, s->y - s->boxborderw,
-                           box_w + s->boxborderw * 2, box_h + s->boxborderw * 2);
-
-    if (s->shadowx || s->shadowy) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &shadowcolor, s->shadowx, s->shadowy, 0)) < 0)
-            return ret;
-    }
+        update_extent(&td.y0, &td.y1, s->y - s->boxborderw, td.box_h + s->boxborderw * 2);
+    if (s->shadowx || s->shadowy)
+        update_extent(&td.y0, &td.y1, s->y + s->shadowy + s->text_mask.y, s->text_mask.h);
+    if (s->borderw)
+        update_extent(&td.y0, &td.y1, s->y + s->border_mask.y, s->border_mask.h);
+    update_extent(&td.y0, &td.y1, s->y + s->text_mask.y, s->text_mask.h);
+    td.y0 = FFMAX(td.y0, 0) & ~((1 << s->dc.vsub_max) - 1);
+    td.y1 = FFMIN(td.y1, height);
+    if (td.y0 >= td.y1)
+        return 0;
 
-    if (s->borderw) {
-        if ((ret = draw_glyphs(s, frame, width, height,
-                               &bordercolor, 0, 0, s->borderw)) < 0)
-            return ret;
-    }
-    if ((ret = draw_glyphs(s, frame, width, height,
-                           &fontcolor, 0, 0, 0)) < 0)
-        return ret;
+    td.frame       = frame;
+    td.width       = width;
+    td.height      = height;
+    td.fontcolor   = &fontcolor;
+    td.shadowcolor = &shadowcolor;
+    td.bordercolor = &bordercolor;
+    td.boxcolor    = &boxcolor;
+    nb_jobs = FFMIN((td.y1 - td.y0 + (1 << s->dc.vsub_max) - 1) >> s->dc.vsub_max,
+                    ff_filter_get_nb_threads(ctx));
+    ctx->internal->execute(ctx, draw_text_slice, &td, NULL, nb_jobs);
 
     return 0;
 }
@@ -1529,5 +1791,5 @@ AVFilter ff_vf_drawtext = {
     .inputs        = avfilter_vf_drawtext_inputs,
     .outputs       = avfilter_vf_drawtext_outputs,
     .process_command = command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -153,22 +153,36 @@ static int denoise_depth(HQDN3DContext *s,
     return 0;
 }
 
-#define denoise(...)                                                          \
-    do {                                                                      \
-        int ret = AVERROR_BUG;                                                \
-        switch (s->depth) {                                                   \
-            case  8: ret = denoise_depth(__VA_ARGS__,  8); break;             \
-            case  9: ret = denoise_depth(__VA_ARGS__,  9); break;             \
-            case 10: ret = denoise_depth(__VA_ARGS__, 10); break;             \
-            case 16: ret = denoise_depth(__VA_ARGS__, 16); break;             \
-        }                                                                     \
-        if (ret < 0) {                                                        \
-            av_frame_free(&out);                                              \
-            if (!direct)                                                      \
-                av_frame_free(&in);                                           \
-            return ret;                                                       \
-        }                                                                     \
-    } while (0)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+/* The spatial filter is recursive both along and across the rows, so the
+ * work is split by plane. */
+static int do_denoise(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    HQDN3DContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    AVFrame *out = td->out;
+    AVFrame *in = td->in;
+    const int c = jobnr;
+
+#define DENOISE(depth)                                                        \
+    denoise_depth(s, in->data[c], out->data[c], s->line[c], &s->frame_prev[c], \
+                  AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),                \
+                  AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),                \
+                  in->linesize[c], out->linesize[c],                          \
+                  s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],                \
+                  s->coefs[c ? CHROMA_TMP     : LUMA_TMP], depth)
+
+    switch (s->depth) {
+    case  8: return DENOISE(8);
+    case  9: return DENOISE(9);
+    case 10: return DENOISE(10);
+    case 16: return DENOISE(16);
+    }
+    return AVERROR_BUG;
+}
 
 static int16_t *precalc_coefs(double dist25, int depth)
 {
@@ -223,7 +237,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->coefs[1]);
     av_freep(&s->coefs[2]);
     av_freep(&s->coefs[3]);
-    av_freep(&s->line);
+    av_freep(&s->line[0]);
+    av_freep(&s->line[1]);
+    av_freep(&s->line[2]);
     av_freep(&s->frame_prev[0]);
     av_freep(&s->frame_prev[1]);
     av_freep(&s->frame_prev[2]);
@@ -271,9 +287,11 @@ static int config_input(AVFilterLink *inlink)
     s->vsub  = desc->log2_chroma_h;
     s->depth = desc->comp[0].depth;
 
-    s->line = av_malloc_array(inlink->w, sizeof(*s->line));
-    if (!s->line)
-        return AVERROR(ENOMEM);
+    for (i = 0; i < 3; i++) {
+        s->line[i] = av_malloc_array(inlink->w, sizeof(*s->line[i]));
+        if (!s->line[i])
+            return AVERROR(ENOMEM);
+    }
 
     for (i = 0; i < 4; i++) {
         s->coefs[i] = precalc_coefs(s->strength[i], s->depth);
@@ -290,11 +308,11 @@ static int config_input(AVFilterLink *inlink)
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx  = inlink->dst;
-    HQDN3DContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
 
     AVFrame *out;
-    int c, direct = av_frame_is_writable(in) && !ctx->is_disabled;
+    ThreadData td;
+    int c, ret[3], direct = av_frame_is_writable(in) && !ctx->is_disabled;
 
     if (direct) {
         out = in;
@@ -308,14 +326,16 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         av_frame_copy_props(out, in);
     }
 
+    td.in  = in;
+    td.out = out;
+    ctx->internal->execute(ctx, do_denoise, &td, ret, 3);
     for (c = 0; c < 3; c++) {
-        denoise(s, in->data[c], out->data[c],
-                s->line, &s->frame_prev[c],
-                AV_CEIL_RSHIFT(in->width,  (!!c * s->hsub)),
-                AV_CEIL_RSHIFT(in->height, (!!c * s->vsub)),
-                in->linesize[c], out->linesize[c],
-                s->coefs[c ? CHROMA_SPATIAL : LUMA_SPATIAL],
-                s->coefs[c ? CHROMA_TMP     : LUMA_TMP]);
+        if (ret[c] < 0) {
+            if (out != in)
+                av_frame_free(&out);
+            av_frame_free(&in);
+            return ret[c];
+        }
     }
 
     if (ctx->is_disabled) {
@@ -370,5 +390,5 @@ AVFilter ff_vf_hqdn3d = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_hqdn3d_inputs,
     .outputs       = avfilter_vf_hqdn3d_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL | AVFILTER_FLAG_SLICE_THREADS,
 };
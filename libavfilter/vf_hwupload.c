@@ -52,6 +52,7 @@ static int hwupload_query_formats(AVFilterContext *avctx)
         return AVERROR(EINVAL);
     }
 
+    av_buffer_unref(&ctx->hwdevice_ref);
     ctx->hwdevice_ref = av_buffer_ref(avctx->hw_device_ctx);
     if (!ctx->hwdevice_ref)
         return AVERROR(ENOMEM);
@@ -234,5 +235,6 @@ AVFilter ff_vf_hwupload = {
     .priv_class    = &hwupload_class,
     .inputs        = hwupload_inputs,
     .outputs       = hwupload_outputs,
-    .flags_internal = FF_FILTER_FLAG_HWFRAME_AWARE,
+    .flags_internal = FF_FILTER_FLAG_HWFRAME_AWARE |
+                      FF_FILTER_FLAG_QUERY_FORMATS_STATE,
 };
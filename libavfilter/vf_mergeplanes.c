@@ -308,4 +308,5 @@ AVFilter ff_vf_mergeplanes = {
     .inputs        = NULL,
     .outputs       = mergeplanes_outputs,
     .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags_internal = FF_FILTER_FLAG_QUERY_FORMATS_STATE,
 };
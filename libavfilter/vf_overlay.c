@@ -186,6 +186,27 @@ static int query_formats(AVFilterContext *ctx)
         AV_PIX_FMT_YUVA444P, AV_PIX_FMT_NONE
     };
 
+    static const enum AVPixelFormat main_pix_fmts_yuv420p10[] = {
+        AV_PIX_FMT_YUV420P10, AV_PIX_FMT_NONE
+    };
+    static const enum AVPixelFormat overlay_pix_fmts_yuv420p10[] = {
+        AV_PIX_FMT_YUVA420P10, AV_PIX_FMT_NONE
+    };
+
+    static const enum AVPixelFormat main_pix_fmts_yuv422p10[] = {
+        AV_PIX_FMT_YUV422P10, AV_PIX_FMT_NONE
+    };
+    static const enum AVPixelFormat overlay_pix_fmts_yuv422p10[] = {
+        AV_PIX_FMT_YUVA422P10, AV_PIX_FMT_NONE
+    };
+
+    static const enum AVPixelFormat main_pix_fmts_yuv444p10[] = {
+        AV_PIX_FMT_YUV444P10, AV_PIX_FMT_NONE
+    };
+    static const enum AVPixelFormat overlay_pix_fmts_yuv444p10[] = {
+        AV_PIX_FMT_YUVA444P10, AV_PIX_FMT_NONE
+    };
+
     static const enum AVPixelFormat main_pix_fmts_gbrp[] = {
         AV_PIX_FMT_GBRP, AV_PIX_FMT_GBRAP, AV_PIX_FMT_NONE
     };
@@ -245,6 +266,27 @@ static int query_formats(AVFilterContext *ctx)
                 goto fail;
             }
         break;
+    case OVERLAY_FORMAT_YUV420P10:
+        if (!(main_formats    = ff_make_format_list(main_pix_fmts_yuv420p10)) ||
+            !(overlay_formats = ff_make_format_list(overlay_pix_fmts_yuv420p10))) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        break;
+    case OVERLAY_FORMAT_YUV422P10:
+        if (!(main_formats    = ff_make_format_list(main_pix_fmts_yuv422p10)) ||
+            !(overlay_formats = ff_make_format_list(overlay_pix_fmts_yuv422p10))) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        break;
+    case OVERLAY_FORMAT_YUV444P10:
+        if (!(main_formats    = ff_make_format_list(main_pix_fmts_yuv444p10)) ||
+            !(overlay_formats = ff_make_format_list(overlay_pix_fmts_yuv444p10))) {
+                ret = AVERROR(ENOMEM);
+                goto fail;
+            }
+        break;
     case OVERLAY_FORMAT_AUTO:
         if (!(main_formats    = ff_make_format_list(alpha_pix_fmts))) {
                 ret = AVERROR(ENOMEM);
@@ -308,6 +350,10 @@ static int config_input_overlay(AVFilterLink *inlink)
         ff_fill_rgba_map(s->overlay_rgba_map, inlink->format) >= 0;
     s->overlay_has_alpha = ff_fmt_is_in(inlink->format, alpha_pix_fmts);
 
+    /* the packed RGB row blending needs the layout of both inputs */
+    ff_overlay_init_blend_row(s, s->format, ctx->inputs[MAIN]->format,
+                              s->alpha_format, s->main_has_alpha);
+
     if (s->eval_mode == EVAL_MODE_INIT) {
         eval_expr(ctx);
         av_log(ctx, AV_LOG_VERBOSE, "x:%f xi:%d y:%f yi:%d\n",
@@ -350,6 +396,30 @@ static int config_output(AVFilterLink *outlink)
 // ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)) is a faster version of: 255 * (x + y)
 #define UNPREMULTIPLY_ALPHA(x, y) ((((x) << 16) - ((x) << 9) + (x)) / ((((x) + (y)) << 8) - ((x) + (y)) - (y) * (x)))
 
+#define FAST_DIV1023(x) ((((x) + 512) * 1025) >> 20)
+
+/**
+ * Get the rows [*start, *end) of a plane of the overlay at vertical position
+ * y blended by job jobnr. The jobs split the overlay on multiples of
+ * 1 << vsub_max rows, so that they access disjoint rows in all the planes,
+ * including the alpha of the main picture.
+ */
+static av_always_inline void slice_rows(int y, int src_h, int dst_h,
+                                        int vsub, int vsub_max,
+                                        int jobnr, int nb_jobs,
+                                        int *start, int *end)
+{
+    const int first = FFMAX(-y, 0);
+    const int last  = FFMIN(src_h, dst_h - y);
+    const int mask  = (1 << vsub_max) - 1;
+    int slice_start = first + ((last - first) * jobnr / nb_jobs & ~mask);
+    int slice_end   = jobnr + 1 == nb_jobs ? last :
+                      first + ((last - first) * (jobnr + 1) / nb_jobs & ~mask);
+
+    *start = slice_start >> vsub;
+    *end   = AV_CEIL_RSHIFT(slice_end, vsub);
+}
+
 /**
  * Blend image in src to destination buffer dst at position (x, y).
  */
@@ -360,7 +430,7 @@ static av_always_inline void blend_slice_packed_rgb(AVFilterContext *ctx,
                                    int is_straight, int jobnr, int nb_jobs)
 {
     OverlayContext *s = ctx->priv;
-    int i, imax, j, jmax;
+    int i, j, jmax;
     const int src_w = src->width;
     const int src_h = src->height;
     const int dst_w = dst->width;
@@ -379,11 +449,7 @@ static av_always_inline void blend_slice_packed_rgb(AVFilterContext *ctx,
     int slice_start, slice_end;
     uint8_t *S, *sp, *d, *dp;
 
-    i = FFMAX(-y, 0);
-    imax = FFMIN3(-y + dst_h, FFMIN(src_h, dst_h), y + src_h);
-
-    slice_start = i + (imax * jobnr) / nb_jobs;
-    slice_end = i + (imax * (jobnr+1)) / nb_jobs;
+    slice_rows(y, src_h, dst_h, 0, 0, jobnr, nb_jobs, &slice_start, &slice_end);
 
     sp = src->data[0] + (slice_start)     * src->linesize[0];
     dp = dst->data[0] + (y + slice_start) * dst->linesize[0];
@@ -392,8 +458,16 @@ static av_always_inline void blend_slice_packed_rgb(AVFilterContext *ctx,
         j = FFMAX(-x, 0);
         S = sp + j     * sstep;
         d = dp + (x+j) * dstep;
+        jmax = FFMIN(-x + dst_w, src_w);
 
-        for (jmax = FFMIN(-x + dst_w, src_w); j < jmax; j++) {
+        if (!main_has_alpha && s->blend_row_rgb) {
+            int c = s->blend_row_rgb(d, S, jmax - j, s->rgb_shuf);
+
+            S += c * sstep;
+            d += c * dstep;
+            j += c;
+        }
+        for (; j < jmax; j++) {
             alpha = S[sa];
 
             // if the main channel has an alpha channel, alpha has to be calculated
@@ -460,18 +534,14 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
     int src_wp = AV_CEIL_RSHIFT(src_w, hsub);
     int src_hp = AV_CEIL_RSHIFT(src_h, vsub);
     int dst_wp = AV_CEIL_RSHIFT(dst_w, hsub);
-    int dst_hp = AV_CEIL_RSHIFT(dst_h, vsub);
     int yp = y>>vsub;
     int xp = x>>hsub;
     uint8_t *s, *sp, *d, *dp, *dap, *a, *da, *ap;
-    int jmax, j, k, kmax;
+    int j, k, kmax;
     int slice_start, slice_end;
 
-    j = FFMAX(-yp, 0);
-    jmax = FFMIN3(-yp + dst_hp, FFMIN(src_hp, dst_hp), yp + src_hp);
-
-    slice_start = j + (jmax * jobnr) / nb_jobs;
-    slice_end = j + (jmax * (jobnr+1)) / nb_jobs;
+    slice_rows(y, src_h, dst_h, vsub, octx->vsub, jobnr, nb_jobs,
+               &slice_start, &slice_end);
 
     sp = src->data[i] + (slice_start) * src->linesize[i];
     dp = dst->data[dst_plane]
@@ -534,7 +604,7 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
                 *d = FAST_DIV255(*d * (255 - alpha) + *s * alpha);
             } else {
                 if (i && yuv)
-                    *d = av_clip(FAST_DIV255((*d - 128) * (255 - alpha)) + *s - 128, -128, 128) + 128;
+                    *d = av_clip_int8(FAST_DIV255((*d - 128) * (255 - alpha)) + *s - 128) + 128;
                 else
                     *d = FFMIN(FAST_DIV255(*d * (255 - alpha)) + *s, 255);
             }
@@ -553,23 +623,20 @@ static av_always_inline void blend_plane(AVFilterContext *ctx,
 static inline void alpha_composite(const AVFrame *src, const AVFrame *dst,
                                    int src_w, int src_h,
                                    int dst_w, int dst_h,
-                                   int x, int y,
+                                   int x, int y, int vsub,
                                    int jobnr, int nb_jobs)
 {
     uint8_t alpha;          ///< the amount of overlay to blend on to main
     uint8_t *s, *sa, *d, *da;
-    int i, imax, j, jmax;
+    int i, j, jmax;
     int slice_start, slice_end;
 
-    imax = FFMIN(-y + dst_h, src_h);
-    slice_start = (imax * jobnr) / nb_jobs;
-    slice_end = ((imax * (jobnr+1)) / nb_jobs);
+    slice_rows(y, src_h, dst_h, 0, vsub, jobnr, nb_jobs, &slice_start, &slice_end);
 
-    i = FFMAX(-y, 0);
-    sa = src->data[3] + (i + slice_start) * src->linesize[3];
-    da = dst->data[3] + (y + i + slice_start) * dst->linesize[3];
+    sa = src->data[3] + slice_start       * src->linesize[3];
+    da = dst->data[3] + (y + slice_start) * dst->linesize[3];
 
-    for (i = i + slice_start; i < slice_end; i++) {
+    for (i = slice_start; i < slice_end; i++) {
         j = FFMAX(-x, 0);
         s = sa + j;
         d = da + x+j;
@@ -623,7 +690,7 @@ static av_always_inline void blend_slice_yuv(AVFilterContext *ctx,
                 jobnr, nb_jobs);
 
     if (main_has_alpha)
-        alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y, jobnr, nb_jobs);
+        alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y, vsub, jobnr, nb_jobs);
 }
 
 static av_always_inline void blend_slice_planar_rgb(AVFilterContext *ctx,
@@ -652,7 +719,82 @@ static av_always_inline void blend_slice_planar_rgb(AVFilterContext *ctx,
                 jobnr, nb_jobs);
 
     if (main_has_alpha)
-        alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y, jobnr, nb_jobs);
+        alpha_composite(src, dst, src_w, src_h, dst_w, dst_h, x, y, vsub, jobnr, nb_jobs);
+}
+
+static av_always_inline void blend_plane_16(AVFilterContext *ctx,
+                                            AVFrame *dst, const AVFrame *src,
+                                            int i, int hsub, int vsub,
+                                            int x, int y,
+                                            int depth,
+                                            int straight,
+                                            int jobnr,
+                                            int nb_jobs)
+{
+    OverlayContext *octx = ctx->priv;
+    const int max = (1 << depth) - 1;
+    const int mid = 1 << (depth - 1);
+    int src_wp = AV_CEIL_RSHIFT(src->width,  hsub);
+    int src_hp = AV_CEIL_RSHIFT(src->height, vsub);
+    int dst_wp = AV_CEIL_RSHIFT(dst->width,  hsub);
+    int yp = y>>vsub;
+    int xp = x>>hsub;
+    ptrdiff_t alinesize = src->linesize[3] / 2;
+    int j, k, kmax;
+    int slice_start, slice_end;
+
+    slice_rows(y, src->height, dst->height, vsub, octx->vsub, jobnr, nb_jobs,
+               &slice_start, &slice_end);
+
+    for (j = slice_start; j < slice_end; j++) {
+        const uint16_t *s = (const uint16_t *)(src->data[i] + j * src->linesize[i]);
+        const uint16_t *ap = (const uint16_t *)(src->data[3] + (j << vsub) * src->linesize[3]);
+        uint16_t *d = (uint16_t *)(dst->data[i] + (yp + j) * dst->linesize[i]) + xp;
+
+        k = FFMAX(-xp, 0);
+        kmax = FFMIN(-xp + dst_wp, src_wp);
+
+        if (((vsub && j+1 < src_hp) || !vsub) && octx->blend_row[i])
+            k += octx->blend_row[i]((uint8_t *)(d + k), NULL, (uint8_t *)(s + k),
+                                    (uint8_t *)(ap + (k << hsub)), kmax - k,
+                                    src->linesize[3]);
+
+        for (; k < kmax; k++) {
+            const uint16_t *a = ap + (k << hsub);
+            int alpha_v, alpha_h, alpha;
+
+            // average alpha for color components, improve quality
+            if (hsub && vsub && j+1 < src_hp && k+1 < src_wp) {
+                alpha = (a[0] + a[alinesize] +
+                         a[1] + a[alinesize+1]) >> 2;
+            } else if (hsub || vsub) {
+                alpha_h = hsub && k+1 < src_wp ?
+                    (a[0] + a[1]) >> 1 : a[0];
+                alpha_v = vsub && j+1 < src_hp ?
+                    (a[0] + a[alinesize]) >> 1 : a[0];
+                alpha = (alpha_v + alpha_h) >> 1;
+            } else
+                alpha = a[0];
+            if (straight)
+                d[k] = FAST_DIV1023(d[k] * (max - alpha) + s[k] * alpha);
+            else if (i)
+                d[k] = av_clip(FAST_DIV1023((d[k] - mid) * (max - alpha)) + s[k] - mid, -mid, mid - 1) + mid;
+            else
+                d[k] = FFMIN(FAST_DIV1023(d[k] * (max - alpha)) + s[k], max);
+        }
+    }
+}
+
+static av_always_inline void blend_slice_yuv_16(AVFilterContext *ctx,
+                                                AVFrame *dst, const AVFrame *src,
+                                                int hsub, int vsub,
+                                                int x, int y,
+                                                int is_straight,
+                                                int jobnr, int nb_jobs)
+{
+    blend_plane_16(ctx, dst, src, 0, 0,       0, x, y, 10, is_straight, jobnr, nb_jobs);
+    blend_plane_16(ctx, dst, src, 1, hsub, vsub, x, y, 10, is_straight, jobnr, nb_jobs);
+    blend_plane_16(ctx, dst, src, 2, hsub, vsub, x, y, 10, is_straight, jobnr, nb_jobs);
 }
 
 static int blend_slice_yuv420(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
@@ -815,6 +957,231 @@ static int blend_slice_rgba_pm(AVFilterContext *ctx, void *arg, int jobnr, int n
     return 0;
 }
 
+static int blend_slice_yuv420p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    blend_slice_yuv_16(ctx, td->dst, td->src, 1, 1, s->x, s->y, 1, jobnr, nb_jobs);
+    return 0;
+}
+
+static int blend_slice_yuv420p10_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    blend_slice_yuv_16(ctx, td->dst, td->src, 1, 1, s->x, s->y, 0, jobnr, nb_jobs);
+    return 0;
+}
+
+static int blend_slice_yuv422p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    blend_slice_yuv_16(ctx, td->dst, td->src, 1, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    return 0;
+}
+
+static int blend_slice_yuv422p10_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    blend_slice_yuv_16(ctx, td->dst, td->src, 1, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    return 0;
+}
+
+static int blend_slice_yuv444p10(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    blend_slice_yuv_16(ctx, td->dst, td->src, 0, 0, s->x, s->y, 1, jobnr, nb_jobs);
+    return 0;
+}
+
+static int blend_slice_yuv444p10_pm(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    OverlayContext *s = ctx->priv;
+    ThreadData *td = arg;
+    blend_slice_yuv_16(ctx, td->dst, td->src, 0, 0, s->x, s->y, 0, jobnr, nb_jobs);
+    return 0;
+}
+
+enum BlendMode {
+    BLEND_STRAIGHT,
+    BLEND_PREMULTIPLIED,
+    BLEND_PREMULTIPLIED_UV,
+};
+
+#define DEFINE_BLEND_ROW(depth, pixel, div)                                   \
+static av_always_inline int blend_row_##depth(uint8_t *_d, const uint8_t *_s, \
+                                              const uint8_t *_a, int w,       \
+                                              ptrdiff_t alinesize,            \
+                                              int hsub, int vsub, int mode)   \
+{                                                                             \
+    const int max = (1 << depth) - 1;                                         \
+    const int mid = 1 << (depth - 1);                                         \
+    const pixel *s = (const pixel *)_s;                                       \
+    const pixel *a = (const pixel *)_a;                                       \
+    pixel *d = (pixel *)_d;                                                   \
+    int x;                                                                    \
+                                                                              \
+    alinesize /= sizeof(pixel);                                               \
+    /* the alpha of the last subsampled column is not averaged */             \
+    w -= hsub;                                                                \
+    for (x = 0; x < w; x++) {                                                 \
+        int alpha;                                                            \
+                                                                              \
+        if (hsub && vsub)                                                     \
+            alpha = (a[2 * x]             + a[2 * x + 1] +                    \
+                     a[2 * x + alinesize] + a[2 * x + alinesize + 1]) >> 2;   \
+        else if (hsub)                                                        \
+            alpha = (a[2 * x] + ((a[2 * x] + a[2 * x + 1]) >> 1)) >> 1;       \
+        else                                                                  \
+            alpha = a[x];                                                     \
+                                                                              \
+        if (mode == BLEND_STRAIGHT)                                           \
+            d[x] = div(d[x] * (max - alpha) + s[x] * alpha);                  \
+        else if (mode == BLEND_PREMULTIPLIED)                                 \
+            d[x] = FFMIN(div(d[x] * (max - alpha)) + s[x], max);              \
+        else                                                                  \
+            d[x] = av_clip(div((d[x] - mid) * (max - alpha)) + s[x] - mid,    \
+                           -mid, mid - 1) + mid;                              \
+    }                                                                         \
+    return FFMAX(w, 0);                                                       \
+}
+
+DEFINE_BLEND_ROW(8,  uint8_t,  FAST_DIV255)
+DEFINE_BLEND_ROW(10, uint16_t, FAST_DIV1023)
+
+#define DEFINE_BLEND_ROW_FUNC(name, depth, hsub, vsub, mode)                  \
+static int blend_row_##name##_c(uint8_t *d, uint8_t *da, uint8_t *s,          \
+                                uint8_t *a, int w, ptrdiff_t alinesize)       \
+{                                                                             \
+    return blend_row_##depth(d, s, a, w, alinesize, hsub, vsub, mode);        \
+}
+
+DEFINE_BLEND_ROW_FUNC(44,          8,  0, 0, BLEND_STRAIGHT)
+DEFINE_BLEND_ROW_FUNC(22,          8,  1, 0, BLEND_STRAIGHT)
+DEFINE_BLEND_ROW_FUNC(20,          8,  1, 1, BLEND_STRAIGHT)
+DEFINE_BLEND_ROW_FUNC(44_pm,       8,  0, 0, BLEND_PREMULTIPLIED)
+DEFINE_BLEND_ROW_FUNC(44_pm_uv,    8,  0, 0, BLEND_PREMULTIPLIED_UV)
+DEFINE_BLEND_ROW_FUNC(22_pm_uv,    8,  1, 0, BLEND_PREMULTIPLIED_UV)
+DEFINE_BLEND_ROW_FUNC(20_pm_uv,    8,  1, 1, BLEND_PREMULTIPLIED_UV)
+DEFINE_BLEND_ROW_FUNC(44_10,       10, 0, 0, BLEND_STRAIGHT)
+DEFINE_BLEND_ROW_FUNC(22_10,       10, 1, 0, BLEND_STRAIGHT)
+DEFINE_BLEND_ROW_FUNC(20_10,       10, 1, 1, BLEND_STRAIGHT)
+DEFINE_BLEND_ROW_FUNC(44_pm_10,    10, 0, 0, BLEND_PREMULTIPLIED)
+DEFINE_BLEND_ROW_FUNC(44_pm_uv_10, 10, 0, 0, BLEND_PREMULTIPLIED_UV)
+DEFINE_BLEND_ROW_FUNC(22_pm_uv_10, 10, 1, 0, BLEND_PREMULTIPLIED_UV)
+DEFINE_BLEND_ROW_FUNC(20_pm_uv_10, 10, 1, 1, BLEND_PREMULTIPLIED_UV)
+
+static av_always_inline int blend_row_rgb(uint8_t *d, const uint8_t *s, int w,
+                                          const uint8_t *shuf, int straight)
+{
+    const int sa = shuf[16]; /* alpha of the first pixel */
+    int x, i;
+
+    for (x = 0; x < w; x++) {
+        int alpha = s[sa];
+
+        for (i = 0; i < 3; i++) {
+            if (straight)
+                d[i] = FAST_DIV255(d[i] * (255 - alpha) + s[shuf[i]] * alpha);
+            else if (alpha)
+                d[i] = FFMIN(FAST_DIV255(d[i] * (255 - alpha)) + s[shuf[i]], 255);
+        }
+        d += 3;
+        s += 4;
+    }
+    return w;
+}
+
+static int blend_row_rgb_c(uint8_t *d, const uint8_t *s, int w, const uint8_t *shuf)
+{
+    return blend_row_rgb(d, s, w, shuf, 1);
+}
+
+static int blend_row_rgb_pm_c(uint8_t *d, const uint8_t *s, int w, const uint8_t *shuf)
+{
+    return blend_row_rgb(d, s, w, shuf, 0);
+}
+
+void ff_overlay_init_blend_row(OverlayContext *s, int format, int pix_format,
+                               int alpha_format, int main_has_alpha)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_format);
+    int i, j;
+
+    memset(s->blend_row, 0, sizeof(s->blend_row));
+    s->blend_row_rgb = NULL;
+
+    if (main_has_alpha)
+        return;
+
+    switch (format) {
+    case OVERLAY_FORMAT_YUV420:
+    case OVERLAY_FORMAT_YUV422:
+    case OVERLAY_FORMAT_YUV444:
+        /* semi-planar chroma is blended by the generic code */
+        if (desc->comp[1].step != 1)
+            break;
+        if (!alpha_format) {
+            s->blend_row[0] = blend_row_44_c;
+            s->blend_row[1] =
+            s->blend_row[2] = format == OVERLAY_FORMAT_YUV420 ? blend_row_20_c :
+                              format == OVERLAY_FORMAT_YUV422 ? blend_row_22_c :
+                                                                blend_row_44_c;
+        } else {
+            s->blend_row[0] = blend_row_44_pm_c;
+            s->blend_row[1] =
+            s->blend_row[2] = format == OVERLAY_FORMAT_YUV420 ? blend_row_20_pm_uv_c :
+                              format == OVERLAY_FORMAT_YUV422 ? blend_row_22_pm_uv_c :
+                                                                blend_row_44_pm_uv_c;
+        }
+        break;
+    case OVERLAY_FORMAT_GBRP:
+        s->blend_row[0] =
+        s->blend_row[1] =
+        s->blend_row[2] = alpha_format ? blend_row_44_pm_c : blend_row_44_c;
+        break;
+    case OVERLAY_FORMAT_YUV420P10:
+    case OVERLAY_FORMAT_YUV422P10:
+    case OVERLAY_FORMAT_YUV444P10:
+        if (!alpha_format) {
+            s->blend_row[0] = blend_row_44_10_c;
+            s->blend_row[1] =
+            s->blend_row[2] = format == OVERLAY_FORMAT_YUV420P10 ? blend_row_20_10_c :
+                              format == OVERLAY_FORMAT_YUV422P10 ? blend_row_22_10_c :
+                                                                   blend_row_44_10_c;
+        } else {
+            s->blend_row[0] = blend_row_44_pm_10_c;
+            s->blend_row[1] =
+            s->blend_row[2] = format == OVERLAY_FORMAT_YUV420P10 ? blend_row_20_pm_uv_10_c :
+                              format == OVERLAY_FORMAT_YUV422P10 ? blend_row_22_pm_uv_10_c :
+                                                                   blend_row_44_pm_uv_10_c;
+        }
+        break;
+    case OVERLAY_FORMAT_RGB:
+        /* for each of the 12 bytes of 4 main pixels, the overlay color and
+         * alpha bytes to blend into it */
+        for (i = 0; i < 4; i++) {
+            for (j = 0; j < 3; j++) {
+                int c = s->main_rgba_map[R] == j ? R :
+                        s->main_rgba_map[G] == j ? G : B;
+
+                s->rgb_shuf[     3 * i + j] = 4 * i + s->overlay_rgba_map[c];
+                s->rgb_shuf[16 + 3 * i + j] = 4 * i + s->overlay_rgba_map[A];
+            }
+        }
+        for (i = 12; i < 16; i++)
+            s->rgb_shuf[i] = s->rgb_shuf[16 + i] = 0x80;
+        s->blend_row_rgb = alpha_format ? blend_row_rgb_pm_c : blend_row_rgb_c;
+        break;
+    }
+
+    if (ARCH_X86)
+        ff_overlay_init_x86(s, format, pix_format, alpha_format, main_has_alpha);
+}
+
 static int config_input_main(AVFilterLink *inlink)
 {
     OverlayContext *s = inlink->dst->priv;
@@ -846,6 +1213,15 @@ static int config_input_main(AVFilterLink *inlink)
     case OVERLAY_FORMAT_GBRP:
         s->blend_slice = s->main_has_alpha ? blend_slice_gbrap : blend_slice_gbrp;
         break;
+    case OVERLAY_FORMAT_YUV420P10:
+        s->blend_slice = blend_slice_yuv420p10;
+        break;
+    case OVERLAY_FORMAT_YUV422P10:
+        s->blend_slice = blend_slice_yuv422p10;
+        break;
+    case OVERLAY_FORMAT_YUV444P10:
+        s->blend_slice = blend_slice_yuv444p10;
+        break;
     case OVERLAY_FORMAT_AUTO:
         switch (inlink->format) {
         case AV_PIX_FMT_YUVA420P:
@@ -892,6 +1268,15 @@ static int config_input_main(AVFilterLink *inlink)
     case OVERLAY_FORMAT_GBRP:
         s->blend_slice = s->main_has_alpha ? blend_slice_gbrap_pm : blend_slice_gbrp_pm;
         break;
+    case OVERLAY_FORMAT_YUV420P10:
+        s->blend_slice = blend_slice_yuv420p10_pm;
+        break;
+    case OVERLAY_FORMAT_YUV422P10:
+        s->blend_slice = blend_slice_yuv422p10_pm;
+        break;
+    case OVERLAY_FORMAT_YUV444P10:
+        s->blend_slice = blend_slice_yuv444p10_pm;
+        break;
     case OVERLAY_FORMAT_AUTO:
         switch (inlink->format) {
         case AV_PIX_FMT_YUVA420P:
@@ -920,10 +1305,6 @@ static int config_input_main(AVFilterLink *inlink)
     }
 
 end:
-    if (ARCH_X86)
-        ff_overlay_init_x86(s, s->format, inlink->format,
-                            s->alpha_format, s->main_has_alpha);
-
     return 0;
 }
 
@@ -1010,6 +1391,9 @@ static const AVOption overlay_options[] = {
         { "rgb",    "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_RGB},    .flags = FLAGS, .unit = "format" },
         { "gbrp",   "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_GBRP},   .flags = FLAGS, .unit = "format" },
         { "auto",   "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_AUTO},   .flags = FLAGS, .unit = "format" },
+        { "yuv420p10", "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_YUV420P10}, .flags = FLAGS, .unit = "format" },
+        { "yuv422p10", "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_YUV422P10}, .flags = FLAGS, .unit = "format" },
+        { "yuv444p10", "", 0, AV_OPT_TYPE_CONST, {.i64=OVERLAY_FORMAT_YUV444P10}, .flags = FLAGS, .unit = "format" },
     { "repeatlast", "repeat overlay of the last overlay frame", OFFSET(fs.opt_repeatlast), AV_OPT_TYPE_BOOL, {.i64=1}, 0, 1, FLAGS },
     { "alpha", "alpha format", OFFSET(alpha_format), AV_OPT_TYPE_INT, {.i64=0}, 0, 1, FLAGS, "alpha_format" },
         { "straight",      "", 0, AV_OPT_TYPE_CONST, {.i64=0}, .flags = FLAGS, .unit = "alpha_format" },
@@ -20,6 +20,7 @@
 #define AVFILTER_OVERLAY_H
 
 #include "libavutil/eval.h"
+#include "libavutil/mem.h"
 #include "libavutil/pixdesc.h"
 #include "framesync.h"
 #include "avfilter.h"
@@ -46,6 +47,9 @@ enum OverlayFormat {
     OVERLAY_FORMAT_RGB,
     OVERLAY_FORMAT_GBRP,
     OVERLAY_FORMAT_AUTO,
+    OVERLAY_FORMAT_YUV420P10,
+    OVERLAY_FORMAT_YUV422P10,
+    OVERLAY_FORMAT_YUV444P10,
     OVERLAY_FORMAT_NB
 };
 
@@ -75,11 +79,37 @@ typedef struct OverlayContext {
 
     AVExpr *x_pexpr, *y_pexpr;
 
+    /**
+     * Blend the first pixels of a row of plane i of the overlay into the
+     * main picture and return how many were blended. a is the overlay alpha
+     * of the first pixel and alinesize its stride, used to average the alpha
+     * of subsampled planes. High bit depth rows hold 16-bit samples, w is in
+     * pixels.
+     */
     int (*blend_row[4])(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, int w,
                         ptrdiff_t alinesize);
+
+    /**
+     * Blend the first pixels of a row of a packed RGBA overlay into a
+     * packed RGB main picture without alpha, returning the number of pixels
+     * blended. shuf is rgb_shuf: bytes 0-15 hold the overlay byte of each
+     * of the 12 main bytes of 4 pixels, bytes 16-31 the overlay byte of
+     * their alpha, the last 4 bytes of each half are 0x80.
+     */
+    int (*blend_row_rgb)(uint8_t *d, const uint8_t *s, int w, const uint8_t *shuf);
+    DECLARE_ALIGNED(16, uint8_t, rgb_shuf)[32];
+
     int (*blend_slice)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 } OverlayContext;
 
+/**
+ * Set the row blending functions of s, for the main pix_format blended
+ * with the given OverlayFormat. s->main_rgba_map and s->overlay_rgba_map
+ * must be set for OVERLAY_FORMAT_RGB.
+ */
+void ff_overlay_init_blend_row(OverlayContext *s, int format, int pix_format,
+                               int alpha_format, int main_has_alpha);
+
 void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
                          int alpha_format, int main_has_alpha);
 
@@ -76,6 +76,9 @@ typedef struct PaletteGenContext {
     int nb_boxes;                           // number of boxes (increase will segmenting them)
     int palette_pushed;                     // if the palette frame is pushed into the outlink or not
     uint8_t transparency_color[4];          // background color for transparency
+    struct hist_node *job_histograms;       // histograms of the rows of the histogram jobs but the first
+    int *job_colors;                        // number of new colors (or error) found by each histogram job
+    int nb_jobs;                            // number of histogram jobs, each owning a range of rows
 } PaletteGenContext;
 
 #define OFFSET(x) offsetof(PaletteGenContext, x)
@@ -403,9 +406,9 @@ static inline unsigned color_hash(uint32_t color)
 }
 
 /**
- * Locate the color in the hash table and increment its counter.
+ * Locate the color in the hash table and increase its counter.
  */
-static int color_inc(struct hist_node *hist, uint32_t color)
+static int color_inc(struct hist_node *hist, uint32_t color, uint64_t count)
 {
     int i;
     const unsigned hash = color_hash(color);
@@ -415,7 +418,7 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     for (i = 0; i < node->nb_entries; i++) {
         e = &node->entries[i];
         if (e->color == color) {
-            e->count++;
+            e->count += count;
             return 0;
         }
     }
@@ -425,52 +428,85 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     if (!e)
         return AVERROR(ENOMEM);
     e->color = color;
-    e->count = 1;
+    e->count = count;
     return 1;
 }
 
+typedef struct ThreadData {
+    const AVFrame *cur, *prev;
+} ThreadData;
+
 /**
- * Update histogram when pixels differ from previous frame.
+ * Update a histogram with the colors of the rows owned by this job. The first
+ * job accounts directly into the main histogram, the others into their own
+ * ones, merged afterwards.
+ * If a previous frame is set, only the pixels that differ from it are
+ * accounted.
  */
-static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+static int update_histogram(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const AVFrame *f1 = td->prev ? td->prev : td->cur;
+    const AVFrame *f2 = td->cur;
+    struct hist_node *hist = jobnr ? s->job_histograms + (jobnr - 1) * HIST_SIZE
+                                   : s->histogram;
+    const int slice_start = (f1->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (f1->height * (jobnr+1)) / nb_jobs;
     int x, y, ret, nb_diff_colors = 0;
 
-    for (y = 0; y < f1->height; y++) {
+    for (y = slice_start; y < slice_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
         const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
 
         for (x = 0; x < f1->width; x++) {
-            if (p[x] == q[x])
+            if (td->prev && p[x] == q[x])
                 continue;
-            ret = color_inc(hist, p[x]);
-            if (ret < 0)
+            ret = color_inc(hist, p[x], 1);
+            if (ret < 0) {
+                s->job_colors[jobnr] = ret;
                 return ret;
+            }
             nb_diff_colors += ret;
         }
     }
-    return nb_diff_colors;
+    s->job_colors[jobnr] = nb_diff_colors;
+    return 0;
 }
 
 /**
- * Simple histogram of the frame.
+ * Merge the histograms of the row jobs into the main one, for the hash
+ * buckets owned by this job. The histograms are merged in the order of their
+ * rows, so the entries end up in the same order as a single-threaded pass
+ * would produce.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int merge_histograms(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int x, y, ret, nb_diff_colors = 0;
-
-    for (y = 0; y < f->height; y++) {
-        const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
-
-        for (x = 0; x < f->width; x++) {
-            ret = color_inc(hist, p[x]);
-            if (ret < 0)
-                return ret;
-            nb_diff_colors += ret;
+    PaletteGenContext *s = ctx->priv;
+    const unsigned hash_start = (HIST_SIZE *  jobnr   ) / nb_jobs;
+    const unsigned hash_end   = (HIST_SIZE * (jobnr+1)) / nb_jobs;
+    unsigned hash;
+    int i, j, ret, nb_new_colors = 0;
+
+    for (hash = hash_start; hash < hash_end; hash++) {
+        for (i = 1; i < s->nb_jobs; i++) {
+            struct hist_node *node = &s->job_histograms[(i - 1) * HIST_SIZE + hash];
+
+            for (j = 0; j < node->nb_entries; j++) {
+                ret = color_inc(s->histogram, node->entries[j].color,
+                                node->entries[j].count);
+                if (ret < 0) {
+                    s->job_colors[jobnr] = ret;
+                    return ret;
+                }
+                nb_new_colors += ret;
+            }
+            av_freep(&node->entries);
+            node->nb_entries = 0;
         }
     }
-    return nb_diff_colors;
+    s->job_colors[jobnr] = nb_new_colors;
+    return 0;
 }
 
 /**
@@ -480,18 +516,36 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    int ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                            : update_histogram_frame(s->histogram, in);
-
-    if (ret > 0)
-        s->nb_refs += ret;
+    ThreadData td = { .cur = in, .prev = s->prev_frame };
+    int i, ret = 0;
+
+    ctx->internal->execute(ctx, update_histogram, &td, NULL, s->nb_jobs);
+    /* the colors found by the other jobs are only counted once merged */
+    for (i = 0; i < s->nb_jobs; i++) {
+        if (s->job_colors[i] < 0) {
+            ret = s->job_colors[i];
+            break;
+        }
+    }
+    if (!ret) {
+        s->nb_refs += s->job_colors[0];
+        if (s->nb_jobs > 1) {
+            ctx->internal->execute(ctx, merge_histograms, NULL, NULL, s->nb_jobs);
+            for (i = 0; i < s->nb_jobs; i++) {
+                if (s->job_colors[i] < 0) {
+                    ret = s->job_colors[i];
+                    break;
+                }
+                s->nb_refs += s->job_colors[i];
+            }
+        }
+    }
 
     if (s->stats_mode == STATS_MODE_DIFF_FRAMES) {
         av_frame_free(&s->prev_frame);
         s->prev_frame = in;
     } else if (s->stats_mode == STATS_MODE_SINGLE_FRAMES) {
         AVFrame *out;
-        int i;
 
         out = get_palette_frame(ctx);
         out->pts = in->pts;
@@ -530,11 +584,38 @@ static int request_frame(AVFilterLink *outlink)
     return r;
 }
 
+static void free_job_histograms(PaletteGenContext *s)
+{
+    int i;
+
+    if (s->job_histograms) {
+        for (i = 0; i < (s->nb_jobs - 1) * HIST_SIZE; i++)
+            av_freep(&s->job_histograms[i].entries);
+        av_freep(&s->job_histograms);
+    }
+}
+
 /**
  * The output is one simple 16x16 squared-pixels palette.
  */
 static int config_output(AVFilterLink *outlink)
 {
+    AVFilterContext *ctx = outlink->src;
+    PaletteGenContext *s = ctx->priv;
+
+    free_job_histograms(s);
+    s->nb_jobs = FFMAX(FFMIN(ff_filter_get_nb_threads(ctx), ctx->inputs[0]->h), 1);
+    av_freep(&s->job_colors);
+    s->job_colors = av_calloc(s->nb_jobs, sizeof(*s->job_colors));
+    if (!s->job_colors)
+        return AVERROR(ENOMEM);
+    if (s->nb_jobs > 1) {
+        s->job_histograms = av_calloc((s->nb_jobs - 1) * HIST_SIZE,
+                                      sizeof(*s->job_histograms));
+        if (!s->job_histograms)
+            return AVERROR(ENOMEM);
+    }
+
     outlink->w = outlink->h = 16;
     outlink->sample_aspect_ratio = av_make_q(1, 1);
     return 0;
@@ -548,6 +629,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < HIST_SIZE; i++)
         av_freep(&s->histogram[i].entries);
     av_freep(&s->refs);
+    free_job_histograms(s);
+    av_freep(&s->job_colors);
     av_frame_free(&s->prev_frame);
 }
 
@@ -579,4 +662,5 @@ AVFilter ff_vf_palettegen = {
     .inputs        = palettegen_inputs,
     .outputs       = palettegen_outputs,
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -75,15 +75,27 @@ struct cache_node {
     int nb_entries;
 };
 
+#define THREAD_CACHE_NBITS 4
+#define THREAD_CACHE_SIZE (1<<(3*THREAD_CACHE_NBITS))
+
+/* colors looked up by a slice job, merged into the main cache afterwards */
+typedef struct ThreadCache {
+    struct cache_node cache[THREAD_CACHE_SIZE];
+    int ret;
+} ThreadCache;
+
 struct PaletteUseContext;
 
-typedef int (*set_frame_func)(struct PaletteUseContext *s, AVFrame *out, AVFrame *in,
+typedef int (*set_frame_func)(struct PaletteUseContext *s, ThreadCache *tc,
+                              AVFrame *out, AVFrame *in,
                               int x_start, int y_start, int width, int height);
 
 typedef struct PaletteUseContext {
     const AVClass *class;
     FFFrameSync fs;
     struct cache_node cache[CACHE_SIZE];    /* lookup cache */
+    ThreadCache *thread_caches;             /* per job caches, for the dithering modes without error diffusion */
+    int nb_thread_caches;
     struct color_node map[AVPALETTE_COUNT]; /* 3D-Tree (KD-Tree with K=3) for reverse colormap */
     uint32_t palette[AVPALETTE_COUNT];
     int transparency_index; /* index in the palette of transparency. -1 if there is no transparency in the palette. */
@@ -332,23 +344,37 @@ end:
     search == COLOR_SEARCH_NNS_RECURSIVE ? colormap_nearest_recursive(root, target, trans_thresh) :      \
                                            colormap_nearest_bruteforce(palette, target, trans_thresh)
 
+static av_always_inline unsigned cache_hash(uint8_t r, uint8_t g, uint8_t b, int nbits)
+{
+    const unsigned mask = (1 << nbits) - 1;
+    return (r & mask) << (nbits * 2) | (g & mask) << nbits | (b & mask);
+}
+
+static av_always_inline struct cached_color *cache_find(const struct cache_node *node,
+                                                        uint32_t color)
+{
+    int i;
+
+    for (i = 0; i < node->nb_entries; i++)
+        if (node->entries[i].color == color)
+            return &node->entries[i];
+    return NULL;
+}
+
 /**
  * Check if the requested color is in the cache already. If not, find it in the
  * color tree and cache it.
+ * Slice jobs only read the main cache, and cache the colors they look up in
+ * their own thread cache tc instead.
  * Note: a, r, g, and b are the components of color, but are passed as well to avoid
  * recomputing them (they are generally computed by the caller for other uses).
  */
-static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
+static av_always_inline int color_get(PaletteUseContext *s, ThreadCache *tc, uint32_t color,
                                       uint8_t a, uint8_t r, uint8_t g, uint8_t b,
                                       const enum color_search_method search_method)
 {
-    int i;
     const uint8_t argb_elts[] = {a, r, g, b};
-    const uint8_t rhash = r & ((1<<NBITS)-1);
-    const uint8_t ghash = g & ((1<<NBITS)-1);
-    const uint8_t bhash = b & ((1<<NBITS)-1);
-    const unsigned hash = rhash<<(NBITS*2) | ghash<<NBITS | bhash;
-    struct cache_node *node = &s->cache[hash];
+    struct cache_node *node = &s->cache[cache_hash(r, g, b, NBITS)];
     struct cached_color *e;
 
     // first, check for transparency
@@ -356,9 +382,12 @@ static av_always_inline int color_get(PaletteUseContext *s, uint32_t color,
         return s->transparency_index;
     }
 
-    for (i = 0; i < node->nb_entries; i++) {
-        e = &node->entries[i];
-        if (e->color == color)
+    if ((e = cache_find(node, color)))
+        return e->pal_entry;
+
+    if (tc) {
+        node = &tc->cache[cache_hash(r, g, b, THREAD_CACHE_NBITS)];
+        if ((e = cache_find(node, color)))
             return e->pal_entry;
     }
 
@@ -381,7 +410,7 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     const uint8_t g = c >>  8 & 0xff;
     const uint8_t b = c       & 0xff;
     uint32_t dstc;
-    const int dstx = color_get(s, c, a, r, g, b, search_method);
+    const int dstx = color_get(s, NULL, c, a, r, g, b, search_method);
     if (dstx < 0)
         return dstx;
     dstc = s->palette[dstx];
@@ -391,7 +420,8 @@ static av_always_inline int get_dst_color_err(PaletteUseContext *s,
     return dstx;
 }
 
-static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFrame *in,
+static av_always_inline int set_frame(PaletteUseContext *s, ThreadCache *tc,
+                                      AVFrame *out, AVFrame *in,
                                       int x_start, int y_start, int w, int h,
                                       enum dithering_mode dither,
                                       const enum color_search_method search_method)
@@ -418,7 +448,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = av_clip_uint8(r8 + d);
                 const uint8_t g = av_clip_uint8(g8 + d);
                 const uint8_t b = av_clip_uint8(b8 + d);
-                const int color = color_get(s, src[x], a8, r, g, b, search_method);
+                const int color = color_get(s, tc, src[x], a8, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -486,7 +516,7 @@ static av_always_inline int set_frame(PaletteUseContext *s, AVFrame *out, AVFram
                 const uint8_t r = src[x] >> 16 & 0xff;
                 const uint8_t g = src[x] >>  8 & 0xff;
                 const uint8_t b = src[x]       & 0xff;
-                const int color = color_get(s, src[x], a, r, g, b, search_method);
+                const int color = color_get(s, tc, src[x], a, r, g, b, search_method);
 
                 if (color < 0)
                     return color;
@@ -894,9 +924,66 @@ static void set_processing_window(enum diff_mode diff_mode,
     *hp = height;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int x, y, w, h;
+} ThreadData;
+
+static int set_frame_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PaletteUseContext *s = ctx->priv;
+    ThreadData *td = arg;
+    ThreadCache *tc = &s->thread_caches[jobnr];
+    const int slice_start = (td->h *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr + 1)) / nb_jobs;
+
+    tc->ret = s->set_frame(s, tc, td->out, td->in, td->x, td->y + slice_start,
+                           td->w, slice_end - slice_start);
+    return tc->ret;
+}
+
+/**
+ * Move the colors looked up by the slice jobs into the main cache.
+ */
+static int merge_thread_caches(PaletteUseContext *s, int nb_jobs)
+{
+    int i, j, k, ret = 0;
+
+    for (j = 0; j < nb_jobs; j++) {
+        ThreadCache *tc = &s->thread_caches[j];
+
+        if (tc->ret < 0)
+            ret = tc->ret;
+        for (i = 0; i < THREAD_CACHE_SIZE; i++) {
+            struct cache_node *tnode = &tc->cache[i];
+
+            for (k = 0; k < tnode->nb_entries && ret >= 0; k++) {
+                const struct cached_color *te = &tnode->entries[k];
+                struct cache_node *node = &s->cache[cache_hash(te->color >> 16 & 0xff,
+                                                               te->color >>  8 & 0xff,
+                                                               te->color       & 0xff, NBITS)];
+                struct cached_color *e;
+
+                /* several jobs may have looked up the same color */
+                if (cache_find(node, te->color))
+                    continue;
+                e = av_dynarray2_add((void**)&node->entries, &node->nb_entries,
+                                     sizeof(*node->entries), NULL);
+                if (!e)
+                    ret = AVERROR(ENOMEM);
+                else
+                    *e = *te;
+            }
+            av_freep(&tnode->entries);
+            tnode->nb_entries = 0;
+        }
+    }
+    return ret;
+}
+
 static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
 {
-    int x, y, w, h, ret;
+    int x, y, w, h, ret, nb_jobs;
     AVFilterContext *ctx = inlink->dst;
     PaletteUseContext *s = ctx->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
@@ -925,7 +1012,15 @@ static int apply_palette(AVFilterLink *inlink, AVFrame *in, AVFrame **outf)
     ff_dlog(ctx, "%dx%d rect: (%d;%d) -> (%d,%d) [area:%dx%d]\n",
             w, h, x, y, x+w, y+h, in->width, in->height);
 
-    ret = s->set_frame(s, out, in, x, y, w, h);
+    nb_jobs = FFMIN(h, s->nb_thread_caches);
+    if (nb_jobs > 1) {
+        ThreadData td = { .in = in, .out = out, .x = x, .y = y, .w = w, .h = h };
+
+        ctx->internal->execute(ctx, set_frame_slice, &td, NULL, nb_jobs);
+        ret = merge_thread_caches(s, nb_jobs);
+    } else {
+        ret = s->set_frame(s, NULL, out, in, x, y, w, h);
+    }
     if (ret < 0) {
         av_frame_free(&out);
         *outf = NULL;
@@ -958,6 +1053,16 @@ static int config_output(AVFilterLink *outlink)
     outlink->time_base = ctx->inputs[0]->time_base;
     if ((ret = ff_framesync_configure(&s->fs)) < 0)
         return ret;
+
+    /* error diffusion needs the rows to be processed in order, and bayer
+     * caches the dithered lookup of the first pixel of each source color */
+    if (s->dither == DITHERING_NONE &&
+        ff_filter_get_nb_threads(ctx) > 1 && !s->thread_caches) {
+        s->thread_caches = av_calloc(ff_filter_get_nb_threads(ctx), sizeof(*s->thread_caches));
+        if (!s->thread_caches)
+            return AVERROR(ENOMEM);
+        s->nb_thread_caches = ff_filter_get_nb_threads(ctx);
+    }
     return 0;
 }
 
@@ -1039,11 +1144,12 @@ error:
     return ret;
 }
 
-#define DEFINE_SET_FRAME(color_search, name, value)                             \
-static int set_frame_##name(PaletteUseContext *s, AVFrame *out, AVFrame *in,    \
-                            int x_start, int y_start, int w, int h)             \
-{                                                                               \
-    return set_frame(s, out, in, x_start, y_start, w, h, value, color_search);  \
+#define DEFINE_SET_FRAME(color_search, name, value)                                 \
+static int set_frame_##name(PaletteUseContext *s, ThreadCache *tc,                  \
+                            AVFrame *out, AVFrame *in,                              \
+                            int x_start, int y_start, int w, int h)                 \
+{                                                                                   \
+    return set_frame(s, tc, out, in, x_start, y_start, w, h, value, color_search);  \
 }
 
 #define DEFINE_SET_FRAME_COLOR_SEARCH(color_search, color_search_macro)                                 \
@@ -1120,6 +1226,13 @@ static av_cold void uninit(AVFilterContext *ctx)
     ff_framesync_uninit(&s->fs);
     for (i = 0; i < CACHE_SIZE; i++)
         av_freep(&s->cache[i].entries);
+    for (i = 0; i < s->nb_thread_caches; i++) {
+        int j;
+
+        for (j = 0; j < THREAD_CACHE_SIZE; j++)
+            av_freep(&s->thread_caches[i].cache[j].entries);
+    }
+    av_freep(&s->thread_caches);
     av_frame_free(&s->last_in);
     av_frame_free(&s->last_out);
 }
@@ -1156,4 +1269,5 @@ AVFilter ff_vf_paletteuse = {
     .inputs        = paletteuse_inputs,
     .outputs       = paletteuse_outputs,
     .priv_class    = &paletteuse_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -313,6 +313,10 @@ static int config_props(AVFilterLink *outlink)
                         return ret;
                 }
             }
+            /* only thread the scaling on request, the conversions inserted
+             * by the format negotiation stay single threaded */
+            if (ctx->nb_threads > 0)
+                av_opt_set_int(*s, "threads", ff_filter_get_nb_threads(ctx), 0);
             /* Override YUV420P default settings to have the correct (MPEG-2) chroma positions
              * MPEG-2 chroma positions are used by convention
              * XXX: support other 4:2:0 pixel formats */
@@ -29,6 +29,13 @@
 #include "framesync.h"
 #include "video.h"
 
+/* maximum number of output frames the inputs are rendered into at once */
+#define MAX_CANVASES 4
+
+/* alignment the views must keep for the upstream SIMD, which may write up
+ * to the next multiple of it past the visible width of a line */
+#define VIEW_ALIGN 64
+
 typedef struct StackItem {
     int x[4], y[4];
     int linesize[4];
@@ -46,8 +53,17 @@ typedef struct StackContext {
     int nb_planes;
 
     StackItem *items;
+    int row_size[4];        ///< visible width of the output lines in bytes
     AVFrame **frames;
     FFFrameSync fs;
+
+    /* inputs are given views into the next output frames, so that the
+     * upstream filters render straight into the output */
+    int direct;
+    AVFrame *canvases[MAX_CANVASES];
+    int nb_canvases;
+    int64_t canvas_base;    ///< index of canvases[0] in the sequence of canvases
+    int64_t *nb_views;      ///< number of views given to each input
 } StackContext;
 
 static int query_formats(AVFilterContext *ctx)
@@ -67,6 +83,81 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, pix_fmts);
 }
 
+static void drop_canvas(StackContext *s)
+{
+    av_frame_free(&s->canvases[0]);
+    memmove(s->canvases, s->canvases + 1, --s->nb_canvases * sizeof(*s->canvases));
+    s->canvas_base++;
+}
+
+/* check that the lines of the canvas leave room for the overwrite of the
+ * rightmost views */
+static int canvas_padded(StackContext *s, AVFrame *canvas)
+{
+    int p;
+
+    for (p = 0; p < s->nb_planes; p++)
+        if (canvas->linesize[p] < FFALIGN(s->row_size[p], VIEW_ALIGN))
+            return 0;
+    return 1;
+}
+
+static AVFrame *get_video_buffer(AVFilterLink *inlink, int w, int h)
+{
+    AVFilterContext *ctx = inlink->dst;
+    AVFilterLink *outlink = ctx->outputs[0];
+    StackContext *s = ctx->priv;
+    int i = FF_INLINK_IDX(inlink);
+    StackItem *item = &s->items[i];
+    AVFrame *frame;
+    int64_t idx;
+    int p;
+
+    if (!s->direct || w != inlink->w || h != inlink->h)
+        return ff_default_get_video_buffer(inlink, w, h);
+
+    /* an input lagging behind the oldest canvas continues from it */
+    idx = FFMAX(s->nb_views[i], s->canvas_base) - s->canvas_base;
+    if (idx == s->nb_canvases) {
+        AVFrame *canvas;
+
+        if (s->nb_canvases == MAX_CANVASES) {
+            drop_canvas(s);
+            idx--;
+        }
+        canvas = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!canvas)
+            return NULL;
+        if (!canvas_padded(s, canvas)) {
+            av_frame_free(&canvas);
+            s->direct = 0;
+            return ff_default_get_video_buffer(inlink, w, h);
+        }
+        s->canvases[s->nb_canvases++] = canvas;
+    }
+
+    frame = av_frame_clone(s->canvases[idx]);
+    if (!frame)
+        return NULL;
+    frame->width  = w;
+    frame->height = h;
+    for (p = 0; p < s->nb_planes; p++)
+        frame->data[p] += item->x[p] + item->y[p] * frame->linesize[p];
+    s->nb_views[i] = s->canvas_base + idx + 1;
+
+    /* release the canvases all the inputs have their view of */
+    while (s->nb_canvases) {
+        for (i = 0; i < s->nb_inputs; i++)
+            if (s->nb_views[i] <= s->canvas_base)
+                break;
+        if (i < s->nb_inputs)
+            break;
+        drop_canvas(s);
+    }
+
+    return frame;
+}
+
 static av_cold int init(AVFilterContext *ctx)
 {
     StackContext *s = ctx->priv;
@@ -82,16 +173,19 @@ static av_cold int init(AVFilterContext *ctx)
     if (!s->frames)
         return AVERROR(ENOMEM);
 
-    if (!strcmp(ctx->filter->name, "xstack")) {
-        s->items = av_calloc(s->nb_inputs, sizeof(*s->items));
-        if (!s->items)
-            return AVERROR(ENOMEM);
-    }
+    s->items = av_calloc(s->nb_inputs, sizeof(*s->items));
+    if (!s->items)
+        return AVERROR(ENOMEM);
+
+    s->nb_views = av_calloc(s->nb_inputs, sizeof(*s->nb_views));
+    if (!s->nb_views)
+        return AVERROR(ENOMEM);
 
     for (i = 0; i < s->nb_inputs; i++) {
         AVFilterPad pad = { 0 };
 
         pad.type = AVMEDIA_TYPE_VIDEO;
+        pad.get_video_buffer = get_video_buffer;
         pad.name = av_asprintf("input%d", i);
         if (!pad.name)
             return AVERROR(ENOMEM);
@@ -105,57 +199,83 @@ static av_cold int init(AVFilterContext *ctx)
     return 0;
 }
 
+/* return a frame referencing the output all the inputs were rendered into,
+ * or NULL if they are not views of the same output */
+static AVFrame *get_canvas(AVFilterLink *outlink, StackContext *s, AVFrame **in)
+{
+    AVFrame *out;
+    uint8_t *data[4] = { NULL };
+    int i, p;
+
+    for (p = 0; p < s->nb_planes; p++) {
+        AVBufferRef *buf = av_frame_get_plane_buffer(in[0], p);
+        ptrdiff_t linesize = in[0]->linesize[p];
+        int rows = p == 1 || p == 2 ? AV_CEIL_RSHIFT(outlink->h, s->desc->log2_chroma_h) :
+                                      outlink->h;
+
+        if (!buf || linesize <= 0)
+            return NULL;
+        data[p] = in[0]->data[p] - s->items[0].x[p] - s->items[0].y[p] * linesize;
+        if (data[p] < buf->data ||
+            data[p] + rows * linesize > buf->data + buf->size)
+            return NULL;
+
+        for (i = 1; i < s->nb_inputs; i++) {
+            AVBufferRef *buf1 = av_frame_get_plane_buffer(in[i], p);
+            StackItem *item = &s->items[i];
+
+            if (!buf1 || buf1->buffer != buf->buffer ||
+                in[i]->linesize[p] != linesize ||
+                in[i]->data[p] != data[p] + item->x[p] + item->y[p] * linesize)
+                return NULL;
+        }
+    }
+
+    out = av_frame_alloc();
+    if (!out)
+        return NULL;
+    for (i = 0; i < FF_ARRAY_ELEMS(in[0]->buf) && in[0]->buf[i]; i++) {
+        out->buf[i] = av_buffer_ref(in[0]->buf[i]);
+        if (!out->buf[i]) {
+            av_frame_free(&out);
+            return NULL;
+        }
+    }
+    for (p = 0; p < s->nb_planes; p++) {
+        out->data[p]     = data[p];
+        out->linesize[p] = in[0]->linesize[p];
+    }
+    out->format = outlink->format;
+    out->width  = outlink->w;
+    out->height = outlink->h;
+
+    return out;
+}
+
 static int process_frame(FFFrameSync *fs)
 {
     AVFilterContext *ctx = fs->parent;
     AVFilterLink *outlink = ctx->outputs[0];
     StackContext *s = fs->opaque;
     AVFrame **in = s->frames;
-    AVFrame *out;
-    int i, p, ret, offset[4] = { 0 };
+    AVFrame *out = NULL;
+    int i, p, ret;
 
     for (i = 0; i < s->nb_inputs; i++) {
         if ((ret = ff_framesync_get_frame(&s->fs, i, &in[i], 0)) < 0)
             return ret;
     }
 
-    out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-    if (!out)
-        return AVERROR(ENOMEM);
-    out->pts = av_rescale_q(s->fs.pts, s->fs.time_base, outlink->time_base);
-    out->sample_aspect_ratio = outlink->sample_aspect_ratio;
-
-    for (i = 0; i < s->nb_inputs; i++) {
-        AVFilterLink *inlink = ctx->inputs[i];
-        int linesize[4];
-        int height[4];
-
-        if (s->is_horizontal || s->is_vertical) {
-            if ((ret = av_image_fill_linesizes(linesize, inlink->format, inlink->w)) < 0) {
-                av_frame_free(&out);
-                return ret;
-            }
+    if (s->direct)
+        out = get_canvas(outlink, s, in);
 
-            height[1] = height[2] = AV_CEIL_RSHIFT(inlink->h, s->desc->log2_chroma_h);
-            height[0] = height[3] = inlink->h;
-        }
+    if (!out) {
+        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!out)
+            return AVERROR(ENOMEM);
 
-        for (p = 0; p < s->nb_planes; p++) {
-            if (s->is_vertical) {
-                av_image_copy_plane(out->data[p] + offset[p] * out->linesize[p],
-                                    out->linesize[p],
-                                    in[i]->data[p],
-                                    in[i]->linesize[p],
-                                    linesize[p], height[p]);
-                offset[p] += height[p];
-            } else if (s->is_horizontal) {
-                av_image_copy_plane(out->data[p] + offset[p],
-                                    out->linesize[p],
-                                    in[i]->data[p],
-                                    in[i]->linesize[p],
-                                    linesize[p], height[p]);
-                offset[p] += linesize[p];
-            } else {
+        for (i = 0; i < s->nb_inputs; i++) {
+            for (p = 0; p < s->nb_planes; p++) {
                 StackItem *item = &s->items[i];
 
                 av_image_copy_plane(out->data[p] + out->linesize[p] * item->y[p] + item->x[p],
@@ -166,6 +286,8 @@ static int process_frame(FFFrameSync *fs)
             }
         }
     }
+    out->pts = av_rescale_q(s->fs.pts, s->fs.time_base, outlink->time_base);
+    out->sample_aspect_ratio = outlink->sample_aspect_ratio;
 
     return ff_filter_frame(outlink, out);
 }
@@ -180,11 +302,12 @@ static int config_output(AVFilterLink *outlink)
     int height = ctx->inputs[0]->h;
     int width = ctx->inputs[0]->w;
     FFFrameSyncIn *in;
-    int i, ret;
+    int i, j, ret;
 
     s->desc = av_pix_fmt_desc_get(outlink->format);
     if (!s->desc)
         return AVERROR_BUG;
+    s->direct = 1;
 
     if (s->is_vertical) {
         for (i = 1; i < s->nb_inputs; i++) {
@@ -202,6 +325,37 @@ static int config_output(AVFilterLink *outlink)
             }
             width += ctx->inputs[i]->w;
         }
+    }
+
+    if (s->is_horizontal || s->is_vertical) {
+        int offset[4] = { 0 }, pos = 0, p;
+
+        for (i = 0; i < s->nb_inputs; i++) {
+            AVFilterLink *inlink = ctx->inputs[i];
+            StackItem *item = &s->items[i];
+
+            if ((ret = av_image_fill_linesizes(item->linesize, inlink->format, inlink->w)) < 0)
+                return ret;
+
+            item->height[1] = item->height[2] = AV_CEIL_RSHIFT(inlink->h, s->desc->log2_chroma_h);
+            item->height[0] = item->height[3] = inlink->h;
+
+            for (p = 0; p < 4; p++) {
+                if (s->is_vertical) {
+                    item->y[p] = offset[p];
+                    offset[p] += item->height[p];
+                } else {
+                    item->x[p] = offset[p];
+                    offset[p] += item->linesize[p];
+                }
+            }
+
+            /* the views must start on a chroma sample */
+            if (pos & ((1 << (s->is_vertical ? s->desc->log2_chroma_h :
+                                               s->desc->log2_chroma_w)) - 1))
+                s->direct = 0;
+            pos += s->is_vertical ? inlink->h : inlink->w;
+        }
     } else {
         char *arg, *p = s->layout, *saveptr = NULL;
         char *arg2, *p2, *saveptr2 = NULL;
@@ -272,13 +426,43 @@ static int config_output(AVFilterLink *outlink)
             item->y[1] = item->y[2] = AV_CEIL_RSHIFT(inh, s->desc->log2_chroma_h);
             item->y[0] = item->y[3] = inh;
 
+            if (inw & ((1 << s->desc->log2_chroma_w) - 1) ||
+                inh & ((1 << s->desc->log2_chroma_h) - 1))
+                s->direct = 0;
+
             width  = FFMAX(width,  inlink->w + inw);
             height = FFMAX(height, inlink->h + inh);
         }
+
+        /* overlapping inputs cannot share the output */
+        for (i = 0; i < s->nb_inputs; i++) {
+            for (j = i + 1; j < s->nb_inputs; j++) {
+                StackItem *a = &s->items[i], *b = &s->items[j];
+
+                if (a->x[0] < b->x[0] + b->linesize[0] && b->x[0] < a->x[0] + a->linesize[0] &&
+                    a->y[0] < b->y[0] + b->height[0] && b->y[0] < a->y[0] + a->height[0])
+                    s->direct = 0;
+            }
+        }
     }
 
     s->nb_planes = av_pix_fmt_count_planes(outlink->format);
 
+    /* the inputs may only overwrite the right of their views where the
+     * output has padding */
+    if ((ret = av_image_fill_linesizes(s->row_size, outlink->format, width)) < 0)
+        return ret;
+    for (i = 0; i < s->nb_inputs; i++) {
+        StackItem *item = &s->items[i];
+        int p;
+
+        for (p = 0; p < s->nb_planes; p++)
+            if (item->x[p] % VIEW_ALIGN ||
+                (item->linesize[p] % VIEW_ALIGN &&
+                 item->x[p] + item->linesize[p] != s->row_size[p]))
+                s->direct = 0;
+    }
+
     outlink->w          = width;
     outlink->h          = height;
     outlink->time_base  = time_base;
@@ -312,6 +496,10 @@ static av_cold void uninit(AVFilterContext *ctx)
     ff_framesync_uninit(&s->fs);
     av_freep(&s->frames);
     av_freep(&s->items);
+    av_freep(&s->nb_views);
+
+    while (s->nb_canvases)
+        drop_canvas(s);
 
     for (i = 0; i < ctx->nb_inputs; i++)
         av_freep(&ctx->input_pads[i].name);
@@ -32,6 +32,13 @@
 #include "video.h"
 #include "internal.h"
 
+/* number of recent output frames the input views are recognized in */
+#define MAX_CANVASES 4
+
+/* alignment the views must keep for the upstream SIMD, which may write up
+ * to the next multiple of it past the visible width of a line */
+#define VIEW_ALIGN 64
+
 typedef struct TileContext {
     const AVClass *class;
     unsigned w, h;
@@ -46,6 +53,14 @@ typedef struct TileContext {
     AVFrame *out_ref;
     AVFrame *prev_out_ref;
     uint8_t rgba_color[4];
+
+    /* the input frames are views into the next output frames, so that the
+     * upstream filters render straight into the output */
+    int direct;
+    AVFrame *canvas;        ///< output frame the next views are taken from
+    unsigned nb_views;      ///< number of views taken from canvas
+    uint8_t *canvas_data[MAX_CANVASES]; ///< data of the recent canvases
+    unsigned canvas_idx;
 } TileContext;
 
 #define OFFSET(x) offsetof(TileContext, x)
@@ -116,6 +131,24 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats(ctx, ff_draw_supported_pixel_formats(0));
 }
 
+/* check that the upstream SIMD can write the views without overwriting the
+ * neighbouring tiles or the borders */
+static int views_aligned(TileContext *tile, int inw)
+{
+    int plane;
+
+    for (plane = 0; plane < tile->draw.nb_planes; plane++) {
+        int hsub = tile->draw.hsub[plane], step = tile->draw.pixelstep[plane];
+        int w    = (inw >> hsub) * step;
+
+        if (((tile->margin >> hsub) * step) % VIEW_ALIGN ||
+            (((inw + tile->padding) >> hsub) * step) % VIEW_ALIGN ||
+            (w % VIEW_ALIGN && (tile->w > 1 || tile->margin)))
+            return 0;
+    }
+    return 1;
+}
+
 static int config_props(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -142,6 +175,12 @@ static int config_props(AVFilterLink *outlink)
     ff_draw_init(&tile->draw, inlink->format, 0);
     ff_draw_color(&tile->draw, &tile->blank, tile->rgba_color);
 
+    /* the views must start on a chroma sample */
+    tile->direct = !tile->overlap && !tile->init_padding &&
+                   !((tile->margin | (inlink->w + tile->padding)) & ((1 << tile->draw.hsub_max) - 1)) &&
+                   !((tile->margin | (inlink->h + tile->padding)) & ((1 << tile->draw.vsub_max) - 1)) &&
+                   views_aligned(tile, inlink->w);
+
     return 0;
 }
 
@@ -156,6 +195,134 @@ static void get_tile_pos(AVFilterContext *ctx, unsigned *x, unsigned *y, unsigne
     *y = tile->margin + (inlink->h + tile->padding) * ty;
 }
 
+static ptrdiff_t tile_offset(TileContext *tile, int plane, ptrdiff_t linesize,
+                             unsigned x, unsigned y)
+{
+    return (x >> tile->draw.hsub[plane]) * tile->draw.pixelstep[plane] +
+           (y >> tile->draw.vsub[plane]) * linesize;
+}
+
+static AVFrame *get_video_buffer(AVFilterLink *inlink, int w, int h)
+{
+    AVFilterContext *ctx  = inlink->dst;
+    TileContext *tile     = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    AVFrame *frame;
+    unsigned x, y;
+    int plane;
+
+    if (!tile->direct || w != inlink->w || h != inlink->h)
+        return ff_default_get_video_buffer(inlink, w, h);
+
+    if (!tile->canvas) {
+        tile->canvas = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!tile->canvas)
+            return NULL;
+        for (plane = 0; plane < tile->draw.nb_planes; plane++) {
+            int row_size = AV_CEIL_RSHIFT(outlink->w, tile->draw.hsub[plane]) *
+                           tile->draw.pixelstep[plane];
+
+            /* the rightmost views write into the padding of the lines */
+            if (tile->canvas->linesize[plane] < FFALIGN(row_size, VIEW_ALIGN)) {
+                av_frame_free(&tile->canvas);
+                tile->direct = 0;
+                return ff_default_get_video_buffer(inlink, w, h);
+            }
+        }
+        if (tile->margin || tile->padding)
+            ff_fill_rectangle(&tile->draw, &tile->blank,
+                              tile->canvas->data, tile->canvas->linesize,
+                              0, 0, outlink->w, outlink->h);
+        tile->canvas_data[tile->canvas_idx++ % MAX_CANVASES] = tile->canvas->data[0];
+        tile->nb_views = 0;
+    }
+
+    frame = av_frame_clone(tile->canvas);
+    if (!frame)
+        return NULL;
+    frame->width  = w;
+    frame->height = h;
+
+    get_tile_pos(ctx, &x, &y, tile->nb_views);
+    for (plane = 0; plane < tile->draw.nb_planes; plane++)
+        frame->data[plane] += tile_offset(tile, plane, frame->linesize[plane], x, y);
+
+    if (++tile->nb_views == tile->nb_frames)
+        av_frame_free(&tile->canvas);
+
+    return frame;
+}
+
+/* check whether frame is the view of the current tile of canvas */
+static int is_view(AVFilterContext *ctx, AVFrame *canvas, AVFrame *frame)
+{
+    TileContext *tile = ctx->priv;
+    unsigned x, y;
+    int plane;
+
+    get_tile_pos(ctx, &x, &y, tile->current);
+    for (plane = 0; plane < tile->draw.nb_planes; plane++) {
+        AVBufferRef *buf  = av_frame_get_plane_buffer(canvas, plane);
+        AVBufferRef *buf1 = av_frame_get_plane_buffer(frame,  plane);
+
+        if (!buf || !buf1 || buf->buffer != buf1->buffer ||
+            frame->linesize[plane] != canvas->linesize[plane] ||
+            frame->data[plane] != canvas->data[plane] +
+                                  tile_offset(tile, plane, canvas->linesize[plane], x, y))
+            return 0;
+    }
+    return 1;
+}
+
+/* return a frame referencing the canvas frame is the view of the current
+ * tile of, or NULL if it is no such view */
+static AVFrame *get_canvas(AVFilterContext *ctx, AVFrame *frame)
+{
+    TileContext *tile     = ctx->priv;
+    AVFilterLink *outlink = ctx->outputs[0];
+    uint8_t *data[4] = { NULL };
+    AVFrame *out;
+    unsigned x, y;
+    int i, plane;
+
+    get_tile_pos(ctx, &x, &y, tile->current);
+    for (plane = 0; plane < tile->draw.nb_planes; plane++) {
+        AVBufferRef *buf   = av_frame_get_plane_buffer(frame, plane);
+        ptrdiff_t linesize = frame->linesize[plane];
+
+        if (!buf || linesize <= 0)
+            return NULL;
+        data[plane] = frame->data[plane] - tile_offset(tile, plane, linesize, x, y);
+        if (data[plane] < buf->data ||
+            data[plane] + AV_CEIL_RSHIFT(outlink->h, tile->draw.vsub[plane]) * linesize >
+            buf->data + buf->size)
+            return NULL;
+    }
+    for (i = 0; i < MAX_CANVASES; i++)
+        if (tile->canvas_data[i] == data[0])
+            break;
+    if (i == MAX_CANVASES)
+        return NULL;
+
+    out = av_frame_alloc();
+    if (!out)
+        return NULL;
+    for (i = 0; i < FF_ARRAY_ELEMS(frame->buf) && frame->buf[i]; i++) {
+        out->buf[i] = av_buffer_ref(frame->buf[i]);
+        if (!out->buf[i]) {
+            av_frame_free(&out);
+            return NULL;
+        }
+    }
+    for (plane = 0; plane < tile->draw.nb_planes; plane++) {
+        out->data[plane]     = data[plane];
+        out->linesize[plane] = frame->linesize[plane];
+    }
+    out->format = outlink->format;
+
+    return out;
+}
+
 static void draw_blank_frame(AVFilterContext *ctx, AVFrame *out_buf)
 {
     TileContext *tile    = ctx->priv;
@@ -176,6 +343,13 @@ static int end_last_frame(AVFilterContext *ctx)
     AVFrame *out_buf = tile->out_ref;
     int ret;
 
+    if (tile->current < tile->nb_frames && tile->direct) {
+        /* no more views of this canvas will be filled */
+        if (tile->canvas && tile->canvas->buf[0]->buffer == out_buf->buf[0]->buffer)
+            av_frame_free(&tile->canvas);
+        if ((ret = av_frame_make_writable(out_buf)) < 0)
+            return ret;
+    }
     while (tile->current < tile->nb_frames)
         draw_blank_frame(ctx, out_buf);
     tile->current = tile->overlap;
@@ -188,9 +362,10 @@ static int end_last_frame(AVFilterContext *ctx)
     return ret;
 }
 
-/* Note: direct rendering is not possible since there is no guarantee that
- * buffers are fed to filter_frame in the order they were obtained from
- * get_buffer (think B-frames). */
+/* Note: there is no guarantee that buffers are fed to filter_frame in the
+ * order they were obtained from get_buffer (think B-frames), so the frames
+ * which are not the view of the current tile are copied, into a new output
+ * frame if the canvas is still shared with other views. */
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
 {
@@ -198,8 +373,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
     TileContext *tile     = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
     unsigned x0, y0;
+    int ret;
 
+    if (!tile->out_ref && tile->direct && (tile->out_ref = get_canvas(ctx, picref))) {
+        av_frame_copy_props(tile->out_ref, picref);
+        tile->out_ref->width  = outlink->w;
+        tile->out_ref->height = outlink->h;
+    }
     if (!tile->out_ref) {
+        /* the views got out of step with the tiles, start a new canvas */
+        av_frame_free(&tile->canvas);
+
         tile->out_ref = ff_get_video_buffer(outlink, outlink->w, outlink->h);
         if (!tile->out_ref) {
             av_frame_free(&picref);
@@ -232,11 +416,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
         }
     }
 
-    get_tile_pos(ctx, &x0, &y0, tile->current);
-    ff_copy_rectangle2(&tile->draw,
-                       tile->out_ref->data, tile->out_ref->linesize,
-                       picref->data, picref->linesize,
-                       x0, y0, 0, 0, inlink->w, inlink->h);
+    if (!tile->direct || !is_view(ctx, tile->out_ref, picref)) {
+        if (tile->direct && (ret = av_frame_make_writable(tile->out_ref)) < 0) {
+            av_frame_free(&picref);
+            return ret;
+        }
+        get_tile_pos(ctx, &x0, &y0, tile->current);
+        ff_copy_rectangle2(&tile->draw,
+                           tile->out_ref->data, tile->out_ref->linesize,
+                           picref->data, picref->linesize,
+                           x0, y0, 0, 0, inlink->w, inlink->h);
+    }
 
     av_frame_free(&picref);
     if (++tile->current == tile->nb_frames)
@@ -263,13 +453,15 @@ static av_cold void uninit(AVFilterContext *ctx)
     TileContext *tile = ctx->priv;
 
     av_frame_free(&tile->prev_out_ref);
+    av_frame_free(&tile->canvas);
 }
 
 static const AVFilterPad tile_inputs[] = {
     {
         .name         = "default",
-        .type         = AVMEDIA_TYPE_VIDEO,
-        .filter_frame = filter_frame,
+        .type             = AVMEDIA_TYPE_VIDEO,
+        .get_video_buffer = get_video_buffer,
+        .filter_frame     = filter_frame,
     },
     { NULL }
 };
@@ -47,78 +47,135 @@
 #include "libavutil/pixdesc.h"
 #include "unsharp.h"
 
-static void apply_unsharp(      uint8_t *dst, int dst_stride,
-                          const uint8_t *src, int src_stride,
-                          int width, int height, UnsharpFilterParam *fp)
+typedef struct ThreadData {
+    AVFrame *in, *out;
+} ThreadData;
+
+static void column_sum_c(uint32_t *dst, uint32_t *const *sc, int nb_sc,
+                         const uint8_t *src, int width)
+{
+    uint32_t tmp1, tmp2;
+    int x, z;
+
+    for (x = 0; x < width; x++) {
+        tmp1 = src[x];
+        for (z = 0; z < nb_sc; z += 2) {
+            tmp2 = sc[z + 0][x] + tmp1; sc[z + 0][x] = tmp1;
+            tmp1 = sc[z + 1][x] + tmp2; sc[z + 1][x] = tmp2;
+        }
+        dst[x] = tmp1;
+    }
+}
+
+static void row_sum_c(uint32_t *buf, int width, int nb_sr)
 {
-    uint32_t **sc = fp->sc;
-    uint32_t sr[MAX_MATRIX_SIZE - 1], tmp1, tmp2;
+    int x, z;
 
+    for (z = 0; z < nb_sr; z++)
+        for (x = 0; x < width + nb_sr - 1 - z; x++)
+            buf[x] += buf[x + 1];
+}
+
+static void sharpen_c(uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                      int width, int amount, int scalebits)
+{
+    const uint32_t halfscale = 1 << (scalebits - 1);
     int32_t res;
+    int x;
+
+    for (x = 0; x < width; x++) {
+        res = (int32_t)src[x] + ((((int32_t)src[x] - (int32_t)((sum[x] + halfscale) >> scalebits)) * amount) >> 16);
+        dst[x] = av_clip_uint8(res);
+    }
+}
+
+/**
+ * Filter the rows [slice_start, slice_end) of a plane.
+ *
+ * The matrix is a cascade of 2 * steps_y vertical and 2 * steps_x
+ * horizontal two-tap sums, so its state only depends on the last
+ * 2 * steps_y source rows. Each slice primes its own state machine from the
+ * rows above it and produces exactly the output of a whole-plane pass.
+ */
+static void apply_unsharp(UnsharpContext *s,
+                                uint8_t *dst, int dst_stride,
+                          const uint8_t *src, int src_stride,
+                          int width, int height, int slice_start, int slice_end,
+                          UnsharpFilterParam *fp, uint32_t **sc, uint32_t *line)
+{
     int x, y, z;
-    const uint8_t *src2 = NULL;  //silence a warning
     const int amount = fp->amount;
     const int steps_x = fp->steps_x;
     const int steps_y = fp->steps_y;
     const int scalebits = fp->scalebits;
-    const int32_t halfscale = fp->halfscale;
 
     if (!amount) {
-        av_image_copy_plane(dst, dst_stride, src, src_stride, width, height);
+        av_image_copy_plane(dst + slice_start * dst_stride, dst_stride,
+                            src + slice_start * src_stride, src_stride,
+                            width, slice_end - slice_start);
         return;
     }
 
-    for (y = 0; y < 2 * steps_y; y++)
-        memset(sc[y], 0, sizeof(sc[y][0]) * (width + 2 * steps_x));
-
-    for (y = -steps_y; y < height + steps_y; y++) {
-        if (y < height)
-            src2 = src;
-
-        memset(sr, 0, sizeof(sr[0]) * (2 * steps_x - 1));
-        for (x = -steps_x; x < width + steps_x; x++) {
-            tmp1 = x <= 0 ? src2[0] : x >= width ? src2[width-1] : src2[x];
-            for (z = 0; z < steps_x * 2; z += 2) {
-                tmp2 = sr[z + 0] + tmp1; sr[z + 0] = tmp1;
-                tmp1 = sr[z + 1] + tmp2; sr[z + 1] = tmp2;
-            }
-            for (z = 0; z < steps_y * 2; z += 2) {
-                tmp2 = sc[z + 0][x + steps_x] + tmp1; sc[z + 0][x + steps_x] = tmp1;
-                tmp1 = sc[z + 1][x + steps_x] + tmp2; sc[z + 1][x + steps_x] = tmp2;
-            }
-            if (x >= steps_x && y >= steps_y) {
-                const uint8_t *srx = src - steps_y * src_stride + x - steps_x;
-                uint8_t *dsx       = dst - steps_y * dst_stride + x - steps_x;
-
-                res = (int32_t)*srx + ((((int32_t) * srx - (int32_t)((tmp1 + halfscale) >> scalebits)) * amount) >> 16);
-                *dsx = av_clip_uint8(res);
-            }
-        }
-        if (y >= 0) {
-            dst += dst_stride;
-            src += src_stride;
+    for (z = 0; z < 2 * steps_y; z++)
+        memset(sc[z], 0, sizeof(sc[z][0]) * FFALIGN(width, 8));
+
+    for (y = slice_start - steps_y; y < slice_end + steps_y; y++) {
+        const uint8_t *src2 = src + av_clip(y, 0, height - 1) * src_stride;
+
+        s->column_sum(line + steps_x, sc, 2 * steps_y, src2, width);
+        if (y < slice_start + steps_y)
+            continue;
+
+        for (x = 0; x < steps_x; x++) {
+            line[x]                   = line[steps_x];
+            line[steps_x + width + x] = line[steps_x + width - 1];
         }
+        s->row_sum(line, width, 2 * steps_x);
+        s->sharpen(dst + (y - steps_y) * dst_stride, src + (y - steps_y) * src_stride,
+                   line, width, amount, scalebits);
     }
 }
 
-static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+static int unsharp_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     AVFilterLink *inlink = ctx->inputs[0];
     UnsharpContext *s = ctx->priv;
-    int i, plane_w[3], plane_h[3];
-    UnsharpFilterParam *fp[3];
-    plane_w[0] = inlink->w;
-    plane_w[1] = plane_w[2] = AV_CEIL_RSHIFT(inlink->w, s->hsub);
-    plane_h[0] = inlink->h;
-    plane_h[1] = plane_h[2] = AV_CEIL_RSHIFT(inlink->h, s->vsub);
-    fp[0] = &s->luma;
-    fp[1] = fp[2] = &s->chroma;
+    ThreadData *td = arg;
+    int i;
+
     for (i = 0; i < 3; i++) {
-        apply_unsharp(out->data[i], out->linesize[i], in->data[i], in->linesize[i], plane_w[i], plane_h[i], fp[i]);
+        UnsharpFilterParam *fp = i ? &s->chroma : &s->luma;
+        const int w = i ? AV_CEIL_RSHIFT(inlink->w, s->hsub) : inlink->w;
+        const int h = i ? AV_CEIL_RSHIFT(inlink->h, s->vsub) : inlink->h;
+        const int slice_start = (h *  jobnr   ) / nb_jobs;
+        const int slice_end   = (h * (jobnr+1)) / nb_jobs;
+
+        apply_unsharp(s, td->out->data[i], td->out->linesize[i],
+                      td->in->data[i], td->in->linesize[i],
+                      w, h, slice_start, slice_end, fp,
+                      fp->sc + jobnr * 2 * fp->steps_y,
+                      s->line + jobnr * s->line_size);
     }
     return 0;
 }
 
+static int apply_unsharp_c(AVFilterContext *ctx, AVFrame *in, AVFrame *out)
+{
+    UnsharpContext *s = ctx->priv;
+    ThreadData td = { .in = in, .out = out };
+
+    ctx->internal->execute(ctx, unsharp_slice, &td, NULL,
+                           FFMIN(AV_CEIL_RSHIFT(in->height, s->vsub), s->nb_jobs));
+    return 0;
+}
+
+av_cold void ff_unsharp_init(UnsharpContext *s)
+{
+    s->column_sum = column_sum_c;
+    s->row_sum    = row_sum_c;
+    s->sharpen    = sharpen_c;
+}
+
 static void set_filter_param(UnsharpFilterParam *fp, int msize_x, int msize_y, float amount)
 {
     fp->msize_x = msize_x;
@@ -143,6 +200,7 @@ static av_cold int init(AVFilterContext *ctx)
         return AVERROR(EINVAL);
     }
     s->apply_unsharp = apply_unsharp_c;
+    ff_unsharp_init(s);
     return 0;
 }
 
@@ -162,6 +220,7 @@ static int query_formats(AVFilterContext *ctx)
 
 static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const char *effect_type, int width)
 {
+    UnsharpContext *s = ctx->priv;
     int z;
     const char *effect = fp->amount == 0 ? "none" : fp->amount < 0 ? "blur" : "sharpen";
 
@@ -175,22 +234,48 @@ static int init_filter_param(AVFilterContext *ctx, UnsharpFilterParam *fp, const
     av_log(ctx, AV_LOG_VERBOSE, "effect:%s type:%s msize_x:%d msize_y:%d amount:%0.2f\n",
            effect, effect_type, fp->msize_x, fp->msize_y, fp->amount / 65535.0);
 
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        if (!(fp->sc[z] = av_malloc_array(width + 2 * fp->steps_x,
+    fp->sc = av_mallocz_array(2 * fp->steps_y * s->nb_jobs, sizeof(*fp->sc));
+    if (!fp->sc)
+        return AVERROR(ENOMEM);
+
+    for (z = 0; z < 2 * fp->steps_y * s->nb_jobs; z++)
+        if (!(fp->sc[z] = av_malloc_array(FFALIGN(width, 8),
                                           sizeof(*(fp->sc[z])))))
             return AVERROR(ENOMEM);
 
     return 0;
 }
 
+static void free_filter_param(UnsharpFilterParam *fp, int nb_jobs)
+{
+    int z;
+
+    if (!fp->sc)
+        return;
+    for (z = 0; z < 2 * fp->steps_y * nb_jobs; z++)
+        av_freep(&fp->sc[z]);
+    av_freep(&fp->sc);
+}
+
 static int config_props(AVFilterLink *link)
 {
     UnsharpContext *s = link->dst->priv;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(link->format);
     int ret;
 
+    free_filter_param(&s->luma,   s->nb_jobs);
+    free_filter_param(&s->chroma, s->nb_jobs);
+    av_freep(&s->line);
+
     s->hsub = desc->log2_chroma_w;
     s->vsub = desc->log2_chroma_h;
+    s->nb_jobs = ff_filter_get_nb_threads(link->dst);
+
+    /* room for the horizontal padding and for SIMD overwrites */
+    s->line_size = FFALIGN(link->w + 2 * FFMAX(s->luma.steps_x, s->chroma.steps_x), 8) + 8;
+    s->line = av_malloc_array(s->line_size, s->nb_jobs * sizeof(*s->line));
+    if (!s->line)
+        return AVERROR(ENOMEM);
 
     ret = init_filter_param(link->dst, &s->luma,   "luma",   link->w);
     if (ret < 0)
@@ -202,20 +287,13 @@ static int config_props(AVFilterLink *link)
     return 0;
 }
 
-static void free_filter_param(UnsharpFilterParam *fp)
-{
-    int z;
-
-    for (z = 0; z < 2 * fp->steps_y; z++)
-        av_freep(&fp->sc[z]);
-}
-
 static av_cold void uninit(AVFilterContext *ctx)
 {
     UnsharpContext *s = ctx->priv;
 
-    free_filter_param(&s->luma);
-    free_filter_param(&s->chroma);
+    free_filter_param(&s->luma,   s->nb_jobs);
+    free_filter_param(&s->chroma, s->nb_jobs);
+    av_freep(&s->line);
 }
 
 static int filter_frame(AVFilterLink *link, AVFrame *in)
@@ -294,5 +372,5 @@ AVFilter ff_vf_unsharp = {
     .query_formats = query_formats,
     .inputs        = avfilter_vf_unsharp_inputs,
     .outputs       = avfilter_vf_unsharp_outputs,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -36,14 +36,17 @@
 #define BUFFER_ALIGN 32
 
 
+static AVFrame *get_video_buffer(AVFilterLink *link, int w, int h);
+
 AVFrame *ff_null_get_video_buffer(AVFilterLink *link, int w, int h)
 {
-    return ff_get_video_buffer(link->dst->outputs[0], w, h);
+    return get_video_buffer(link->dst->outputs[0], w, h);
 }
 
 AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
 {
     AVFrame *frame = NULL;
+    FFBufferCache *cache;
     int pool_width = 0;
     int pool_height = 0;
     int pool_align = 0;
@@ -64,30 +67,37 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
         return frame;
     }
 
+    /* the destination can allocate from the pool of its input link too */
+    cache = link->graph ? link->graph->internal->buffer_cache : NULL;
+    ff_link_lock(link);
     if (!link->frame_pool) {
-        link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
+        link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, cache,
+                                                    w, h,
                                                     link->format, BUFFER_ALIGN);
         if (!link->frame_pool)
-            return NULL;
+            goto end;
     } else {
         if (ff_frame_pool_get_video_config(link->frame_pool,
                                            &pool_width, &pool_height,
                                            &pool_format, &pool_align) < 0) {
-            return NULL;
+            goto end;
         }
 
         if (pool_width != w || pool_height != h ||
             pool_format != link->format || pool_align != BUFFER_ALIGN) {
 
             ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
+            link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, cache,
+                                                        w, h,
                                                         link->format, BUFFER_ALIGN);
             if (!link->frame_pool)
-                return NULL;
+                goto end;
         }
     }
 
     frame = ff_frame_pool_get(link->frame_pool);
+end:
+    ff_link_unlock(link);
     if (!frame)
         return NULL;
 
@@ -96,7 +106,7 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
     return frame;
 }
 
-AVFrame *ff_get_video_buffer(AVFilterLink *link, int w, int h)
+static AVFrame *get_video_buffer(AVFilterLink *link, int w, int h)
 {
     AVFrame *ret = NULL;
 
@@ -110,3 +120,13 @@ AVFrame *ff_get_video_buffer(AVFilterLink *link, int w, int h)
 
     return ret;
 }
+
+AVFrame *ff_get_video_buffer(AVFilterLink *link, int w, int h)
+{
+    AVFrame *ret = get_video_buffer(link, w, h);
+
+    /* accounted to the requesting filter, not the ones passing it on */
+    if (ret)
+        ff_filter_profile_alloc(link, ret);
+    return ret;
+}
@@ -37,6 +37,10 @@ av_cold void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
 {
     int cpu_flags = av_get_cpu_flags();
 
+    /* only replace the C row functions picked by ff_overlay_init_blend_row() */
+    if (!s->blend_row[0])
+        return;
+
     if (EXTERNAL_SSE4(cpu_flags) &&
         (format == OVERLAY_FORMAT_YUV444 ||
          format == OVERLAY_FORMAT_GBRP) &&
@@ -234,14 +234,20 @@ static void lumRangeFromJpeg16_c(int16_t *_dst, int width)
     if (DEBUG_SWSCALE_BUFFERS)                  \
         av_log(c, AV_LOG_DEBUG, __VA_ARGS__)
 
-static int swscale(SwsContext *c, const uint8_t *src[],
-                   int srcStride[], int srcSliceY,
-                   int srcSliceH, uint8_t *dst[], int dstStride[])
+/**
+ * Scale a slice of the source picture, writing only the destination lines
+ * in [dstSliceY, dstSliceY + dstSliceH).
+ */
+static int swscale_band(SwsContext *c, const uint8_t *src[],
+                        int srcStride[], int srcSliceY,
+                        int srcSliceH, uint8_t *dst[], int dstStride[],
+                        int dstSliceY, int dstSliceH)
 {
     /* load a few things into local vars to make the code more readable?
      * and faster */
     const int dstW                   = c->dstW;
     const int dstH                   = c->dstH;
+    const int dstEnd                 = dstSliceY + dstSliceH;
 
     const enum AVPixelFormat dstFormat = c->dstFormat;
     const int flags                  = c->flags;
@@ -343,7 +349,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     if (srcSliceY == 0) {
         lumBufIndex  = -1;
         chrBufIndex  = -1;
-        dstY         = 0;
+        dstY         = dstSliceY;
         lastInLumBuf = -1;
         lastInChrBuf = -1;
     }
@@ -360,8 +366,8 @@ static int swscale(SwsContext *c, const uint8_t *src[],
             srcSliceY, srcSliceH, chrSrcSliceY, chrSrcSliceH, 1);
 
     ff_init_slice_from_src(vout_slice, (uint8_t**)dst, dstStride, c->dstW,
-            dstY, dstH, dstY >> c->chrDstVSubSample,
-            AV_CEIL_RSHIFT(dstH, c->chrDstVSubSample), 0);
+            dstY, dstEnd - dstY, dstY >> c->chrDstVSubSample,
+            AV_CEIL_RSHIFT(dstEnd, c->chrDstVSubSample) - (dstY >> c->chrDstVSubSample), 0);
     if (srcSliceY == 0) {
         hout_slice->plane[0].sliceY = lastInLumBuf + 1;
         hout_slice->plane[1].sliceY = lastInChrBuf + 1;
@@ -375,7 +381,7 @@ static int swscale(SwsContext *c, const uint8_t *src[],
         hout_slice->width = dstW;
     }
 
-    for (; dstY < dstH; dstY++) {
+    for (; dstY < dstEnd; dstY++) {
         const int chrDstY = dstY >> c->chrDstVSubSample;
         int use_mmx_vfilter= c->use_mmx_vfilter;
 
@@ -537,6 +543,14 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     return dstY - lastDstY;
 }
 
+static int swscale(SwsContext *c, const uint8_t *src[],
+                   int srcStride[], int srcSliceY,
+                   int srcSliceH, uint8_t *dst[], int dstStride[])
+{
+    return swscale_band(c, src, srcStride, srcSliceY, srcSliceH,
+                        dst, dstStride, 0, c->dstH);
+}
+
 av_cold void ff_sws_init_range_convert(SwsContext *c)
 {
     c->lumConvertRange = NULL;
@@ -752,15 +766,11 @@ static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
     }
 }
 
-/**
- * swscale wrapper, so we don't need to export the SwsContext.
- * Assumes planar YUV to be in YUV order instead of YVU.
- */
-int attribute_align_arg sws_scale(struct SwsContext *c,
-                                  const uint8_t * const srcSlice[],
-                                  const int srcStride[], int srcSliceY,
-                                  int srcSliceH, uint8_t *const dst[],
-                                  const int dstStride[])
+static int scale_internal(SwsContext *c,
+                          const uint8_t * const srcSlice[],
+                          const int srcStride[], int srcSliceY,
+                          int srcSliceH, uint8_t *const dst[],
+                          const int dstStride[], int dstSliceY, int dstSliceH)
 {
     int i, ret;
     const uint8_t *src2[4];
@@ -983,7 +993,11 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
     /* reset slice direction at end of frame */
     if (srcSliceY_internal + srcSliceH == c->srcH)
         c->sliceDir = 0;
-    ret = c->swscale(c, src2, srcStride2, srcSliceY_internal, srcSliceH, dst2, dstStride2);
+    if (dstSliceY || dstSliceH != c->dstH)
+        ret = swscale_band(c, src2, srcStride2, srcSliceY_internal, srcSliceH,
+                           dst2, dstStride2, dstSliceY, dstSliceH);
+    else
+        ret = c->swscale(c, src2, srcStride2, srcSliceY_internal, srcSliceH, dst2, dstStride2);
 
 
     if (c->dstXYZ && !(c->srcXYZ && c->srcW==c->dstW && c->srcH==c->dstH)) {
@@ -1000,3 +1014,60 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
     av_free(rgb0_tmp);
     return ret;
 }
+
+void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
+                         int nb_jobs, int nb_threads)
+{
+    SwsContext *parent = priv;
+    SwsContext      *c = parent->slice_ctx[jobnr];
+    const int slice_y  = jobnr * parent->slice_height;
+    const int slice_h  = FFMIN(parent->slice_height, c->dstH - slice_y);
+
+    parent->slice_err[jobnr] = scale_internal(c, parent->slice_src, parent->slice_src_stride,
+                                              0, c->srcH, parent->slice_dst,
+                                              parent->slice_dst_stride, slice_y, slice_h);
+}
+
+static int scale_threaded(SwsContext *c, const uint8_t * const srcSlice[],
+                          const int srcStride[], uint8_t *const dst[],
+                          const int dstStride[])
+{
+    const int align = 1 << c->chrDstVSubSample;
+    int i, nb_jobs;
+
+    c->slice_height = FFALIGN((c->dstH + c->nb_slice_ctx - 1) / c->nb_slice_ctx, align);
+    nb_jobs         = (c->dstH + c->slice_height - 1) / c->slice_height;
+
+    c->slice_src        = srcSlice;
+    c->slice_src_stride = srcStride;
+    c->slice_dst        = dst;
+    c->slice_dst_stride = dstStride;
+
+    avpriv_slicethread_execute(c->slicethread, nb_jobs, 0);
+
+    for (i = 0; i < nb_jobs; i++)
+        if (c->slice_err[i] <= 0)
+            return c->slice_err[i];
+    return c->dstH;
+}
+
+/**
+ * swscale wrapper, so we don't need to export the SwsContext.
+ * Assumes planar YUV to be in YUV order instead of YVU.
+ */
+int attribute_align_arg sws_scale(struct SwsContext *c,
+                                  const uint8_t * const srcSlice[],
+                                  const int srcStride[], int srcSliceY,
+                                  int srcSliceH, uint8_t *const dst[],
+                                  const int dstStride[])
+{
+    /* Only complete frames are split between threads, as each band needs
+     * access to all the source lines its filters cover. */
+    if (c->slicethread && !c->cascaded_context[0] && !c->sliceDir &&
+        srcSlice && srcStride && dst && dstStride &&
+        srcSliceY == 0 && srcSliceH == c->srcH)
+        return scale_threaded(c, srcSlice, srcStride, dst, dstStride);
+
+    return scale_internal(c, srcSlice, srcStride, srcSliceY, srcSliceH,
+                          dst, dstStride, 0, c->dstH);
+}
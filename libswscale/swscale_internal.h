@@ -32,6 +32,7 @@
 #include "libavutil/pixfmt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/ppc/util_altivec.h"
+#include "libavutil/slicethread.h"
 
 #define STR(s) AV_TOSTRING(s) // AV_STRINGIFY is too long
 
@@ -321,6 +322,21 @@ typedef struct SwsContext {
     uint8_t *cascaded1_tmp[4];
     int cascaded_mainindex;
 
+    /* Slice threading: frames are split into horizontal bands of the
+     * destination, each band is scaled by its own child context so that
+     * every thread has its own filter ring buffers.
+     */
+    int nb_threads;
+    AVSliceThread *slicethread;
+    struct SwsContext **slice_ctx;
+    int *slice_err;
+    int nb_slice_ctx;
+    int slice_height;             ///< Height of one destination band, multiple of the chroma subsampling.
+    const uint8_t * const *slice_src;
+    const int *slice_src_stride;
+    uint8_t * const *slice_dst;
+    const int *slice_dst_stride;
+
     double gamma_value;
     int gamma_flag;
     int is_internal_gamma;
@@ -858,6 +874,9 @@ void ff_get_unscaled_swscale_aarch64(SwsContext *c);
  */
 SwsFunc ff_getSwsFunc(SwsContext *c);
 
+void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
+                         int nb_jobs, int nb_threads);
+
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
                               yuv2planar1_fn *yuv2plane1,
@@ -860,6 +860,15 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     const AVPixFmtDescriptor *desc_dst;
     const AVPixFmtDescriptor *desc_src;
     int need_reinit = 0;
+    int i;
+
+    for (i = 0; i < c->nb_slice_ctx; i++) {
+        int ret = sws_setColorspaceDetails(c->slice_ctx[i], inv_table, srcRange,
+                                           table, dstRange, brightness,
+                                           contrast, saturation);
+        if (ret < 0)
+            return ret;
+    }
 
     handle_formats(c);
     desc_dst = av_pix_fmt_desc_get(c->dstFormat);
@@ -1160,6 +1169,56 @@ static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
     }
 }
 
+static av_cold int context_init_threaded(SwsContext *c,
+                                         SwsFilter *src_filter, SwsFilter *dst_filter)
+{
+    int i, ret;
+
+    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
+                                    ff_sws_slice_worker, NULL, c->nb_threads);
+    if (ret == AVERROR(ENOSYS)) {
+        c->nb_threads = 1;
+        return 0;
+    } else if (ret < 0)
+        return ret;
+
+    c->nb_threads = ret;
+    if (c->nb_threads == 1 || c->dstH < 2 << c->chrDstVSubSample) {
+        avpriv_slicethread_free(&c->slicethread);
+        return 0;
+    }
+
+    c->slice_ctx = av_mallocz_array(c->nb_threads, sizeof(*c->slice_ctx));
+    c->slice_err = av_mallocz_array(c->nb_threads, sizeof(*c->slice_err));
+    if (!c->slice_ctx || !c->slice_err)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < c->nb_threads; i++) {
+        SwsContext *slice_ctx;
+
+        slice_ctx = c->slice_ctx[i] = sws_alloc_context();
+        if (!slice_ctx)
+            return AVERROR(ENOMEM);
+        c->nb_slice_ctx++;
+
+        ret = av_opt_copy(slice_ctx, c);
+        if (ret < 0)
+            return ret;
+        slice_ctx->nb_threads = 1;
+        /* the formats were already rewritten by handle_formats() */
+        slice_ctx->src0Alpha  = c->src0Alpha;
+        slice_ctx->dst0Alpha  = c->dst0Alpha;
+        slice_ctx->srcXYZ     = c->srcXYZ;
+        slice_ctx->dstXYZ     = c->dstXYZ;
+
+        ret = sws_init_context(slice_ctx, src_filter, dst_filter);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                              SwsFilter *dstFilter)
 {
@@ -1827,7 +1886,14 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     }
 
     c->swscale = ff_getSwsFunc(c);
-    return ff_init_filters(c);
+    ret = ff_init_filters(c);
+    if (ret < 0)
+        return ret;
+
+    if (c->nb_threads != 1 && c->dither != SWS_DITHER_ED && !c->srcXYZ &&
+        !(c->src0Alpha && !c->dst0Alpha && isALPHA(c->dstFormat)))
+        return context_init_threaded(c, srcFilter, dstFilter);
+    return 0;
 fail: // FIXME replace things by appropriate error codes
     if (ret == RETCODE_USE_CASCADE)  {
         int tmpW = sqrt(srcW * (int64_t)dstW);
@@ -2312,6 +2378,12 @@ void sws_freeContext(SwsContext *c)
     if (!c)
         return;
 
+    avpriv_slicethread_free(&c->slicethread);
+    for (i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+    av_freep(&c->slice_err);
+
     for (i = 0; i < 4; i++)
         av_freep(&c->dither_error[i]);
 
@@ -0,0 +1,100 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/drawutils.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH 128
+/* two rows of mask, twice as wide as a subsampled row */
+#define MASK_LINESIZE (2 * WIDTH)
+#define BUF_SIZE (WIDTH + 32)
+
+static const enum AVPixelFormat formats[] = {
+    AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV440P, AV_PIX_FMT_YUV420P,
+};
+
+static const int widths[] = { WIDTH, WIDTH - 1, WIDTH - 13, 5 };
+
+static void randomize_buffers(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i += 4)
+        AV_WN32A(buf + i, rnd());
+}
+
+/* make runs of fully transparent and fully opaque mask pixels, as in glyphs */
+static void randomize_mask(uint8_t *mask, int size)
+{
+    int i;
+
+    randomize_buffers(mask, size);
+    for (i = 0; i < size; i += 16)
+        if (rnd() % 3)
+            memset(mask + i, rnd() & 1 ? 255 : 0, 8);
+}
+
+static void check_blend_mask_row(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, mask,    [MASK_LINESIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [BUF_SIZE]);
+    FFDrawContext draw;
+    int f, i;
+
+    declare_func(int, uint8_t *dst, const uint8_t *mask, ptrdiff_t mask_linesize,
+                 int w, unsigned src, unsigned alpha);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        ff_draw_init(&draw, formats[f], 0);
+
+        /* plane 1 is the subsampled one */
+        if (!check_func(draw.blend_mask_row[1], "blend_mask_row_%d%d",
+                        draw.hsub[1], draw.vsub[1]))
+            continue;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i], ret_ref, ret_new;
+            /* same scaling of the color alpha as ff_blend_mask() */
+            unsigned src = rnd() & 0xff, alpha = (0x10307 * (rnd() & 0xff) + 0x3) >> 8;
+
+            randomize_mask(mask, MASK_LINESIZE * 2);
+            randomize_buffers(dst, BUF_SIZE);
+            memcpy(dst_ref, dst, BUF_SIZE);
+            memcpy(dst_new, dst, BUF_SIZE);
+
+            ret_ref = call_ref(dst_ref, mask, MASK_LINESIZE, w, src, alpha);
+            ret_new = call_new(dst_new, mask, MASK_LINESIZE, w, src, alpha);
+            /* the new function may leave more pixels to the caller */
+            if (ret_new > ret_ref || ret_new < 0 ||
+                memcmp(dst_ref, dst_new, ret_new) ||
+                memcmp(dst + ret_new, dst_new + ret_new, BUF_SIZE - ret_new))
+                fail();
+        }
+        bench_new(dst_new, mask, MASK_LINESIZE, WIDTH, 0x80, 0x10307 * 0x80 >> 8);
+    }
+}
+
+void checkasm_check_drawutils(void)
+{
+    check_blend_mask_row();
+    report("blend_mask_row");
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavcodec/ffv1dsp.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#define WIDTH 256
+/* three rows with the padding used by the codec */
+#define STRIDE (WIDTH + 6)
+#define BUF_SIZE (3 * STRIDE + 16)
+
+static const int widths[] = { WIDTH, WIDTH - 1, WIDTH - 9, 3 };
+
+/* odd symmetric step tables as built by the codec, with a product of the
+ * level counts within the 32768 context limit */
+static void init_quant_table(int16_t *quant_table)
+{
+    static const int levels[5] = { 11, 11, 5, 5, 5 };
+    int i, j, scale = 1;
+
+    for (i = 0; i < 5; i++) {
+        int16_t *q = quant_table + 256 * i;
+        int v = 0;
+
+        q[0] = 0;
+        for (j = 1; j < 128; j++) {
+            if (v < levels[i] / 2 && !(rnd() % 3))
+                v++;
+            q[j]       =  v * scale;
+            q[256 - j] = -v * scale;
+        }
+        q[128] = -q[127];
+        scale *= levels[i];
+    }
+}
+
+static void randomize_buffers(int16_t *buf, int bits)
+{
+    int i, smooth = rnd() & 1;
+
+    for (i = 0; i < BUF_SIZE; i++)
+        buf[i] = (smooth ? (1 << (bits - 1)) + (int)(rnd() % 7) - 3 : rnd()) &
+                 ((1 << bits) - 1);
+}
+
+static void check_encode_context(const int16_t *quant_table)
+{
+    LOCAL_ALIGNED_32(int16_t, buf,         [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, context_ref, [WIDTH + 16]);
+    LOCAL_ALIGNED_32(int16_t, context_new, [WIDTH + 16]);
+    LOCAL_ALIGNED_32(int16_t, diff_ref,    [WIDTH + 16]);
+    LOCAL_ALIGNED_32(int16_t, diff_new,    [WIDTH + 16]);
+    const int16_t *src = buf + 3, *last = buf + STRIDE + 3, *last2 = buf + 2 * STRIDE + 3;
+    static const int bits[] = { 8, 10, 16 };
+    FFV1DSPContext c;
+    int large, b, i;
+
+    declare_func(void, int16_t *context, int16_t *diff, const int16_t *src,
+                 const int16_t *last, const int16_t *last2,
+                 const int16_t *quant_table, int large, int bits, int w);
+
+    ff_ffv1dsp_init(&c);
+
+    for (large = 0; large < 2; large++) {
+        if (!check_func(c.encode_context, "ffv1_encode_context%s", large ? "_large" : ""))
+            continue;
+
+        for (b = 0; b < FF_ARRAY_ELEMS(bits); b++) {
+            for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                int w = widths[i];
+
+                randomize_buffers(buf, bits[b]);
+                call_ref(context_ref, diff_ref, src, last, last2, quant_table, large, bits[b], w);
+                call_new(context_new, diff_new, src, last, last2, quant_table, large, bits[b], w);
+                if (memcmp(context_ref, context_new, w * sizeof(*context_ref)) ||
+                    memcmp(diff_ref, diff_new, w * sizeof(*diff_ref)))
+                    fail();
+            }
+        }
+        bench_new(context_new, diff_new, src, last, last2, quant_table, large, 10, WIDTH);
+    }
+}
+
+static void check_decode_top_context(const int16_t *quant_table)
+{
+    LOCAL_ALIGNED_32(int16_t, buf,         [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int16_t, context_ref, [WIDTH + 16]);
+    LOCAL_ALIGNED_32(int16_t, context_new, [WIDTH + 16]);
+    const int16_t *last = buf + 3, *last2 = buf + STRIDE + 3;
+    FFV1DSPContext c;
+    int large, i;
+
+    declare_func(void, int16_t *context, const int16_t *last, const int16_t *last2,
+                 const int16_t *quant_table, int large, int w);
+
+    ff_ffv1dsp_init(&c);
+
+    for (large = 0; large < 2; large++) {
+        if (!check_func(c.decode_top_context, "ffv1_decode_top_context%s", large ? "_large" : ""))
+            continue;
+
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i];
+
+            randomize_buffers(buf, 16);
+            call_ref(context_ref, last, last2, quant_table, large, w);
+            call_new(context_new, last, last2, quant_table, large, w);
+            if (memcmp(context_ref, context_new, w * sizeof(*context_ref)))
+                fail();
+        }
+        bench_new(context_new, last, last2, quant_table, large, WIDTH);
+    }
+}
+
+void checkasm_check_ffv1dsp(void)
+{
+    /* the tables may be read one entry past their end */
+    LOCAL_ALIGNED_32(int16_t, quant_table, [5 * 256 + 16]);
+
+    memset(quant_table, 0, (5 * 256 + 16) * sizeof(*quant_table));
+    init_quant_table(quant_table);
+
+    check_encode_context(quant_table);
+    report("encode_context");
+
+    check_decode_top_context(quant_table);
+    report("decode_top_context");
+}
@@ -0,0 +1,176 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#include "libavcodec/hevcpred.h"
+
+#include "checkasm.h"
+
+#define MAX_SIZE 32
+/* top[-1] and left[-1] are the corner sample, top[2 * size] the last one
+ * read by the predictions */
+#define REF_SIZE (2 * MAX_SIZE + 1 + 31)
+#define BUF_SIZE (MAX_SIZE * MAX_SIZE * 2)
+
+static const int bit_depths[] = { 8, 9, 10, 12 };
+
+static void randomize_ref(uint8_t *buf, int bit_depth)
+{
+    int i;
+
+    for (i = 0; i < REF_SIZE; i++) {
+        if (bit_depth == 8)
+            buf[i] = rnd();
+        else
+            AV_WN16A(buf + 2 * i, rnd() & ((1 << bit_depth) - 1));
+    }
+}
+
+static void check_pred_planar(HEVCPredContext *h, const uint8_t *top,
+                              const uint8_t *left, uint8_t *dst0,
+                              uint8_t *dst1, int bit_depth)
+{
+    int i;
+
+    declare_func(void, uint8_t *src, const uint8_t *top,
+                 const uint8_t *left, ptrdiff_t stride);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+
+        if (check_func(h->pred_planar[i], "hevc_pred_planar_%dx%d_%d",
+                       size, size, bit_depth)) {
+            memset(dst0, 0, BUF_SIZE);
+            memset(dst1, 0, BUF_SIZE);
+            call_ref(dst0, top, left, MAX_SIZE);
+            call_new(dst1, top, left, MAX_SIZE);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+            bench_new(dst1, top, left, MAX_SIZE);
+        }
+    }
+}
+
+static void check_pred_dc(HEVCPredContext *h, const uint8_t *top,
+                          const uint8_t *left, uint8_t *dst0,
+                          uint8_t *dst1, int bit_depth)
+{
+    int log2_size, c_idx;
+
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride, int log2_size, int c_idx);
+
+    for (log2_size = 2; log2_size <= 5; log2_size++) {
+        int size = 1 << log2_size;
+
+        if (check_func(h->pred_dc, "hevc_pred_dc_%dx%d_%d",
+                       size, size, bit_depth)) {
+            for (c_idx = 0; c_idx <= 1; c_idx++) {
+                memset(dst0, 0, BUF_SIZE);
+                memset(dst1, 0, BUF_SIZE);
+                call_ref(dst0, top, left, MAX_SIZE, log2_size, c_idx);
+                call_new(dst1, top, left, MAX_SIZE, log2_size, c_idx);
+                if (memcmp(dst0, dst1, BUF_SIZE))
+                    fail();
+            }
+            bench_new(dst1, top, left, MAX_SIZE, log2_size, 0);
+        }
+    }
+}
+
+static void check_pred_angular(HEVCPredContext *h, const uint8_t *top,
+                               const uint8_t *left, uint8_t *dst0,
+                               uint8_t *dst1, int bit_depth)
+{
+    int i, mode, c_idx;
+
+    declare_func(void, uint8_t *src, const uint8_t *top, const uint8_t *left,
+                 ptrdiff_t stride, int c_idx, int mode);
+
+    for (i = 0; i < 4; i++) {
+        int size = 4 << i;
+
+        if (check_func(h->pred_angular[i], "hevc_pred_angular_%dx%d_%d",
+                       size, size, bit_depth)) {
+            for (mode = 2; mode <= 34; mode++) {
+                for (c_idx = 0; c_idx <= 1; c_idx++) {
+                    memset(dst0, 0, BUF_SIZE);
+                    memset(dst1, 0, BUF_SIZE);
+                    call_ref(dst0, top, left, MAX_SIZE, c_idx, mode);
+                    call_new(dst1, top, left, MAX_SIZE, c_idx, mode);
+                    if (memcmp(dst0, dst1, BUF_SIZE))
+                        fail();
+                }
+            }
+            /* one horizontal and one vertical mode, both with a negative
+             * angle */
+            bench_new(dst1, top, left, MAX_SIZE, 1, 14);
+            bench_new(dst1, top, left, MAX_SIZE, 1, 22);
+        }
+    }
+}
+
+void checkasm_check_hevc_pred(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, top_buf,  [REF_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, left_buf, [REF_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,     [BUF_SIZE]);
+    HEVCPredContext h;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+        int pixel     = bit_depth > 8 ? 2 : 1;
+
+        ff_hevc_pred_init(&h, bit_depth);
+        randomize_ref(top_buf,  bit_depth);
+        randomize_ref(left_buf, bit_depth);
+
+        check_pred_planar(&h, top_buf + pixel, left_buf + pixel, dst0, dst1, bit_depth);
+    }
+    report("pred_planar");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+        int pixel     = bit_depth > 8 ? 2 : 1;
+
+        ff_hevc_pred_init(&h, bit_depth);
+        randomize_ref(top_buf,  bit_depth);
+        randomize_ref(left_buf, bit_depth);
+
+        check_pred_dc(&h, top_buf + pixel, left_buf + pixel, dst0, dst1, bit_depth);
+    }
+    report("pred_dc");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bit_depths); i++) {
+        int bit_depth = bit_depths[i];
+        int pixel     = bit_depth > 8 ? 2 : 1;
+
+        ff_hevc_pred_init(&h, bit_depth);
+        randomize_ref(top_buf,  bit_depth);
+        randomize_ref(left_buf, bit_depth);
+
+        check_pred_angular(&h, top_buf + pixel, left_buf + pixel, dst0, dst1, bit_depth);
+    }
+    report("pred_angular");
+}
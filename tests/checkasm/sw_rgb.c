@@ -68,6 +68,96 @@ static void check_shuffle_bytes(void * func, const char * report)
     }
 }
 
+static void check_packed_convert(void *func, const char *report,
+                                 int src_bpp, int dst_bpp)
+{
+    int i;
+    LOCAL_ALIGNED_32(uint8_t, src,  [MAX_STRIDE * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_STRIDE * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_STRIDE * 4]);
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src, uint8_t *dst, int src_size);
+
+    randomize_buffers(src, MAX_STRIDE * 4);
+
+    if (check_func(func, "%s", report)) {
+        for (i = 0; i < 6; i ++) {
+            memset(dst0, 0, MAX_STRIDE * 4);
+            memset(dst1, 0, MAX_STRIDE * 4);
+            call_ref(src, dst0, width[i] * src_bpp);
+            call_new(src, dst1, width[i] * src_bpp);
+            if (memcmp(dst0, dst1, width[i] * dst_bpp))
+                fail();
+        }
+        bench_new(src, dst1, width[5] * src_bpp);
+    }
+}
+
+static void check_interleave_bytes(void)
+{
+    int i;
+    LOCAL_ALIGNED_32(uint8_t, src0, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, src1, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_STRIDE * MAX_HEIGHT * 2]);
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src1, const uint8_t *src2,
+                      uint8_t *dst, int width, int height,
+                      int src1Stride, int src2Stride, int dstStride);
+
+    randomize_buffers(src0, MAX_STRIDE * MAX_HEIGHT);
+    randomize_buffers(src1, MAX_STRIDE * MAX_HEIGHT);
+
+    if (check_func(interleaveBytes, "interleave_bytes")) {
+        for (i = 0; i < 6; i ++) {
+            memset(dst0, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+            memset(dst1, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+            call_ref(src0, src1, dst0, planes[i].w, planes[i].h,
+                     planes[i].s, planes[i].s, MAX_STRIDE * 2);
+            call_new(src0, src1, dst1, planes[i].w, planes[i].h,
+                     planes[i].s, planes[i].s, MAX_STRIDE * 2);
+            if (memcmp(dst0, dst1, MAX_STRIDE * MAX_HEIGHT * 2))
+                fail();
+        }
+        bench_new(src0, src1, dst1, planes[5].w, planes[5].h,
+                  planes[5].s, planes[5].s, MAX_STRIDE * 2);
+    }
+}
+
+static void check_deinterleave_bytes(void)
+{
+    int i;
+    LOCAL_ALIGNED_32(uint8_t, src,    [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_u, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_v, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_u, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_v, [MAX_STRIDE * MAX_HEIGHT]);
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, const uint8_t *src, uint8_t *dst1,
+                      uint8_t *dst2, int width, int height,
+                      int srcStride, int dst1Stride, int dst2Stride);
+
+    randomize_buffers(src, MAX_STRIDE * MAX_HEIGHT * 2);
+
+    if (check_func(deinterleaveBytes, "deinterleave_bytes")) {
+        for (i = 0; i < 6; i ++) {
+            memset(dst0_u, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst0_v, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst1_u, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst1_v, 0, MAX_STRIDE * MAX_HEIGHT);
+            call_ref(src, dst0_u, dst0_v, planes[i].w, planes[i].h,
+                     MAX_STRIDE * 2, MAX_STRIDE, MAX_STRIDE);
+            call_new(src, dst1_u, dst1_v, planes[i].w, planes[i].h,
+                     MAX_STRIDE * 2, MAX_STRIDE, MAX_STRIDE);
+            if (memcmp(dst0_u, dst1_u, MAX_STRIDE * MAX_HEIGHT) ||
+                memcmp(dst0_v, dst1_v, MAX_STRIDE * MAX_HEIGHT))
+                fail();
+        }
+        bench_new(src, dst1_u, dst1_v, planes[5].w, planes[5].h,
+                  MAX_STRIDE * 2, MAX_STRIDE, MAX_STRIDE);
+    }
+}
+
 static void check_uyvy_to_422p(void)
 {
     int i;
@@ -132,4 +222,29 @@ void checkasm_check_sw_rgb(void)
 
     check_uyvy_to_422p();
     report("uyvytoyuv422");
+
+    check_packed_convert(rgb24tobgr24, "rgb24tobgr24", 3, 3);
+    check_packed_convert(rgb24tobgr32, "rgb24tobgr32", 3, 4);
+    check_packed_convert(rgb32tobgr24, "rgb32tobgr24", 4, 3);
+    check_packed_convert(rgb24tobgr16, "rgb24tobgr16", 3, 2);
+    check_packed_convert(rgb24tobgr15, "rgb24tobgr15", 3, 2);
+    check_packed_convert(rgb24to16,    "rgb24to16",    3, 2);
+    check_packed_convert(rgb24to15,    "rgb24to15",    3, 2);
+    check_packed_convert(rgb32to16,    "rgb32to16",    4, 2);
+    check_packed_convert(rgb32to15,    "rgb32to15",    4, 2);
+    check_packed_convert(rgb32tobgr16, "rgb32tobgr16", 4, 2);
+    check_packed_convert(rgb32tobgr15, "rgb32tobgr15", 4, 2);
+    check_packed_convert(rgb15to16,    "rgb15to16",    2, 2);
+    check_packed_convert(rgb16to15,    "rgb16to15",    2, 2);
+    check_packed_convert(rgb15to32,    "rgb15to32",    2, 4);
+    check_packed_convert(rgb16to32,    "rgb16to32",    2, 4);
+    check_packed_convert(rgb15tobgr24, "rgb15tobgr24", 2, 3);
+    check_packed_convert(rgb16tobgr24, "rgb16tobgr24", 2, 3);
+    report("packed_rgb");
+
+    check_interleave_bytes();
+    report("interleave_bytes");
+
+    check_deinterleave_bytes();
+    report("deinterleave_bytes");
 }
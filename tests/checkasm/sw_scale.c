@@ -0,0 +1,272 @@
+/*
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j+=4)       \
+            AV_WN32(buf + j, rnd());      \
+    } while (0)
+
+#define SRC_PIXELS 512
+#define DST_PIXELS 512
+/* the SIMD scalers may process up to 4 (horizontal) or 32 (vertical) pixels
+ * past the requested width */
+#define DST_PAD    32
+#define MAX_FILTER_WIDTH 40
+#define MAX_VFILTER 16
+
+static const int dst_widths[] = { 8, 17, 64, 123, DST_PIXELS };
+
+static const struct {
+    int bpc;
+    enum AVPixelFormat fmt;
+} src_depths[] = {
+    {  8, AV_PIX_FMT_YUV420P     },
+    {  9, AV_PIX_FMT_YUV420P9LE  },
+    { 10, AV_PIX_FMT_YUV420P10LE },
+    { 12, AV_PIX_FMT_YUV420P12LE },
+    { 14, AV_PIX_FMT_YUV420P14LE },
+    { 16, AV_PIX_FMT_YUV420P16LE },
+};
+
+static SwsContext *alloc_context(void)
+{
+    return sws_getContext(SRC_PIXELS, 2, AV_PIX_FMT_YUV420P,
+                          DST_PIXELS, 2, AV_PIX_FMT_YUV420P16LE,
+                          SWS_BICUBIC, NULL, NULL, NULL);
+}
+
+/* Build a normalized filter (coefficients sum up to 1 << 14) with random
+ * taps, padded the same way initFilter() pads its output. */
+static void init_hfilter(int16_t *filter, int32_t *filter_pos,
+                         int dst_w, int filter_size)
+{
+    int i, j;
+
+    for (i = 0; i < dst_w; i++) {
+        int sum = 0;
+
+        filter_pos[i] = (int64_t)i * (SRC_PIXELS - filter_size) / dst_w;
+        for (j = 0; j < filter_size - 1; j++) {
+            int coeff = rnd() % ((1 << 14) / filter_size);
+            filter[i * filter_size + j] = coeff;
+            sum += coeff;
+        }
+        filter[i * filter_size + j] = (1 << 14) - sum;
+    }
+    for (i = dst_w; i < dst_w + DST_PAD; i++) {
+        filter_pos[i] = filter_pos[dst_w - 1];
+        memcpy(filter + i * filter_size, filter + (dst_w - 1) * filter_size,
+               filter_size * sizeof(*filter));
+    }
+}
+
+static void check_hscale(void)
+{
+    /* 4 and 8 have their own versions, the other multiples of 4 go to the
+     * generic X4 or X8 ones depending on whether they are multiples of 8 */
+    static const int filter_sizes[] = { 4, 8, 12, 16, 20, 24, 32, 40 };
+    static const int dst_bpcs[]     = { 8, 16 };
+    LOCAL_ALIGNED_32(uint8_t,  src,        [SRC_PIXELS * 2 + 64]);
+    LOCAL_ALIGNED_32(int32_t,  dst0,       [DST_PIXELS + DST_PAD]);
+    LOCAL_ALIGNED_32(int32_t,  dst1,       [DST_PIXELS + DST_PAD]);
+    LOCAL_ALIGNED_32(int16_t,  filter,     [(DST_PIXELS + DST_PAD) * MAX_FILTER_WIDTH]);
+    LOCAL_ALIGNED_32(int32_t,  filter_pos, [DST_PIXELS + DST_PAD]);
+    SwsContext *ctx;
+    int s, d, f, w, i;
+
+    declare_func(void, SwsContext *c, int16_t *dst, int dstW,
+                 const uint8_t *src, const int16_t *filter,
+                 const int32_t *filterPos, int filterSize);
+
+    ctx = alloc_context();
+    if (!ctx)
+        return;
+
+    for (s = 0; s < FF_ARRAY_ELEMS(src_depths); s++) {
+        int bits = src_depths[s].bpc;
+
+        randomize_buffers(src, SRC_PIXELS * 2 + 64);
+        if (bits > 8 && bits < 16)
+            for (i = 0; i < SRC_PIXELS + 32; i++)
+                AV_WN16A(src + 2 * i, AV_RN16A(src + 2 * i) & ((1 << bits) - 1));
+
+        for (d = 0; d < FF_ARRAY_ELEMS(dst_bpcs); d++) {
+            ctx->srcFormat = src_depths[s].fmt;
+            ctx->srcBpc    = bits;
+            ctx->dstBpc    = dst_bpcs[d];
+
+            for (f = 0; f < FF_ARRAY_ELEMS(filter_sizes); f++) {
+                int filter_size = filter_sizes[f];
+
+                ctx->hLumFilterSize = ctx->hChrFilterSize = filter_size;
+                ff_getSwsFunc(ctx);
+
+                if (check_func(ctx->hyScale, "hscale_%d_to_%d_%d", bits,
+                               ctx->dstBpc <= 14 ? 15 : 19, filter_size)) {
+                    for (w = 0; w < FF_ARRAY_ELEMS(dst_widths); w++) {
+                        int dst_w = dst_widths[w];
+
+                        init_hfilter(filter, filter_pos, dst_w, filter_size);
+                        memset(dst0, 0, sizeof(*dst0) * (DST_PIXELS + DST_PAD));
+                        memset(dst1, 0, sizeof(*dst1) * (DST_PIXELS + DST_PAD));
+
+                        call_ref(ctx, (int16_t *)dst0, dst_w, src, filter,
+                                 filter_pos, filter_size);
+                        call_new(ctx, (int16_t *)dst1, dst_w, src, filter,
+                                 filter_pos, filter_size);
+                        if (memcmp(dst0, dst1, dst_w * (ctx->dstBpc <= 14 ? 2 : 4)))
+                            fail();
+                    }
+                    bench_new(ctx, (int16_t *)dst1, DST_PIXELS, src, filter,
+                              filter_pos, filter_size);
+                }
+            }
+        }
+    }
+    report("hscale");
+
+    sws_freeContext(ctx);
+}
+
+static void check_yuv2plane(void)
+{
+    static const struct {
+        int bits;
+        enum AVPixelFormat fmt;
+    } dst_depths[] = {
+        {  8, AV_PIX_FMT_YUV420P     },
+        {  9, AV_PIX_FMT_YUV420P9LE  },
+        { 10, AV_PIX_FMT_YUV420P10LE },
+        { 16, AV_PIX_FMT_YUV420P16LE },
+    };
+    LOCAL_ALIGNED_32(int32_t,  src_lines, [MAX_VFILTER * (DST_PIXELS + DST_PAD)]);
+    LOCAL_ALIGNED_32(uint16_t, dst0,      [DST_PIXELS + DST_PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst1,      [DST_PIXELS + DST_PAD]);
+    LOCAL_ALIGNED_16(int16_t,  vfilter,   [MAX_VFILTER]);
+    LOCAL_ALIGNED_8(uint8_t,   dither,    [8]);
+    const int16_t *src[MAX_VFILTER];
+    SwsContext *ctx;
+    int d, i, j, w, offset, filter_size;
+
+    ctx = alloc_context();
+    if (!ctx)
+        return;
+    /* the SIMD yuv2planeX_8 is only used for accurate rounding */
+    ctx->flags          |= SWS_ACCURATE_RND;
+    ctx->use_mmx_vfilter = 0;
+
+    randomize_buffers(dither, 8);
+
+    for (d = 0; d < FF_ARRAY_ELEMS(dst_depths); d++) {
+        int bits  = dst_depths[d].bits;
+        int bytes = bits > 8 ? 2 : 1;
+
+        /* 15 bit intermediates for up to 14 bit output, 19 bit above */
+        for (i = 0; i < MAX_VFILTER; i++) {
+            int32_t *line = src_lines + i * (DST_PIXELS + DST_PAD);
+
+            for (j = 0; j < DST_PIXELS + DST_PAD; j++) {
+                if (bits == 16)
+                    line[j] = rnd() & ((1 << 19) - 1);
+                else
+                    ((int16_t *)line)[j] = rnd() & ((1 << 15) - 1);
+            }
+            src[i] = (const int16_t *)line;
+        }
+
+        ctx->dstFormat = dst_depths[d].fmt;
+        ctx->dstBpc    = bits;
+        ff_getSwsFunc(ctx);
+
+        {
+            declare_func(void, const int16_t *src, uint8_t *dest, int dstW,
+                         const uint8_t *dither, int offset);
+
+            if (check_func(ctx->yuv2plane1, "yuv2plane1_%d", bits)) {
+                for (offset = 0; offset <= 3; offset += 3) {
+                    for (w = 0; w < FF_ARRAY_ELEMS(dst_widths); w++) {
+                        memset(dst0, 0, sizeof(*dst0) * (DST_PIXELS + DST_PAD));
+                        memset(dst1, 0, sizeof(*dst1) * (DST_PIXELS + DST_PAD));
+                        call_ref(src[0], (uint8_t *)dst0, dst_widths[w], dither, offset);
+                        call_new(src[0], (uint8_t *)dst1, dst_widths[w], dither, offset);
+                        if (memcmp(dst0, dst1, dst_widths[w] * bytes))
+                            fail();
+                    }
+                }
+                bench_new(src[0], (uint8_t *)dst1, DST_PIXELS, dither, 0);
+            }
+        }
+
+        {
+            declare_func(void, const int16_t *filter, int filterSize,
+                         const int16_t **src, uint8_t *dest, int dstW,
+                         const uint8_t *dither, int offset);
+
+            if (check_func(ctx->yuv2planeX, "yuv2planeX_%d", bits)) {
+                for (filter_size = 2; filter_size <= MAX_VFILTER; filter_size += 2) {
+                    int sum = 0;
+
+                    /* coefficients are 12 bit and sum up to 1 << 12 */
+                    for (i = 0; i < filter_size - 1; i++) {
+                        vfilter[i] = ((int)(rnd() % (1 << 12)) - (1 << 11)) / filter_size;
+                        sum += vfilter[i];
+                    }
+                    vfilter[i] = (1 << 12) - sum;
+
+                    for (w = 0; w < FF_ARRAY_ELEMS(dst_widths); w++) {
+                        offset = w & 1 ? 3 : 0;
+                        memset(dst0, 0, sizeof(*dst0) * (DST_PIXELS + DST_PAD));
+                        memset(dst1, 0, sizeof(*dst1) * (DST_PIXELS + DST_PAD));
+                        call_ref(vfilter, filter_size, src, (uint8_t *)dst0,
+                                 dst_widths[w], dither, offset);
+                        call_new(vfilter, filter_size, src, (uint8_t *)dst1,
+                                 dst_widths[w], dither, offset);
+                        if (memcmp(dst0, dst1, dst_widths[w] * bytes))
+                            fail();
+                    }
+                }
+                bench_new(vfilter, MAX_VFILTER, src, (uint8_t *)dst1, DST_PIXELS,
+                          dither, 0);
+            }
+        }
+    }
+    report("yuv2plane");
+
+    sws_freeContext(ctx);
+}
+
+void checkasm_check_sw_scale(void)
+{
+    check_hscale();
+    check_yuv2plane();
+}
@@ -0,0 +1,149 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/audioconvert.h"
+
+#include "checkasm.h"
+
+#define MAX_CHANNELS 8
+/* the SIMD converters are only used on multiples of 16 samples */
+#define LEN 256
+
+/* Reference: convert one plane or channel at a time with the generic
+ * per-sample converter of the current context. */
+static AudioConvert *ref_ctx;
+static int ref_in_planar, ref_out_planar, ref_in_bps, ref_out_bps;
+
+static void convert_c(uint8_t **dst, const uint8_t **src, int len)
+{
+    int channels = ref_in_planar == ref_out_planar ? 1 : ref_ctx->channels;
+    int ch;
+
+    /* same layout on both sides: the len samples of one plane */
+    for (ch = 0; ch < channels; ch++) {
+        int is = ref_in_planar  ? ref_in_bps  : ref_in_bps  * channels;
+        int os = ref_out_planar ? ref_out_bps : ref_out_bps * channels;
+        const uint8_t *pi = ref_in_planar  ? src[ch] : src[0] + ch * ref_in_bps;
+        uint8_t       *po = ref_out_planar ? dst[ch] : dst[0] + ch * ref_out_bps;
+
+        ref_ctx->conv_f(po, pi, is, os, po + os * len);
+    }
+}
+
+static void fill_input(uint8_t *buf, enum AVSampleFormat fmt, int nb_samples)
+{
+    int i;
+
+    for (i = 0; i < nb_samples; i++) {
+        int32_t r = rnd();
+
+        switch (av_get_packed_sample_fmt(fmt)) {
+        case AV_SAMPLE_FMT_S16: ((int16_t *)buf)[i] = r >> 16;               break;
+        case AV_SAMPLE_FMT_S32: ((int32_t *)buf)[i] = r;                     break;
+        /* stay within [-1.0, 1.0) to avoid the clipping corner cases */
+        case AV_SAMPLE_FMT_FLT: ((float   *)buf)[i] = r / (float)(1U << 31); break;
+        }
+    }
+}
+
+static void check_convert(enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt,
+                          int channels)
+{
+    LOCAL_ALIGNED_32(uint8_t, in_buf,   [MAX_CHANNELS * LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, out_buf0, [MAX_CHANNELS * LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, out_buf1, [MAX_CHANNELS * LEN * 4]);
+    uint8_t *in[MAX_CHANNELS], *out0[MAX_CHANNELS], *out1[MAX_CHANNELS];
+    AudioConvert *ac;
+    simd_func_type *func;
+    int in_planar  = av_sample_fmt_is_planar(in_fmt);
+    int out_planar = av_sample_fmt_is_planar(out_fmt);
+    int in_bps     = av_get_bytes_per_sample(in_fmt);
+    int out_bps    = av_get_bytes_per_sample(out_fmt);
+    int len, ch;
+
+    declare_func(void, uint8_t **dst, const uint8_t **src, int len);
+
+    ac = swri_audio_convert_alloc(out_fmt, in_fmt, channels, NULL, 0);
+    if (!ac)
+        return;
+
+    ref_ctx        = ac;
+    ref_in_planar  = in_planar;
+    ref_out_planar = out_planar;
+    ref_in_bps     = in_bps;
+    ref_out_bps    = out_bps;
+    func = ac->simd_f ? ac->simd_f : convert_c;
+
+    for (ch = 0; ch < MAX_CHANNELS; ch++) {
+        in[ch]   = in_buf   + ch * LEN * 4;
+        out0[ch] = out_buf0 + ch * LEN * 4;
+        out1[ch] = out_buf1 + ch * LEN * 4;
+    }
+    fill_input(in_buf, in_fmt, MAX_CHANNELS * LEN);
+
+    /* with the same layout on both sides, the function handles a single
+     * plane of interleaved or planar samples */
+    len = in_planar == out_planar && !in_planar ? LEN * channels : LEN;
+
+    if (check_func(func, "%s_to_%s_%dch", av_get_sample_fmt_name(in_fmt),
+                   av_get_sample_fmt_name(out_fmt), channels)) {
+        memset(out_buf0, 0, MAX_CHANNELS * LEN * 4);
+        memset(out_buf1, 0, MAX_CHANNELS * LEN * 4);
+        call_ref(out0, (const uint8_t **)in, len);
+        call_new(out1, (const uint8_t **)in, len);
+        if (memcmp(out_buf0, out_buf1, MAX_CHANNELS * LEN * 4))
+            fail();
+        bench_new(out1, (const uint8_t **)in, len);
+    }
+
+    swri_audio_convert_free(&ac);
+}
+
+void checkasm_check_swr_audioconvert(void)
+{
+    static const enum AVSampleFormat fmts[] = {
+        AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S32, AV_SAMPLE_FMT_FLT,
+    };
+    static const int channels[] = { 1, 2, 6, 8 };
+    int i, o, c;
+
+    /* sample format conversion on a single plane */
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++)
+        for (o = 0; o < FF_ARRAY_ELEMS(fmts); o++)
+            if (i != o)
+                check_convert(av_get_planar_sample_fmt(fmts[o]),
+                              av_get_planar_sample_fmt(fmts[i]), 1);
+    report("convert");
+
+    /* interleaving and deinterleaving, with or without format conversion */
+    for (c = 1; c < FF_ARRAY_ELEMS(channels); c++) {
+        for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+            for (o = 0; o < FF_ARRAY_ELEMS(fmts); o++) {
+                check_convert(fmts[o], av_get_planar_sample_fmt(fmts[i]), channels[c]);
+                check_convert(av_get_planar_sample_fmt(fmts[o]), fmts[i], channels[c]);
+            }
+        }
+    }
+    report("pack_unpack");
+}
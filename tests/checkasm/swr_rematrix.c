@@ -0,0 +1,116 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
+
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+/* the SIMD mixing functions are only used on multiples of 16 samples */
+#define LEN 1024
+
+static void fill_input(uint8_t *buf, enum AVSampleFormat fmt)
+{
+    int i;
+
+    for (i = 0; i < LEN; i++) {
+        int32_t r = rnd();
+
+        if (fmt == AV_SAMPLE_FMT_S16P)
+            ((int16_t *)buf)[i] = r >> 16;
+        else
+            ((float *)buf)[i] = r / (float)(1U << 31);
+    }
+}
+
+static void check_mix(enum AVSampleFormat fmt, const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, in1,  [LEN * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, in2,  [LEN * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, out0, [LEN * sizeof(float)]);
+    LOCAL_ALIGNED_32(uint8_t, out1, [LEN * sizeof(float)]);
+    SwrContext *s;
+    void *coeffs_new;
+    int bytes = av_get_bytes_per_sample(fmt);
+
+    /* 5.1 to stereo: all downmix coefficients are below 1.0, so the 16 bit
+     * SIMD matrix is an exact copy of the C one */
+    s = swr_alloc_set_opts(NULL, AV_CH_LAYOUT_STEREO, fmt, 48000,
+                           AV_CH_LAYOUT_5POINT1, fmt, 48000, 0, NULL);
+    if (!s || swr_init(s) < 0) {
+        swr_free(&s);
+        return;
+    }
+
+    fill_input(in1, fmt);
+    fill_input(in2, fmt);
+
+    {
+        mix_1_1_func_type *func = s->mix_1_1_simd ? s->mix_1_1_simd : s->mix_1_1_f;
+
+        declare_func(void, void *out, const void *in, void *coeffp,
+                     integer index, integer len);
+
+        /* the C and SIMD functions take their coefficients in different
+         * layouts */
+        coeffs_new = func == s->mix_1_1_f ? s->native_matrix : s->native_simd_matrix;
+
+        if (check_func(func, "mix_1_1_%s", name)) {
+            memset(out0, 0, LEN * bytes);
+            memset(out1, 0, LEN * bytes);
+            call_ref(out0, in1, s->native_matrix,  0, LEN);
+            call_new(out1, in1, coeffs_new,        0, LEN);
+            if (memcmp(out0, out1, LEN * bytes))
+                fail();
+            bench_new(out1, in1, coeffs_new, 0, LEN);
+        }
+    }
+
+    {
+        mix_2_1_func_type *func = s->mix_2_1_simd ? s->mix_2_1_simd : s->mix_2_1_f;
+
+        declare_func(void, void *out, const void *in1, const void *in2,
+                     void *coeffp, integer index1, integer index2, integer len);
+
+        coeffs_new = func == s->mix_2_1_f ? s->native_matrix : s->native_simd_matrix;
+
+        if (check_func(func, "mix_2_1_%s", name)) {
+            memset(out0, 0, LEN * bytes);
+            memset(out1, 0, LEN * bytes);
+            call_ref(out0, in1, in2, s->native_matrix, 0, 2, LEN);
+            call_new(out1, in1, in2, coeffs_new,       0, 2, LEN);
+            if (memcmp(out0, out1, LEN * bytes))
+                fail();
+            bench_new(out1, in1, in2, coeffs_new, 0, 2, LEN);
+        }
+    }
+
+    swr_free(&s);
+}
+
+void checkasm_check_swr_rematrix(void)
+{
+    check_mix(AV_SAMPLE_FMT_S16P, "int16");
+    check_mix(AV_SAMPLE_FMT_FLTP, "float");
+    report("mix");
+}
@@ -0,0 +1,134 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define BUF_SAMPLES 1024
+#define OUT_SAMPLES 256
+
+static void fill_input(uint8_t *buf, enum AVSampleFormat fmt)
+{
+    int i;
+
+    for (i = 0; i < BUF_SAMPLES; i++) {
+        int32_t r = rnd();
+
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P: ((int16_t *)buf)[i] = r >> 16;                 break;
+        case AV_SAMPLE_FMT_FLTP: ((float   *)buf)[i] = r / (float)(1U << 31);   break;
+        case AV_SAMPLE_FMT_DBLP: ((double  *)buf)[i] = r / (double)(1U << 31);  break;
+        }
+    }
+}
+
+static int compare_output(const uint8_t *a, const uint8_t *b,
+                          enum AVSampleFormat fmt, int linear)
+{
+    int i;
+
+    switch (fmt) {
+    case AV_SAMPLE_FMT_S16P:
+        /* the SIMD linear interpolation does not round like the C code */
+        for (i = 0; i < OUT_SAMPLES; i++)
+            if (FFABS(((const int16_t *)a)[i] - ((const int16_t *)b)[i]) > linear)
+                return 1;
+        return 0;
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array((const float *)a, (const float *)b,
+                                         1e-5, OUT_SAMPLES);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array((const double *)a, (const double *)b,
+                                          1e-12, OUT_SAMPLES);
+    }
+    return 1;
+}
+
+static void check_resample(enum AVSampleFormat fmt, const char *name,
+                           int in_rate, int out_rate, int filter_size,
+                           int linear)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SAMPLES * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [OUT_SAMPLES * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [OUT_SAMPLES * sizeof(double)]);
+    ResampleContext *c;
+    int (*func)(ResampleContext *c, void *dst, const void *src, int n, int update_ctx);
+    int ret0, ret1;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    c = swri_resampler.init(NULL, out_rate, in_rate, filter_size, 10, linear,
+                            0.97, fmt, SWR_FILTER_TYPE_KAISER, 9, 20, 0, 0);
+    if (!c)
+        return;
+    func = linear ? c->dsp.resample_linear : c->dsp.resample_common;
+
+    fill_input(src, fmt);
+
+    if (check_func(func, "%s_%s_%d_%d", linear ? "resample_linear" : "resample_common",
+                   name, in_rate, out_rate)) {
+        /* start somewhere within the filter bank, with the context state
+         * left untouched by the calls */
+        c->index = rnd() % c->phase_count;
+        c->frac  = c->dst_incr_mod ? rnd() % c->src_incr : 0;
+
+        memset(dst0, 0, OUT_SAMPLES * sizeof(double));
+        memset(dst1, 0, OUT_SAMPLES * sizeof(double));
+        ret0 = call_ref(c, dst0, src, OUT_SAMPLES, 0);
+        ret1 = call_new(c, dst1, src, OUT_SAMPLES, 0);
+        if (ret0 != ret1 || compare_output(dst0, dst1, fmt, linear))
+            fail();
+        bench_new(c, dst1, src, OUT_SAMPLES, 0);
+    }
+
+    swri_resampler.free(&c);
+}
+
+void checkasm_check_swr_resample(void)
+{
+    static const struct {
+        enum AVSampleFormat fmt;
+        const char *name;
+    } fmts[] = {
+        { AV_SAMPLE_FMT_S16P, "int16"  },
+        { AV_SAMPLE_FMT_FLTP, "float"  },
+        { AV_SAMPLE_FMT_DBLP, "double" },
+    };
+    static const int rates[][2] = {
+        { 44100, 48000 },
+        { 48000, 44100 },
+        { 48000, 16000 },
+    };
+    int f, r, linear;
+
+    for (linear = 0; linear <= 1; linear++) {
+        for (f = 0; f < FF_ARRAY_ELEMS(fmts); f++)
+            for (r = 0; r < FF_ARRAY_ELEMS(rates); r++)
+                check_resample(fmts[f].fmt, fmts[f].name,
+                               rates[r][0], rates[r][1], 32, linear);
+        report(linear ? "resample_linear" : "resample_common");
+    }
+}
@@ -0,0 +1,188 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/drawutils.h"
+#include "libavfilter/vf_overlay.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH 128
+/* two rows of alpha, twice as wide as a subsampled chroma row */
+#define ALINESIZE (2 * WIDTH * 2)
+#define BUF_SIZE (WIDTH * 4)
+
+static const struct {
+    int format, pix_fmt;
+    const char *name;
+} formats[] = {
+    { OVERLAY_FORMAT_YUV420,    AV_PIX_FMT_YUV420P,   "yuv420"    },
+    { OVERLAY_FORMAT_YUV422,    AV_PIX_FMT_YUV422P,   "yuv422"    },
+    { OVERLAY_FORMAT_YUV444,    AV_PIX_FMT_YUV444P,   "yuv444"    },
+    { OVERLAY_FORMAT_GBRP,      AV_PIX_FMT_GBRP,      "gbrp"      },
+    { OVERLAY_FORMAT_YUV420P10, AV_PIX_FMT_YUV420P10, "yuv420p10" },
+    { OVERLAY_FORMAT_YUV422P10, AV_PIX_FMT_YUV422P10, "yuv422p10" },
+    { OVERLAY_FORMAT_YUV444P10, AV_PIX_FMT_YUV444P10, "yuv444p10" },
+};
+
+static const struct {
+    int main_fmt, overlay_fmt;
+} rgb_formats[] = {
+    { AV_PIX_FMT_RGB24, AV_PIX_FMT_RGBA },
+    { AV_PIX_FMT_RGB24, AV_PIX_FMT_ARGB },
+    { AV_PIX_FMT_BGR24, AV_PIX_FMT_RGBA },
+    { AV_PIX_FMT_BGR24, AV_PIX_FMT_ABGR },
+};
+
+static const int widths[] = { WIDTH, WIDTH - 1, WIDTH - 13, 5 };
+
+static void randomize_buffers(uint8_t *buf, int size, int mask)
+{
+    int i;
+
+    for (i = 0; i < size; i += 2)
+        AV_WN16A(buf + i, rnd() & mask);
+}
+
+/* make runs of fully transparent and fully opaque pixels */
+static void randomize_alpha(uint8_t *a, int size, int depth)
+{
+    int i, pixel = depth > 8 ? 2 : 1;
+
+    randomize_buffers(a, size, depth > 8 ? 0x3ff : 0xffff);
+    for (i = 0; i < size / pixel; i += 16) {
+        int v = rnd() % 3 ? -1 : rnd() & 1 ? (1 << depth) - 1 : 0;
+        int j;
+
+        for (j = 0; j < 8 && v >= 0; j++) {
+            if (pixel == 2)
+                AV_WN16A(a + 2 * (i + j), v);
+            else
+                a[i + j] = v;
+        }
+    }
+}
+
+static void check_blend_row(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, alpha,   [ALINESIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [BUF_SIZE]);
+    OverlayContext s;
+    int f, alpha_format, plane, i;
+
+    declare_func(int, uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a, int w,
+                 ptrdiff_t alinesize);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(formats); f++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(formats[f].pix_fmt);
+        int depth = desc->comp[0].depth;
+        int pixel = depth > 8 ? 2 : 1;
+        int mask  = depth > 8 ? 0x3ff : 0xffff;
+
+        for (alpha_format = 0; alpha_format < 2; alpha_format++) {
+            memset(&s, 0, sizeof(s));
+            ff_overlay_init_blend_row(&s, formats[f].format, formats[f].pix_fmt,
+                                      alpha_format, 0);
+
+            for (plane = 0; plane < 2; plane++) {
+                if (!check_func(s.blend_row[plane], "overlay_row_%s%s_%s",
+                                formats[f].name, alpha_format ? "_pm" : "",
+                                plane ? "uv" : "y"))
+                    continue;
+
+                for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                    int w = widths[i], ret_ref, ret_new;
+
+                    randomize_buffers(src, BUF_SIZE, mask);
+                    randomize_buffers(dst, BUF_SIZE, mask);
+                    randomize_alpha(alpha, ALINESIZE * 2, depth);
+                    memcpy(dst_ref, dst, BUF_SIZE);
+                    memcpy(dst_new, dst, BUF_SIZE);
+
+                    ret_ref = call_ref(dst_ref, NULL, src, alpha, w, ALINESIZE);
+                    ret_new = call_new(dst_new, NULL, src, alpha, w, ALINESIZE);
+                    /* the new function may leave more pixels to the caller */
+                    if (ret_new > ret_ref || ret_new < 0 ||
+                        memcmp(dst_ref, dst_new, ret_new * pixel) ||
+                        memcmp(dst + ret_new * pixel, dst_new + ret_new * pixel,
+                               BUF_SIZE - ret_new * pixel))
+                        fail();
+                }
+                bench_new(dst_new, NULL, src, alpha, WIDTH, ALINESIZE);
+            }
+        }
+    }
+}
+
+static void check_blend_row_rgb(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [BUF_SIZE]);
+    OverlayContext s;
+    int f, alpha_format, i;
+
+    declare_func(int, uint8_t *d, const uint8_t *s, int w, const uint8_t *shuf);
+
+    for (f = 0; f < FF_ARRAY_ELEMS(rgb_formats); f++) {
+        for (alpha_format = 0; alpha_format < 2; alpha_format++) {
+            memset(&s, 0, sizeof(s));
+            ff_fill_rgba_map(s.main_rgba_map,    rgb_formats[f].main_fmt);
+            ff_fill_rgba_map(s.overlay_rgba_map, rgb_formats[f].overlay_fmt);
+            ff_overlay_init_blend_row(&s, OVERLAY_FORMAT_RGB, rgb_formats[f].main_fmt,
+                                      alpha_format, 0);
+
+            if (!check_func(s.blend_row_rgb, "overlay_row_%s_%s%s",
+                            av_get_pix_fmt_name(rgb_formats[f].main_fmt),
+                            av_get_pix_fmt_name(rgb_formats[f].overlay_fmt),
+                            alpha_format ? "_pm" : ""))
+                continue;
+
+            for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                int w = widths[i], ret_ref, ret_new;
+
+                randomize_buffers(src, BUF_SIZE, 0xffff);
+                randomize_buffers(dst, BUF_SIZE, 0xffff);
+                memcpy(dst_ref, dst, BUF_SIZE);
+                memcpy(dst_new, dst, BUF_SIZE);
+
+                ret_ref = call_ref(dst_ref, src, w, s.rgb_shuf);
+                ret_new = call_new(dst_new, src, w, s.rgb_shuf);
+                if (ret_new > ret_ref || ret_new < 0 ||
+                    memcmp(dst_ref, dst_new, ret_new * 3) ||
+                    memcmp(dst + ret_new * 3, dst_new + ret_new * 3,
+                           BUF_SIZE - ret_new * 3))
+                    fail();
+            }
+            bench_new(dst_new, src, WIDTH, s.rgb_shuf);
+        }
+    }
+}
+
+void checkasm_check_vf_overlay(void)
+{
+    check_blend_row();
+    report("blend_row");
+
+    check_blend_row_rgb();
+    report("blend_row_rgb");
+}
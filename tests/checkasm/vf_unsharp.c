@@ -0,0 +1,160 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/unsharp.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+
+#define WIDTH 256
+#define MAX_STEPS 11
+/* room for the horizontal padding and for SIMD overwrites, rounded up for
+ * randomize_buffers() */
+#define BUF_SIZE FFALIGN(WIDTH + 2 * MAX_STEPS + 16, 32)
+
+static const int widths[] = { WIDTH, WIDTH - 1, WIDTH - 13, 5 };
+
+static void randomize_buffers(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i += 4)
+        AV_WN32A(buf + i, rnd());
+}
+
+static void check_column_sum(UnsharpContext *s)
+{
+    LOCAL_ALIGNED_32(uint32_t, sc_ref, [2 * MAX_STEPS * WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, sc_new, [2 * MAX_STEPS * WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, dst_new, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src, [BUF_SIZE]);
+    uint32_t *rows_ref[2 * MAX_STEPS], *rows_new[2 * MAX_STEPS];
+    int i, z, steps;
+
+    declare_func(void, uint32_t *dst, uint32_t *const *sc, int nb_sc,
+                 const uint8_t *src, int width);
+
+    for (z = 0; z < 2 * MAX_STEPS; z++) {
+        rows_ref[z] = sc_ref + z * WIDTH;
+        rows_new[z] = sc_new + z * WIDTH;
+    }
+
+    if (check_func(s->column_sum, "unsharp_column_sum")) {
+        for (steps = 1; steps <= MAX_STEPS; steps += 5) {
+            for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                int w = widths[i];
+
+                randomize_buffers(src, BUF_SIZE);
+                /* state of the previous rows */
+                for (z = 0; z < 2 * steps * WIDTH; z++)
+                    sc_ref[z] = rnd() & 0xfffff;
+                memcpy(sc_new, sc_ref, 2 * steps * WIDTH * sizeof(*sc_ref));
+
+                call_ref(dst_ref, rows_ref, 2 * steps, src, w);
+                call_new(dst_new, rows_new, 2 * steps, src, w);
+                if (memcmp(dst_ref, dst_new, w * sizeof(*dst_ref)))
+                    fail();
+                for (z = 0; z < 2 * steps; z++)
+                    if (memcmp(rows_ref[z], rows_new[z], w * sizeof(*sc_ref)))
+                        fail();
+            }
+            bench_new(dst_new, rows_new, 2 * steps, src, WIDTH);
+        }
+    }
+}
+
+static void check_row_sum(UnsharpContext *s)
+{
+    LOCAL_ALIGNED_32(uint32_t, buf,     [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, buf_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint32_t, buf_new, [BUF_SIZE]);
+    int i, x, steps;
+
+    declare_func(void, uint32_t *buf, int width, int nb_sr);
+
+    if (check_func(s->row_sum, "unsharp_row_sum")) {
+        for (steps = 1; steps <= MAX_STEPS; steps += 5) {
+            for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                int w = widths[i];
+
+                for (x = 0; x < BUF_SIZE; x++)
+                    buf[x] = rnd() & 0xffff;
+                memcpy(buf_ref, buf, sizeof(*buf) * BUF_SIZE);
+                memcpy(buf_new, buf, sizeof(*buf) * BUF_SIZE);
+
+                call_ref(buf_ref, w, 2 * steps);
+                call_new(buf_new, w, 2 * steps);
+                if (memcmp(buf_ref, buf_new, w * sizeof(*buf_ref)))
+                    fail();
+            }
+            memcpy(buf_new, buf, sizeof(*buf) * BUF_SIZE);
+            bench_new(buf_new, WIDTH, 2 * steps);
+        }
+    }
+}
+
+static void check_sharpen(UnsharpContext *s)
+{
+    LOCAL_ALIGNED_32(uint32_t, sum, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, src, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [BUF_SIZE]);
+    static const float amounts[] = { -2.0, -0.5, 1.0, 5.0 };
+    int i, x;
+
+    declare_func(void, uint8_t *dst, const uint8_t *src, const uint32_t *sum,
+                 int width, int amount, int scalebits);
+
+    if (check_func(s->sharpen, "unsharp_sharpen")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int w = widths[i];
+            int scalebits = 4 + 2 * (rnd() % 10);
+            int amount = amounts[rnd() % FF_ARRAY_ELEMS(amounts)] * 65536.0;
+
+            randomize_buffers(src, BUF_SIZE);
+            for (x = 0; x < BUF_SIZE; x++)
+                sum[x] = rnd() & ((256 << scalebits) - 1);
+            memset(dst_ref, 0, BUF_SIZE);
+            memset(dst_new, 0, BUF_SIZE);
+
+            call_ref(dst_ref, src, sum, w, amount, scalebits);
+            call_new(dst_new, src, sum, w, amount, scalebits);
+            if (memcmp(dst_ref, dst_new, w))
+                fail();
+        }
+        bench_new(dst_new, src, sum, WIDTH, 65536, 8);
+    }
+}
+
+void checkasm_check_vf_unsharp(void)
+{
+    UnsharpContext s = { 0 };
+
+    ff_unsharp_init(&s);
+
+    check_column_sum(&s);
+    report("column_sum");
+
+    check_row_sum(&s);
+    report("row_sum");
+
+    check_sharpen(&s);
+    report("sharpen");
+}
@@ -41,6 +41,13 @@ fate-ffmpeg-filter_colorkey: CMD = framecrc -idct simple -fflags +bitexact -flag
 FATE_FFMPEG-$(CONFIG_COLOR_FILTER) += fate-ffmpeg-lavfi
 fate-ffmpeg-lavfi: CMD = framecrc -lavfi color=d=1:r=5 -fflags +bitexact
 
+FATE_FFMPEG-$(call ALLYES, TESTSRC_FILTER SINE_FILTER MPEG4_ENCODER PCM_S16LE_ENCODER) += fate-ffmpeg-encode_pipeline
+fate-ffmpeg-encode_pipeline: CMD = framecrc -encode_pipeline -encode_queue_size 2 -filter_complex "testsrc=d=1:r=10:s=64x48;sine=d=1" -c:v mpeg4 -flags +bitexact -c:a pcm_s16le -fflags +bitexact
+
+# both filtergraphs need the input converted to yuv420p, the conversion is shared
+FATE_FFMPEG-$(call ALLYES, TESTSRC_FILTER FORMAT_FILTER SCALE_FILTER VFLIP_FILTER NULL_MUXER) += fate-ffmpeg-shared_conversion
+fate-ffmpeg-shared_conversion: CMD = framecrc -f lavfi -i testsrc=d=1:r=5:s=64x48 -map 0 -vf format=yuv420p -f null - -map 0 -vf format=yuv420p,vflip
+
 FATE_SAMPLES_FFMPEG-$(CONFIG_RAWVIDEO_DEMUXER) += fate-force_key_frames
 fate-force_key_frames: tests/data/vsynth_lena.yuv
 fate-force_key_frames: CMD = enc_dec \
@@ -134,6 +134,11 @@ fate-filter-drawbox: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawbox=224:24:88:
 FATE_FILTER_VSYNTH-$(CONFIG_FADE_FILTER) += fate-filter-fade
 fate-filter-fade: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf fade=in:5:15,fade=out:30:15
 
+# the filters of the chain working on successive frames concurrently, same output
+FATE_FILTER_VSYNTH-$(CONFIG_FADE_FILTER) += fate-filter-fade-pipeline
+fate-filter-fade-pipeline: REF = $(SRC_PATH)/tests/ref/fate/filter-fade
+fate-filter-fade-pipeline: CMD = framecrc -filter_thread_type pipeline -filter_threads 4 -c:v pgmyuv -i $(SRC) -vf fade=in:5:15,fade=out:30:15
+
 FATE_FILTER_VSYNTH-$(call ALLYES, INTERLACE_FILTER FIELDORDER_FILTER) += fate-filter-fieldorder
 fate-filter-fieldorder: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf interlace=tff,fieldorder=bff -sws_flags +accurate_rnd+bitexact
 
@@ -207,6 +212,12 @@ FATE_FILTER_VSYNTH-$(CONFIG_VSTACK_FILTER) += fate-filter-vstack
 fate-filter-vstack: tests/data/filtergraphs/vstack
 fate-filter-vstack: CMD = framecrc -c:v pgmyuv -i $(SRC) -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/vstack
 
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER TESTSRC2_FILTER RGBTESTSRC_FILTER HSTACK_FILTER) += fate-filter-hstack-odd
+fate-filter-hstack-odd: CMD = framecrc -lavfi "testsrc=s=101x48:r=5:d=1[a];testsrc2=s=101x48:r=5:d=1[b];rgbtestsrc=s=101x48:r=5:d=1[c];[a][b][c]hstack=inputs=3"
+
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER TESTSRC2_FILTER RGBTESTSRC_FILTER HSTACK_FILTER) += fate-filter-hstack-aligned
+fate-filter-hstack-aligned: CMD = framecrc -lavfi "testsrc=s=128x48:r=5:d=1[a];testsrc2=s=128x48:r=5:d=1[b];rgbtestsrc=s=128x48:r=5:d=1[c];[a][b][c]hstack=inputs=3"
+
 FATE_FILTER_VSYNTH-$(CONFIG_OVERLAY_FILTER) += fate-filter-overlay
 fate-filter-overlay: tests/data/filtergraphs/overlay
 fate-filter-overlay: CMD = framecrc -c:v pgmyuv -i $(SRC) -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay
@@ -215,6 +226,12 @@ FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_F
 fate-filter-overlay_rgb: tests/data/filtergraphs/overlay_rgb
 fate-filter-overlay_rgb: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_rgb
 
+# the branches of the graph activated concurrently, same output
+FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_rgb-graph_threads
+fate-filter-overlay_rgb-graph_threads: tests/data/filtergraphs/overlay_rgb
+fate-filter-overlay_rgb-graph_threads: REF = $(SRC_PATH)/tests/ref/fate/filter-overlay_rgb
+fate-filter-overlay_rgb-graph_threads: CMD = framecrc -filter_thread_type slice+graph -filter_complex_threads 4 -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_rgb
+
 FATE_FILTER_VSYNTH-$(call ALLYES, SPLIT_FILTER SCALE_FILTER PAD_FILTER OVERLAY_FILTER) += fate-filter-overlay_yuv420
 fate-filter-overlay_yuv420: tests/data/filtergraphs/overlay_yuv420
 fate-filter-overlay_yuv420: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/overlay_yuv420
@@ -193,6 +193,7 @@ FATE_H264  := $(FATE_H264:%=fate-h264-conformance-%)                    \
               fate-h264-extreme-plane-pred                              \
               fate-h264-intra-refresh-recovery                          \
               fate-h264-lossless                                        \
+              fate-h264-max_thread_delay                                \
               fate-h264-3386                                            \
               fate-h264-missing-frame                                   \
               fate-h264-ref-pic-mod-overflow                            \
@@ -441,6 +442,9 @@ fate-h264-twofields-packet:                       CMD = framecrc -i $(TARGET_SAM
 fate-h264-unescaped-extradata:                    CMD = framecrc -i $(TARGET_SAMPLES)/h264/unescaped_extradata.mp4 -an -frames 10
 fate-h264-3386:                                   CMD = framecrc -i $(TARGET_SAMPLES)/h264/bbc2.sample.h264
 fate-h264-missing-frame:                          CMD = framecrc -i $(TARGET_SAMPLES)/h264/nondeterministic_cut.h264
+fate-h264-max_thread_delay:                       CMD = framecrc -vsync drop -max_thread_delay 1 -i $(TARGET_SAMPLES)/h264-conformance/CAPAMA3_Sand_F.264
+fate-h264-max_thread_delay:                       REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-capama3_sand_f
+fate-h264-max_thread_delay:                       THREADS = 4
 fate-h264-timecode:                               CMD = framecrc -i $(TARGET_SAMPLES)/h264/crew_cif_timecode-2.h264
 
 fate-h264-reinit-%:                               CMD = framecrc -i $(TARGET_SAMPLES)/h264/$(@:fate-h264-%=%).h264 -vf format=yuv444p10le,scale=w=352:h=288
@@ -223,6 +223,27 @@ $(foreach N,$(HEVC_SAMPLES_422_10BIN),$(eval $(call FATE_HEVC_TEST_422_10BIN,$(N
 $(foreach N,$(HEVC_SAMPLES_444_8BIT),$(eval $(call FATE_HEVC_TEST_444_8BIT,$(N))))
 $(foreach N,$(HEVC_SAMPLES_444_12BIT),$(eval $(call FATE_HEVC_TEST_444_12BIT,$(N))))
 
+# the tile streams again, decoded with one tile per slice thread
+HEVC_SAMPLES_TILES =            \
+    TILES_A_Cisco_2             \
+    TILES_B_Cisco_1             \
+
+define FATE_HEVC_TEST_TILES_THREADS
+FATE_HEVC += fate-hevc-conformance-$(1)-threads
+fate-hevc-conformance-$(1)-threads: CMD = framecrc -flags unaligned -vsync drop -i $(TARGET_SAMPLES)/hevc-conformance/$(1).bit -pix_fmt yuv420p
+fate-hevc-conformance-$(1)-threads: THREADS = 4
+fate-hevc-conformance-$(1)-threads: THREAD_TYPE = slice
+fate-hevc-conformance-$(1)-threads: REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(1)
+endef
+
+$(foreach N,$(HEVC_SAMPLES_TILES),$(eval $(call FATE_HEVC_TEST_TILES_THREADS,$(N))))
+
+# frame threading limited to a delay of one frame
+FATE_HEVC += fate-hevc-max_thread_delay
+fate-hevc-max_thread_delay: CMD = framecrc -flags unaligned -vsync drop -max_thread_delay 1 -i $(TARGET_SAMPLES)/hevc-conformance/DBLK_A_SONY_3.bit -pix_fmt yuv420p
+fate-hevc-max_thread_delay: REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-DBLK_A_SONY_3
+fate-hevc-max_thread_delay: THREADS = 4
+
 fate-hevc-paramchange-yuv420p-yuv420p10: CMD = framecrc -vsync 0 -i $(TARGET_SAMPLES)/hevc/paramchange_yuv420p_yuv420p10.hevc -sws_flags area+accurate_rnd+bitexact
 FATE_HEVC += fate-hevc-paramchange-yuv420p-yuv420p10
 
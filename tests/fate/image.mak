@@ -442,8 +442,21 @@ fate-tiff-fax-g3s: CMD = framecrc -i $(TARGET_SAMPLES)/CCITT_fax/G31DS.TIF
 
 FATE_TIFF-$(call DEMDEC, IMAGE2, TIFF) += $(FATE_TIFF)
 
+# tiled TIFF written by the encoder, decoded without and with slice threads
+FATE_TIFF_TILED-$(call ENCDEC, TIFF, MOV) += fate-tiff-tiled-raw fate-tiff-tiled-raw-threads
+FATE_TIFF_TILED-$(call ALLYES, ZLIB TIFF_ENCODER TIFF_DECODER MOV_MUXER MOV_DEMUXER) += fate-tiff-tiled-deflate fate-tiff-tiled-deflate-threads
+
+$(FATE_TIFF_TILED-yes): tests/data/vsynth1.yuv
+fate-tiff-tiled-%: COMPR = $(word 4, $(subst -, ,$(@)))
+fate-tiff-tiled-%: CMD = enc_dec "rawvideo -s 352x288 -pix_fmt yuv420p" tests/data/vsynth1.yuv mov "-c tiff -pix_fmt rgb24 -tile_size 64 -compression_algo $(COMPR)" rawvideo "-s 352x288 -pix_fmt yuv420p -vsync 0"
+fate-tiff-tiled-%: CMP_UNIT = 1
+fate-tiff-tiled-%-threads: THREADS = 4
+fate-tiff-tiled-%-threads: THREAD_TYPE = slice
+
+FATE_FFMPEG += $(FATE_TIFF_TILED-yes)
+
 FATE_IMAGE += $(FATE_TIFF-yes)
-fate-tiff: $(FATE_TIFF-yes)
+fate-tiff: $(FATE_TIFF-yes) $(FATE_TIFF_TILED-yes)
 
 FATE_WEBP += fate-webp-rgb-lossless
 fate-webp-rgb-lossless: CMD = framecrc -i $(TARGET_SAMPLES)/webp/rgb_lossless.webp
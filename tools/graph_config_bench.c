@@ -0,0 +1,166 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the latency of building and configuring a filter graph, with
+ * and without a graph template, e.g.:
+ * tools/graph_config_bench -r 1000 \
+ *     "buffer=video_size=1920x1080:pix_fmt=yuv420p:time_base=1/25,scale=320:-2,format=rgb24"
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "libavutil/avutil.h"
+#include "libavutil/time.h"
+#include "libavfilter/avfilter.h"
+
+#if HAVE_UNISTD_H
+#include <unistd.h> /* for getopt */
+#endif
+#if !HAVE_GETOPT
+#include "compat/getopt.c"
+#endif
+
+typedef struct Times {
+    int64_t parse, config, free;
+} Times;
+
+static void fatal_error(const char *tag, int ret)
+{
+    av_log(NULL, AV_LOG_ERROR, "%s: %s\n", tag, av_err2str(ret));
+    exit(1);
+}
+
+/* connect the unconnected outputs of the graph to sinks */
+static int create_sinks(AVFilterGraph *graph, AVFilterInOut *outputs)
+{
+    AVFilterInOut *cur;
+    int i = 0, ret;
+
+    for (cur = outputs; cur; cur = cur->next) {
+        enum AVMediaType type = avfilter_pad_get_type(cur->filter_ctx->output_pads,
+                                                      cur->pad_idx);
+        AVFilterContext *sink;
+        char name[16];
+
+        /* graph templates match the filters by name */
+        snprintf(name, sizeof(name), "out%d", i++);
+        ret = avfilter_graph_create_filter(&sink,
+                                           avfilter_get_by_name(type == AVMEDIA_TYPE_AUDIO ?
+                                                                "abuffersink" : "buffersink"),
+                                           name, NULL, NULL, graph);
+        if (ret < 0)
+            return ret;
+        ret = avfilter_link(cur->filter_ctx, cur->pad_idx, sink, 0);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+static AVFilterGraph *build_graph(const char *desc, const AVFilterGraphTemplate *tmpl,
+                                  Times *times)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterInOut *inputs = NULL, *outputs = NULL;
+    int64_t t0 = av_gettime_relative(), t1;
+    int ret;
+
+    if (!graph)
+        fatal_error("avfilter_graph_alloc", AVERROR(ENOMEM));
+    ret = avfilter_graph_parse2(graph, desc, &inputs, &outputs);
+    if (ret >= 0 && inputs)
+        ret = AVERROR(EINVAL);
+    if (ret >= 0)
+        ret = create_sinks(graph, outputs);
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    if (ret < 0)
+        fatal_error("Error building the graph", ret);
+    t1 = av_gettime_relative();
+    times->parse += t1 - t0;
+
+    ret = tmpl ? avfilter_graph_config_template(graph, tmpl, NULL) :
+                 avfilter_graph_config(graph, NULL);
+    if (ret < 0)
+        fatal_error("Error configuring the graph", ret);
+    times->config += av_gettime_relative() - t1;
+
+    return graph;
+}
+
+static void run(const char *desc, const char *name,
+                const AVFilterGraphTemplate *tmpl, unsigned runs)
+{
+    Times times = { 0 };
+    unsigned i;
+
+    for (i = 0; i < runs; i++) {
+        AVFilterGraph *graph = build_graph(desc, tmpl, &times);
+        int64_t t0 = av_gettime_relative();
+
+        avfilter_graph_free(&graph);
+        times.free += av_gettime_relative() - t0;
+    }
+    printf("%-10s runs: %6u  parse: %9.2f us  config: %9.2f us  free: %9.2f us\n",
+           name, runs, (double)times.parse / runs,
+           (double)times.config / runs, (double)times.free / runs);
+}
+
+int main(int argc, char **argv)
+{
+    AVFilterGraphTemplate *tmpl = NULL;
+    AVFilterGraph *graph;
+    Times times = { 0 };
+    unsigned runs = 1000;
+    int opt, ret;
+
+    while ((opt = getopt(argc, argv, "hr:")) != -1) {
+        switch (opt) {
+        case 'r':
+            runs = strtol(optarg, NULL, 0);
+            break;
+        case 'h':
+        default:
+            fprintf(stderr, "Usage: %s [-r runs] graph_description\n"
+                    "The graph must not have unconnected inputs, sinks are "
+                    "added to its unconnected outputs.\n", argv[0]);
+            exit(opt != 'h');
+        }
+    }
+    if (optind != argc - 1 || !runs) {
+        fprintf(stderr, "Usage: %s [-r runs] graph_description\n", argv[0]);
+        exit(1);
+    }
+
+    av_log_set_level(AV_LOG_ERROR);
+
+    graph = build_graph(argv[optind], NULL, &times);
+    ret = avfilter_graph_template_create(&tmpl, graph);
+    avfilter_graph_free(&graph);
+    if (ret < 0)
+        fatal_error("Error creating the template", ret);
+
+    run(argv[optind], "negotiate", NULL, runs);
+    run(argv[optind], "template",  tmpl, runs);
+
+    avfilter_graph_template_free(&tmpl);
+    return 0;
+}